@@ -0,0 +1,234 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+
+#define ALLOCATION_BLOCKS_INITIAL 1024 // Power of 2.
+
+static void *MallocResize(void *context, void *ptr, size_t oldSize, size_t newSize, const char *tag) {
+    if (newSize == 0) {
+        free(ptr);
+        return NULL;
+    }
+    return realloc(ptr, newSize);
+}
+
+static void *MallocDetach(void *context, void *ptr, size_t size, const char *tag) {
+    return ptr;
+}
+
+static Allocator allocatorCurrent = {MallocResize, MallocDetach, NULL};
+
+void AllocatorSet(Allocator allocator) {
+    allocatorCurrent = allocator;
+}
+
+Allocator AllocatorGet(void) {
+    return allocatorCurrent;
+}
+
+Allocator AllocatorMalloc(void) {
+    return (Allocator) {MallocResize, MallocDetach, NULL};
+}
+
+void *AllocatorResize(void *ptr, size_t oldSize, size_t newSize, const char *tag) {
+    return allocatorCurrent.resize(allocatorCurrent.context, ptr, oldSize, newSize, tag);
+}
+
+void *AllocatorDetach(void *ptr, size_t size, const char *tag) {
+    return allocatorCurrent.detach(allocatorCurrent.context, ptr, size, tag);
+}
+
+
+static unsigned int HashPointer(const void *ptr) {
+    uint64_t x = (uint64_t) (uintptr_t) ptr;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return (unsigned int) x;
+}
+
+static const char siteOther[] = "other";
+
+// Expects the lock to be held.
+static int SiteFind(AllocationTracker *tracker, const char *tag) {
+    if (!tag) tag = siteOther;
+    int mask = ALLOCATION_SITES_MAX - 1;
+    int idx = HashPointer(tag) & mask;
+    for (int probes = 0; probes < ALLOCATION_SITES_MAX; probes++, idx = (idx + 1) & mask) {
+        AllocationSite *site = tracker->sites + idx;
+        if (site->tag == tag) return idx;
+        if (!site->tag) {
+            // The last free slot is kept for the site that everything else is merged into.
+            if (tracker->siteCount >= ALLOCATION_SITES_MAX - 1 && tag != siteOther) break;
+            site->tag = tag;
+            tracker->siteCount++;
+            return idx;
+        }
+    }
+    assert(tag != siteOther);
+    return SiteFind(tracker, siteOther);
+}
+
+static void SiteAdd(AllocationTracker *tracker, int siteIdx, long long bytes) {
+    AllocationSite *site = tracker->sites + siteIdx;
+    site->bytes += bytes;
+    if (site->bytes > site->peak) site->peak = site->bytes;
+}
+
+// Expects the lock to be held. Returns the index of the block or of the empty slot where it would go.
+static int BlockFind(AllocationTracker *tracker, void *ptr) {
+    int mask = tracker->blockCapacity - 1;
+    int i = HashPointer(ptr) & mask;
+    while (tracker->blocks[i].ptr && tracker->blocks[i].ptr != ptr) i = (i + 1) & mask;
+    return i;
+}
+
+static void BlockInsert(AllocationTracker *tracker, AllocationBlock block) {
+    if ((tracker->blockCount + 1) * 4 > tracker->blockCapacity * 3) { // grow at 75% load
+        AllocationBlock *old = tracker->blocks;
+        int oldCapacity = tracker->blockCapacity;
+        tracker->blockCapacity *= 2;
+        tracker->blocks = calloc(tracker->blockCapacity, sizeof(AllocationBlock));
+        for (int i = 0; i < oldCapacity; i++) {
+            if (old[i].ptr) tracker->blocks[BlockFind(tracker, old[i].ptr)] = old[i];
+        }
+        free(old);
+    }
+    int idx = BlockFind(tracker, block.ptr);
+    assert(!tracker->blocks[idx].ptr);
+    tracker->blocks[idx] = block;
+    tracker->blockCount++;
+}
+
+// Backwards shift deletion keeps linear probing chains intact without tombstones.
+static void BlockRemove(AllocationTracker *tracker, int idx) {
+    int mask = tracker->blockCapacity - 1;
+    int hole = idx;
+    for (int i = (idx + 1) & mask; tracker->blocks[i].ptr; i = (i + 1) & mask) {
+        int home = HashPointer(tracker->blocks[i].ptr) & mask;
+        // Move the entry back if the hole lies between its home slot and where it is now.
+        bool movable = hole <= i ? (home <= hole || home > i) : (home <= hole && home > i);
+        if (movable) {
+            tracker->blocks[hole] = tracker->blocks[i];
+            hole = i;
+        }
+    }
+    tracker->blocks[hole] = (AllocationBlock) {0};
+    tracker->blockCount--;
+}
+
+// Stops counting a block. Returns false if it wasn't being tracked.
+static bool BlockForget(AllocationTracker *tracker, void *ptr) {
+    int idx = BlockFind(tracker, ptr);
+    AllocationBlock block = tracker->blocks[idx];
+    if (!block.ptr) return false;
+    SiteAdd(tracker, block.site, -(long long) block.size);
+    tracker->bytes -= block.size;
+    BlockRemove(tracker, idx);
+    return true;
+}
+
+static void *TrackerResize(void *context, void *ptr, size_t oldSize, size_t newSize, const char *tag) {
+    AllocationTracker *tracker = context;
+    // The parent is called under the lock too. Otherwise a block freed by a resize could be handed to
+    // another thread and recorded before the old record was removed.
+    pthread_mutex_lock(&tracker->mutex);
+    void *result = tracker->parent.resize(tracker->parent.context, ptr, oldSize, newSize, tag);
+    
+    bool tracked = true;
+    if (ptr) tracked = BlockForget(tracker, ptr);
+    
+    // Blocks that came from before the tracker was installed stay untracked.
+    if (result && tracked) {
+        int siteIdx = SiteFind(tracker, tag);
+        tracker->sites[siteIdx].count++;
+        tracker->sites[siteIdx].total += newSize;
+        BlockInsert(tracker, (AllocationBlock) {result, newSize, siteIdx});
+        SiteAdd(tracker, siteIdx, newSize);
+        tracker->count++;
+        tracker->bytes += newSize;
+        if (tracker->bytes > tracker->peak) tracker->peak = tracker->bytes;
+    }
+    pthread_mutex_unlock(&tracker->mutex);
+    return result;
+}
+
+static void *TrackerDetach(void *context, void *ptr, size_t size, const char *tag) {
+    AllocationTracker *tracker = context;
+    pthread_mutex_lock(&tracker->mutex);
+    BlockForget(tracker, ptr);
+    void *result = tracker->parent.detach(tracker->parent.context, ptr, size, tag);
+    pthread_mutex_unlock(&tracker->mutex);
+    return result;
+}
+
+void AllocationTrackerInit(AllocationTracker *tracker, Allocator parent) {
+    memset(tracker, 0, sizeof(AllocationTracker));
+    tracker->parent = parent;
+    pthread_mutex_init(&tracker->mutex, NULL);
+    tracker->blockCapacity = ALLOCATION_BLOCKS_INITIAL;
+    tracker->blocks = calloc(tracker->blockCapacity, sizeof(AllocationBlock));
+}
+
+void AllocationTrackerFree(AllocationTracker *tracker) {
+    pthread_mutex_destroy(&tracker->mutex);
+    free(tracker->blocks);
+}
+
+Allocator AllocationTrackerAllocator(AllocationTracker *tracker) {
+    return (Allocator) {TrackerResize, TrackerDetach, tracker};
+}
+
+void AllocationTrackerTotals(AllocationTracker *tracker, long long *count, long long *bytes, long long *peak) {
+    pthread_mutex_lock(&tracker->mutex);
+    if (count) *count = tracker->count;
+    if (bytes) *bytes = tracker->bytes;
+    if (peak) *peak = tracker->peak;
+    pthread_mutex_unlock(&tracker->mutex);
+}
+
+void AllocationTrackerResetPeak(AllocationTracker *tracker) {
+    pthread_mutex_lock(&tracker->mutex);
+    tracker->peak = tracker->bytes;
+    for (int i = 0; i < ALLOCATION_SITES_MAX; i++) tracker->sites[i].peak = tracker->sites[i].bytes;
+    pthread_mutex_unlock(&tracker->mutex);
+}
+
+static int SiteComparePeak(const void *a, const void *b) {
+    long long peakA = ((const AllocationSite *) a)->peak;
+    long long peakB = ((const AllocationSite *) b)->peak;
+    return (peakA < peakB) - (peakA > peakB);
+}
+
+int AllocationTrackerSites(AllocationTracker *tracker, AllocationSite *out, int max) {
+    AllocationSite sites[ALLOCATION_SITES_MAX];
+    int count = 0;
+    pthread_mutex_lock(&tracker->mutex);
+    for (int i = 0; i < ALLOCATION_SITES_MAX; i++) {
+        if (tracker->sites[i].tag) sites[count++] = tracker->sites[i];
+    }
+    pthread_mutex_unlock(&tracker->mutex);
+
+    qsort(sites, count, sizeof(AllocationSite), SiteComparePeak);
+    if (count > max) count = max;
+    memcpy(out, sites, sizeof(AllocationSite) * count);
+    return count;
+}
+
+void AllocationTrackerPrint(AllocationTracker *tracker, FILE *file, int max) {
+    long long count, bytes, peak;
+    AllocationTrackerTotals(tracker, &count, &bytes, &peak);
+    fprintf(file, "Allocations: %lli, live bytes: %lli, peak bytes: %lli\n", count, bytes, peak);
+
+    AllocationSite sites[ALLOCATION_SITES_MAX];
+    int siteCount = AllocationTrackerSites(tracker, sites, max < ALLOCATION_SITES_MAX ? max : ALLOCATION_SITES_MAX);
+    fprintf(file, "%12s %12s %14s %12s  %s\n", "peak", "live", "total", "count", "site");
+    for (int i = 0; i < siteCount; i++) {
+        AllocationSite *site = sites + i;
+        fprintf(file, "%12lli %12lli %14lli %12lli  %s\n", site->peak, site->bytes, site->total, site->count, site->tag);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define ALLOCATOR_STRINGIFY_INNER(x) #x
+#define ALLOCATOR_STRINGIFY(x) ALLOCATOR_STRINGIFY_INNER(x)
+// Identifies the call site of an allocation. Used by the macros in list.h and string_buffer.h.
+#define ALLOCATOR_TAG __FILE__ ":" ALLOCATOR_STRINGIFY(__LINE__)
+
+// Works like realloc. A NULL ptr allocates, a newSize of 0 frees and returns NULL.
+// oldSize is the size the block was last given, 0 when allocating.
+typedef void *(*AllocatorResizeFunction)(void *context, void *ptr, size_t oldSize, size_t newSize, const char *tag);
+// Hands a block over to the caller, who releases it with free(). Returns the pointer the caller now owns.
+typedef void *(*AllocatorDetachFunction)(void *context, void *ptr, size_t size, const char *tag);
+
+typedef struct Allocator {
+    AllocatorResizeFunction resize;
+    AllocatorDetachFunction detach;
+    void *context;
+} Allocator;
+
+// Allocator used by lists and string buffers. Defaults to malloc.
+// Blocks can outlive the allocator that made them, so only swap in allocators that are backed by the current one.
+// Set it before starting other threads.
+void AllocatorSet(Allocator allocator);
+Allocator AllocatorGet(void);
+Allocator AllocatorMalloc(void);
+
+void *AllocatorResize(void *ptr, size_t oldSize, size_t newSize, const char *tag);
+void *AllocatorDetach(void *ptr, size_t size, const char *tag);
+
+
+#define ALLOCATION_SITES_MAX 256 // Power of 2. Sites past this are merged into one called "other".
+
+typedef struct AllocationSite {
+    const char *tag;
+    long long count; // Allocations and resizes made here.
+    long long total; // Bytes requested here over the whole run.
+    long long bytes; // Live bytes last allocated or resized here.
+    long long peak; // Most live bytes at once.
+} AllocationSite;
+
+typedef struct AllocationBlock {
+    void *ptr;
+    size_t size;
+    int site;
+} AllocationBlock;
+
+// Wraps another allocator and records per call site statistics. Safe to use from multiple threads.
+// Blocks that were allocated before the tracker was installed are passed through without being counted.
+typedef struct AllocationTracker {
+    Allocator parent;
+    pthread_mutex_t mutex;
+
+    AllocationSite sites[ALLOCATION_SITES_MAX]; // Open addressed by tag pointer.
+    int siteCount;
+
+    AllocationBlock *blocks; // Open addressed by pointer. Bookkeeping uses malloc directly so it isn't tracked.
+    int blockCapacity;
+    int blockCount;
+
+    long long count;
+    long long bytes;
+    long long peak;
+} AllocationTracker;
+
+void AllocationTrackerInit(AllocationTracker *tracker, Allocator parent);
+void AllocationTrackerFree(AllocationTracker *tracker);
+Allocator AllocationTrackerAllocator(AllocationTracker *tracker);
+
+// Totals are read under the lock. Any argument may be NULL.
+void AllocationTrackerTotals(AllocationTracker *tracker, long long *count, long long *bytes, long long *peak);
+// Restarts peaks at the current live bytes so a section of work can be measured.
+void AllocationTrackerResetPeak(AllocationTracker *tracker);
+// Copies up to max sites into out, sorted by peak bytes, largest first. Returns the number copied.
+int AllocationTrackerSites(AllocationTracker *tracker, AllocationSite *out, int max);
+void AllocationTrackerPrint(AllocationTracker *tracker, FILE *file, int max);
+
+#endif
@@ -0,0 +1,74 @@
+#include <stddef.h>
+#include <string.h>
+#include "allocator.h"
+#include "arena.h"
+
+#define ARENA_HEADER_SIZE ((sizeof(ArenaBlock) + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1))
+
+static ArenaBlock *ArenaBlockNew(size_t size, ArenaBlock *previous) {
+    ArenaBlock *block = AllocatorResize(NULL, 0, ARENA_HEADER_SIZE + size, ALLOCATOR_TAG);
+    *block = (ArenaBlock) {
+        .previous = previous,
+        .size = size,
+        .used = 0
+    };
+    return block;
+}
+
+static void ArenaBlocksFree(ArenaBlock *block) {
+    while (block) {
+        ArenaBlock *previous = block->previous;
+        AllocatorResize(block, ARENA_HEADER_SIZE + block->size, 0, ALLOCATOR_TAG);
+        block = previous;
+    }
+}
+
+Arena ArenaNew(size_t blockSize) {
+    return (Arena) {
+        .block = NULL,
+        .blockSize = blockSize > 0 ? blockSize : ARENA_BLOCK_SIZE_DEFAULT,
+        .used = 0
+    };
+}
+
+void ArenaFree(Arena *arena) {
+    ArenaBlocksFree(arena->block);
+    arena->block = NULL;
+    arena->used = 0;
+}
+
+void ArenaReset(Arena *arena) {
+    if (arena->block && arena->block->previous) {
+        // Grow to fit everything the last round needed so the next one fits in a single block.
+        size_t size = arena->blockSize;
+        while (size < arena->used) size *= 2;
+        ArenaBlocksFree(arena->block);
+        arena->block = ArenaBlockNew(size, NULL);
+        arena->blockSize = size;
+    } else if (arena->block) {
+        arena->block->used = 0;
+    }
+    arena->used = 0;
+}
+
+void *ArenaAlloc(Arena *arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+    ArenaBlock *block = arena->block;
+    if (!block || block->used + size > block->size) {
+        size_t blockSize = arena->blockSize;
+        while (blockSize < size) blockSize *= 2;
+        block = ArenaBlockNew(blockSize, block);
+        arena->block = block;
+    }
+    void *ptr = (char *) block + ARENA_HEADER_SIZE + block->used;
+    block->used += size;
+    arena->used += size;
+    return ptr;
+}
+
+char *ArenaStringCopy(Arena *arena, const char *str) {
+    size_t length = strlen(str) + 1;
+    char *copy = ArenaAlloc(arena, length);
+    memcpy(copy, str, length);
+    return copy;
+}
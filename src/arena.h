@@ -0,0 +1,33 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE_DEFAULT 4096
+#define ARENA_ALIGNMENT 16
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *previous;
+    size_t size;
+    size_t used;
+    // Data follows the block header.
+} ArenaBlock;
+
+// Linear allocator for memory that all dies at the same time, like everything drawn in one frame.
+// Allocations are bumped out of blocks and only released all at once by ArenaReset.
+// When a reset finds more than one block, they are replaced by one block big enough for all of them,
+// so once the arena has seen its biggest frame it stops allocating.
+typedef struct Arena {
+    ArenaBlock *block; // Current block. Older blocks are linked through previous.
+    size_t blockSize;
+    size_t used; // Bytes handed out since the last reset, across all blocks.
+} Arena;
+
+Arena ArenaNew(size_t blockSize);
+void ArenaFree(Arena *arena);
+void ArenaReset(Arena *arena);
+
+void *ArenaAlloc(Arena *arena, size_t size);
+char *ArenaStringCopy(Arena *arena, const char *str);
+
+#endif
@@ -0,0 +1,328 @@
+// Benchmarks for the hot paths of the editor. Prints the results as json so they can be diffed between commits.
+// Usage: cac_bench [-o output.json] [layers frames]...
+// Each layers/frames pair generates a synthetic animation with a mix of hitbox, shape and bezier layers.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "raylib.h"
+#include "allocator.h"
+#include "editor_history.h"
+#include "fixed_animation.h"
+#include "fixed_animation_state.h"
+#include "fixed_point.h"
+#include "layer.h"
+#include "layer_hierarchy.h"
+#include "list.h"
+#include "timer.h"
+#include "transform_2d.h"
+
+#define BENCH_SECONDS_MIN 0.25
+#define BENCH_FILE "bench_animation.json"
+#define BENCH_VERSION 4
+
+typedef struct BenchSize {
+    int layerCount;
+    int frameCount;
+} BenchSize;
+
+static const BenchSize sizesDefault[] = {
+    {8, 16},
+    {64, 120},
+    {256, 600}
+};
+
+// Small deterministic generator so every run benchmarks the same data.
+static unsigned int randomState;
+
+static int RandomInt(int min, int max) {
+    randomState = randomState * 1664525u + 1013904223u;
+    return min + (int) ((randomState >> 8) % (unsigned int) (max - min + 1));
+}
+
+static Shape RandomShape(void) {
+    Shape shape;
+    switch (RandomInt(0, 2)) {
+        case 0:
+            shape.type = SHAPE_CIRCLE;
+            shape.circleRadius = RandomInt(4, 48);
+            break;
+        case 1:
+            shape.type = SHAPE_RECTANGLE;
+            shape.rectangle.rightX = RandomInt(4, 48);
+            shape.rectangle.bottomY = RandomInt(4, 48);
+            break;
+        default:
+            shape.type = SHAPE_CAPSULE;
+            shape.capsule.radius = RandomInt(4, 32);
+            shape.capsule.height = RandomInt(0, 32);
+            shape.capsule.rotation = (float) RandomInt(0, 628) / 100.0f;
+            break;
+    }
+    return shape;
+}
+
+static EditorState BenchAnimation(int layerCount, int frameCount) {
+    randomState = 12345u;
+    EditorState state = EditorStateNew(frameCount);
+    for (int i = 0; i < frameCount; i++) {
+        state.frames[i].duration = RandomInt(16, 120);
+        state.frames[i].canCancel = RandomInt(0, 3) == 0;
+        state.frames[i].pos = (Vector2) {(float) RandomInt(0, 256), (float) RandomInt(0, 256)};
+    }
+
+    for (int layerIdx = 0; layerIdx < layerCount; layerIdx++) {
+        Layer layer;
+        layer.transform = Transform2DFromPosition((Vector2) {(float) RandomInt(0, 256), (float) RandomInt(0, 256)});
+        layer.framesActive = LIST_NEW_SIZED(bool, frameCount);
+        for (int i = 0; i < frameCount; i++) layer.framesActive[i] = RandomInt(0, 1);
+        layer.keys = LIST_NEW(LayerKey);
+        layer.samples = LIST_NEW(LayerSample);
+        layer.templateName = NULL;
+        layer.templateOverrides = 0;
+        layer.parent = layerIdx % 4 == 3 ? layerIdx / 2 : -1; // Some chains of children for the hierarchy.
+        
+        switch (layerIdx % 3) { // Evenly mixed so every kind of layer gets measured.
+            case 0:
+                layer.type = LAYER_HITBOX;
+                layer.hitbox.shape = RandomShape();
+                layer.hitbox.knockbackX = RandomInt(-20, 20);
+                layer.hitbox.knockbackY = RandomInt(-20, 20);
+                layer.hitbox.damage = RandomInt(0, 100);
+                layer.hitbox.stun = RandomInt(0, 2000);
+                break;
+            case 1:
+                layer.type = LAYER_SHAPE;
+                layer.shape.shape = RandomShape();
+                layer.shape.flags = (unsigned int) RandomInt(0, 255);
+                break;
+            default:
+                layer.type = LAYER_BEZIER;
+                layer.bezierPoints = LIST_NEW_SIZED(BezierPoint, frameCount);
+                for (int i = 0; i < frameCount; i++) {
+                    layer.bezierPoints[i] = (BezierPoint) {
+                        .position = {(float) RandomInt(-64, 64), (float) RandomInt(-64, 64)},
+                        .extentsLeft = (float) RandomInt(0, 32),
+                        .extentsRight = (float) RandomInt(0, 32),
+                        .rotation = (float) RandomInt(0, 628) / 100.0f
+                    };
+                }
+                break;
+        }
+        
+        char name[LAYER_NAME_BUFFER_INITIAL_SIZE];
+        snprintf(name, sizeof(name), "Layer %i", layerIdx);
+        layer.name = name;
+        EditorStateLayerAdd(&state, layer);
+    }
+    return state;
+}
+
+typedef struct Bench {
+    const char *name;
+    EditorState *state;
+    long long items; // Work done per iteration, e.g. layers tessellated. Used for the per item time.
+    void *data; // Anything prepared up front so it isn't timed.
+} Bench;
+
+// Keeps the compiler from optimizing away work whose result isn't otherwise used.
+static volatile float benchSink;
+
+static void BenchSerialize(Bench *bench) {
+    EditorStateSerialize(bench->state, BENCH_FILE);
+}
+
+static void BenchDeserialize(Bench *bench) {
+    EditorState state;
+    if (EditorStateDeserialize(&state, BENCH_FILE)) EditorStateFree(&state);
+}
+
+static void BenchDeepCopy(Bench *bench) {
+    EditorState copy = EditorStateDeepCopy(bench->state);
+    EditorStateFree(&copy);
+}
+
+// One iteration is a history with 16 commits that gets fully undone and then redone.
+#define BENCH_HISTORY_COMMITS 16
+static void BenchHistory(Bench *bench) {
+    EditorHistory history = EditorHistoryNew(bench->state);
+    EditorState state = EditorStateDeepCopy(bench->state);
+    for (int i = 0; i < BENCH_HISTORY_COMMITS; i++) {
+        state.frameIdx = i % state.frameCount;
+        EditorHistoryCommitState(&history, &state);
+    }
+    for (int i = 0; i < BENCH_HISTORY_COMMITS; i++) EditorHistoryChangeState(&history, &state, CHANGE_UNDO);
+    for (int i = 0; i < BENCH_HISTORY_COMMITS; i++) EditorHistoryChangeState(&history, &state, CHANGE_REDO);
+    EditorStateFree(&state);
+    EditorHistoryFree(&history);
+}
+
+#define BENCH_LERP_COUNT 4096
+static void BenchBezierLerp(Bench *bench) {
+    BezierPoint p0 = {.position = {0.0f, 0.0f}, .extentsLeft = 10.0f, .extentsRight = 20.0f, .rotation = 0.5f};
+    BezierPoint p1 = {.position = {100.0f, 50.0f}, .extentsLeft = 15.0f, .extentsRight = 5.0f, .rotation = 2.0f};
+    float sum = 0.0f;
+    for (int i = 0; i < BENCH_LERP_COUNT; i++) {
+        Vector2 point = BezierLerp(p0, p1, (float) i / (float) (BENCH_LERP_COUNT - 1));
+        sum += point.x + point.y;
+    }
+    benchSink = sum;
+}
+
+static void BenchFixedBezierLerp(Bench *bench) {
+    FixedBezierPoint p0 = {.position = {0, 0}, .extentsLeft = 10 * FIXED_ONE, .extentsRight = 20 * FIXED_ONE, .rotation = 5215};
+    FixedBezierPoint p1 = {.position = {100 * FIXED_ONE, 50 * FIXED_ONE}, .extentsLeft = 15 * FIXED_ONE, .extentsRight = 5 * FIXED_ONE, .rotation = 20861};
+    int64_t sum = 0;
+    for (int i = 0; i < BENCH_LERP_COUNT; i++) {
+        FixedVector2 point = FixedBezierLerp(p0, p1, (Fixed) ((int64_t) i * FIXED_ONE / (BENCH_LERP_COUNT - 1)));
+        sum += point.x + point.y;
+    }
+    benchSink = (float) sum;
+}
+
+// Everything the editor would draw for one frame.
+static void BenchTessellate(Bench *bench) {
+    LIST(Vector2) points = LIST_NEW(Vector2);
+    EditorState *state = bench->state;
+    int frameIdx = state->frameCount / 2;
+    LayerHierarchy hierarchy = LayerHierarchyNew();
+    LayerHierarchyUpdate(&hierarchy, state, frameIdx);
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        LayerTessellate(state->layers + layerIdx, frameIdx, LayerHierarchyWorld(&hierarchy, layerIdx), &points);
+    }
+    benchSink = (float) LIST_COUNT(points);
+    LayerHierarchyFree(&hierarchy);
+    LIST_FREE(points);
+}
+
+// Steps through every frame the way playback does. The first update builds everything, the rest only compare.
+static void BenchHierarchy(Bench *bench) {
+    EditorState *state = bench->state;
+    LayerHierarchy hierarchy = LayerHierarchyNew();
+    int updated = 0;
+    for (int frameIdx = 0; frameIdx < state->frameCount; frameIdx++) updated += LayerHierarchyUpdate(&hierarchy, state, frameIdx);
+    benchSink = (float) updated;
+    LayerHierarchyFree(&hierarchy);
+}
+
+// What a rollback client does when re-simulating: poses every frame of an already converted animation.
+static void BenchFixedPose(Bench *bench) {
+    FixedAnimation *animation = bench->data;
+    LIST(FixedLayerPose) poses = LIST_NEW_SIZED(FixedLayerPose, animation->layerCount);
+    int64_t sum = 0;
+    for (int frameIdx = 0; frameIdx < animation->frameCount; frameIdx++) {
+        FixedAnimationPose(animation, frameIdx, poses);
+        for (int layerIdx = 0; layerIdx < animation->layerCount; layerIdx++) sum += poses[layerIdx].world.o.x;
+    }
+    benchSink = (float) sum;
+    LIST_FREE(poses);
+}
+
+// Runs the function until enough time has passed to get a stable average and adds the result to the results array.
+static void BenchRun(cJSON *results, Bench bench, void (*function)(Bench *bench)) {
+    // The warm up run counts allocations. It isn't timed so the tracking doesn't skew the results.
+    AllocationTracker tracker;
+    Allocator allocator = AllocatorGet();
+    AllocationTrackerInit(&tracker, allocator);
+    AllocatorSet(AllocationTrackerAllocator(&tracker));
+    function(&bench);
+    AllocatorSet(allocator);
+    long long allocations, peakBytes;
+    AllocationTrackerTotals(&tracker, &allocations, NULL, &peakBytes);
+    AllocationTrackerFree(&tracker);
+    
+    long long iterations = 0;
+    double start = TimerSeconds();
+    double elapsed = 0.0;
+    while (elapsed < BENCH_SECONDS_MIN) {
+        function(&bench);
+        iterations++;
+        elapsed = TimerSeconds() - start;
+    }
+
+    double nanoseconds = elapsed * 1e9 / (double) iterations;
+    cJSON *result = cJSON_CreateObject();
+    cJSON_AddStringToObject(result, "name", bench.name);
+    cJSON_AddNumberToObject(result, "layers", bench.state->layerCount);
+    cJSON_AddNumberToObject(result, "frames", bench.state->frameCount);
+    cJSON_AddNumberToObject(result, "iterations", (double) iterations);
+    cJSON_AddNumberToObject(result, "nsPerIteration", nanoseconds);
+    cJSON_AddNumberToObject(result, "nsPerItem", nanoseconds / (double) bench.items);
+    cJSON_AddNumberToObject(result, "allocations", (double) allocations);
+    cJSON_AddNumberToObject(result, "peakBytes", (double) peakBytes);
+    cJSON_AddItemToArray(results, result);
+    
+    fprintf(stderr, "%-24s %4i layers %5i frames %14.0f ns %8lli allocs %10lli peak bytes\n", bench.name, bench.state->layerCount, bench.state->frameCount, nanoseconds, allocations, peakBytes);
+}
+
+int main(int argc, char **argv) {
+    SetTraceLogLevel(LOG_WARNING);
+    const char *outputPath = NULL;
+    LIST(BenchSize) sizes = LIST_NEW(BenchSize);
+    
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (i + 1 < argc) {
+            BenchSize size = {atoi(argv[i]), atoi(argv[i + 1])};
+            i++;
+            if (size.layerCount < 0 || size.frameCount < 1) {
+                puts("Usage: cac_bench [-o output.json] [layers frames]...");
+                return EXIT_FAILURE;
+            }
+            LIST_ADD(&sizes, size);
+        }
+    }
+    if (LIST_COUNT(sizes) == 0) {
+        LIST_ADD_ARRAY(&sizes, sizesDefault, (int) (sizeof(sizesDefault) / sizeof(sizesDefault[0])));
+    }
+
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "benchVersion", BENCH_VERSION);
+    cJSON_AddNumberToObject(json, "fileVersion", FILE_VERSION_CURRENT);
+    cJSON *results = cJSON_AddArrayToObject(json, "results");
+    
+    for (int i = 0; i < LIST_COUNT(sizes); i++) {
+        EditorState state = BenchAnimation(sizes[i].layerCount, sizes[i].frameCount);
+        long long layerFrames = (long long) state.layerCount * state.frameCount;
+        if (layerFrames < 1) layerFrames = 1;
+
+        EditorStateSerialize(&state, BENCH_FILE); // So deserialize has a file even if serialize is skipped.
+        BenchRun(results, (Bench) {"EditorStateSerialize", &state, layerFrames}, BenchSerialize);
+        BenchRun(results, (Bench) {"EditorStateDeserialize", &state, layerFrames}, BenchDeserialize);
+        BenchRun(results, (Bench) {"EditorStateDeepCopy", &state, layerFrames}, BenchDeepCopy);
+        BenchRun(results, (Bench) {"EditorHistory", &state, BENCH_HISTORY_COMMITS * 3}, BenchHistory);
+        BenchRun(results, (Bench) {"BezierLerp", &state, BENCH_LERP_COUNT}, BenchBezierLerp);
+        BenchRun(results, (Bench) {"FixedBezierLerp", &state, BENCH_LERP_COUNT}, BenchFixedBezierLerp);
+        BenchRun(results, (Bench) {"LayerTessellate", &state, state.layerCount > 0 ? state.layerCount : 1}, BenchTessellate);
+        BenchRun(results, (Bench) {"LayerHierarchyUpdate", &state, layerFrames}, BenchHierarchy);
+        FixedAnimation animation;
+        if (FixedAnimationFromState(&state, &animation)) {
+            BenchRun(results, (Bench) {"FixedAnimationPose", &state, layerFrames, &animation}, BenchFixedPose);
+            FixedAnimationFree(&animation);
+        }
+        EditorStateFree(&state);
+    }
+    remove(BENCH_FILE);
+
+    char *str = cJSON_Print(json);
+    cJSON_Delete(json);
+    LIST_FREE(sizes);
+    
+    if (outputPath) {
+        FILE *file = fopen(outputPath, "w");
+        if (!file) {
+            printf("Failed to open %s for writing.\n", outputPath);
+            free(str);
+            return EXIT_FAILURE;
+        }
+        fputs(str, file);
+        fclose(file);
+    } else {
+        puts(str);
+    }
+    free(str);
+    return EXIT_SUCCESS;
+}
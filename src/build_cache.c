@@ -0,0 +1,66 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "editor_history.h"
+#include "files.h"
+#include "hash.h"
+#include "build_cache.h"
+
+static pthread_mutex_t temporaryMutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int temporaryCount = 0;
+
+uint64_t BuildCacheKey(const void *source, size_t size, const char *kind, const char *variant) {
+    uint32_t versions[2] = {BUILD_CACHE_TOOL_VERSION, FILE_VERSION_CURRENT};
+    uint64_t hash = HashBytes(HASH_SEED, versions, sizeof(versions));
+    // The terminators keep ("ab", "c") and ("a", "bc") apart.
+    hash = HashBytes(hash, kind, strlen(kind) + 1);
+    hash = HashBytes(hash, variant, strlen(variant) + 1);
+    return HashBytes(hash, source, size);
+}
+
+static char *EntryPath(const char *directory, uint64_t key) {
+    char name[sizeof("0123456789abcdef"BUILD_CACHE_EXTENSION)];
+    snprintf(name, sizeof(name), "%016llx"BUILD_CACHE_EXTENSION, (unsigned long long) key);
+    return FilesJoin(directory, name);
+}
+
+unsigned char *BuildCacheLoad(const char *directory, uint64_t key, size_t *size) {
+    char *path = EntryPath(directory, key);
+    unsigned char *data = FilesRead(path, size);
+    free(path);
+    return data;
+}
+
+bool BuildCacheSave(const char *directory, uint64_t key, const void *data, size_t size) {
+    if (!FilesMakeDirectory(directory)) return false;
+    char *path = EntryPath(directory, key);
+
+    // Unique between threads through the counter and between processes sharing the directory through the
+    // stack address and the time, so two writers never share a temporary file.
+    pthread_mutex_lock(&temporaryMutex);
+    unsigned int count = temporaryCount++;
+    pthread_mutex_unlock(&temporaryMutex);
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".%lx.%lx.%x.tmp", (unsigned long) (uintptr_t) &count, (unsigned long) time(NULL), count);
+    size_t pathLength = strlen(path);
+    char *temporaryPath = malloc(pathLength + strlen(suffix) + 1);
+    memcpy(temporaryPath, path, pathLength);
+    strcpy(temporaryPath + pathLength, suffix);
+
+    bool success = FilesWrite(temporaryPath, data, size);
+    if (success && rename(temporaryPath, path) != 0) {
+        // Windows doesn't replace existing files. Another writer got there first with the same content.
+        size_t existingSize;
+        unsigned char *existing = FilesRead(path, &existingSize);
+        success = existing != NULL;
+        free(existing);
+    }
+    remove(temporaryPath);
+    free(temporaryPath);
+    free(path);
+    return success;
+}
@@ -0,0 +1,23 @@
+#ifndef BUILD_CACHE_H
+#define BUILD_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BUILD_CACHE_TOOL_VERSION 1 // Bump whenever the same input starts producing different output.
+#define BUILD_CACHE_ENVIRONMENT "CAC_CACHE" // Cache directory used when none is given on the command line.
+#define BUILD_CACHE_EXTENSION ".cache"
+
+// Content addressed store of generated files in a plain directory, named by the key in hex.
+// Keys cover everything the output depends on so a directory can be shared between checkouts and branches.
+// Entries are written to a temporary file and renamed so readers never see a partial one.
+
+// Hash of the source bytes, BUILD_CACHE_TOOL_VERSION, FILE_VERSION_CURRENT, kind (e.g. the export format)
+// and variant (anything else that changes the output, like the symbol name of a header).
+uint64_t BuildCacheKey(const void *source, size_t size, const char *kind, const char *variant);
+// The cached output for key, malloc'ed. NULL if there isn't one.
+unsigned char *BuildCacheLoad(const char *directory, uint64_t key, size_t *size);
+bool BuildCacheSave(const char *directory, uint64_t key, const void *data, size_t size);
+
+#endif
@@ -0,0 +1,73 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "list.h"
+#include "bytes.h"
+
+void BytesWriteU8(LIST(unsigned char) *buffer, uint8_t value) {
+    LIST_ADD(buffer, value);
+}
+
+void BytesWriteU16(LIST(unsigned char) *buffer, uint16_t value) {
+    unsigned char bytes[2] = {value & 0xFF, (value >> 8) & 0xFF};
+    LIST_ADD_ARRAY(buffer, bytes, 2);
+}
+
+void BytesWriteU32(LIST(unsigned char) *buffer, uint32_t value) {
+    unsigned char bytes[4] = {value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, (value >> 24) & 0xFF};
+    LIST_ADD_ARRAY(buffer, bytes, 4);
+}
+
+void BytesWriteU64(LIST(unsigned char) *buffer, uint64_t value) {
+    BytesWriteU32(buffer, (uint32_t) value);
+    BytesWriteU32(buffer, (uint32_t) (value >> 32));
+}
+
+void BytesWriteI32(LIST(unsigned char) *buffer, int value) {
+    BytesWriteU32(buffer, (uint32_t) value);
+}
+
+void BytesWriteF32(LIST(unsigned char) *buffer, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    BytesWriteU32(buffer, bits);
+}
+
+const unsigned char *BytesRead(BytesReader *reader, size_t size) {
+    if (reader->failed || reader->size - reader->at < size) {
+        reader->failed = true;
+        return NULL;
+    }
+    const unsigned char *bytes = reader->data + reader->at;
+    reader->at += size;
+    return bytes;
+}
+
+uint8_t BytesReadU8(BytesReader *reader) {
+    const unsigned char *bytes = BytesRead(reader, 1);
+    return bytes ? bytes[0] : 0;
+}
+
+uint16_t BytesReadU16(BytesReader *reader) {
+    const unsigned char *bytes = BytesRead(reader, 2);
+    return bytes ? (uint16_t) (bytes[0] | bytes[1] << 8) : 0;
+}
+
+uint32_t BytesReadU32(BytesReader *reader) {
+    const unsigned char *bytes = BytesRead(reader, 4);
+    if (!bytes) return 0;
+    return (uint32_t) bytes[0] | (uint32_t) bytes[1] << 8 | (uint32_t) bytes[2] << 16 | (uint32_t) bytes[3] << 24;
+}
+
+uint64_t BytesReadU64(BytesReader *reader) {
+    uint64_t low = BytesReadU32(reader);
+    uint64_t high = BytesReadU32(reader);
+    return low | high << 32;
+}
+
+int16_t BytesReadI16(BytesReader *reader) {
+    int value = BytesReadU16(reader);
+    // Without converting an out of range value to a signed type, which C leaves up to the implementation.
+    return (int16_t) (value < 0x8000 ? value : value - 0x10000);
+}
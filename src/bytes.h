@@ -0,0 +1,33 @@
+#ifndef BYTES_H
+#define BYTES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "list.h"
+
+// Little endian writers and readers for the binary formats (exports, the project index), which are read the same way
+// on every platform.
+void BytesWriteU8(LIST(unsigned char) *buffer, uint8_t value);
+void BytesWriteU16(LIST(unsigned char) *buffer, uint16_t value);
+void BytesWriteU32(LIST(unsigned char) *buffer, uint32_t value);
+void BytesWriteU64(LIST(unsigned char) *buffer, uint64_t value);
+void BytesWriteI32(LIST(unsigned char) *buffer, int value);
+void BytesWriteF32(LIST(unsigned char) *buffer, float value); // The IEEE 754 bits.
+
+// Reads past the end set failed and return zeros so the caller only has to check once at the end.
+typedef struct BytesReader {
+    const unsigned char *data;
+    size_t size;
+    size_t at;
+    bool failed;
+} BytesReader;
+
+const unsigned char *BytesRead(BytesReader *reader, size_t size); // NULL past the end.
+uint8_t BytesReadU8(BytesReader *reader);
+uint16_t BytesReadU16(BytesReader *reader);
+uint32_t BytesReadU32(BytesReader *reader);
+uint64_t BytesReadU64(BytesReader *reader);
+int16_t BytesReadI16(BytesReader *reader);
+
+#endif
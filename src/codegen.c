@@ -0,0 +1,299 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "editor_history.h"
+#include "layer.h"
+#include "list.h"
+#include "template_table.h"
+#include "codegen.h"
+
+// Always has a decimal point and an f suffix so it's a float literal in both C and C++.
+static void WriteFloat(FILE *file, float value) {
+    if (!isfinite(value)) value = 0.0f;
+    char text[32];
+    snprintf(text, sizeof(text), "%.9g", value);
+    bool decimal = strchr(text, '.') || strchr(text, 'e');
+    fprintf(file, "%s%sf", text, decimal ? "" : ".0");
+}
+
+static void WriteVector2(FILE *file, Vector2 vector) {
+    fputs("{", file);
+    WriteFloat(file, vector.x);
+    fputs(", ", file);
+    WriteFloat(file, vector.y);
+    fputs("}", file);
+}
+
+static void WriteShape(FILE *file, Shape shape) {
+    switch (shape.type) {
+        case SHAPE_CIRCLE:
+            fprintf(file, "{CAC_SHAPE_CIRCLE, %i, 0, 0.0f}", shape.circleRadius);
+            break;
+        case SHAPE_RECTANGLE:
+            fprintf(file, "{CAC_SHAPE_RECTANGLE, %i, %i, 0.0f}", shape.rectangle.rightX, shape.rectangle.bottomY);
+            break;
+        case SHAPE_CAPSULE:
+            fprintf(file, "{CAC_SHAPE_CAPSULE, %i, %i, ", shape.capsule.radius, shape.capsule.height);
+            WriteFloat(file, shape.capsule.rotation);
+            fputs("}", file);
+            break;
+    }
+}
+
+// Escapes quotes and backslashes. Anything outside of printable ascii becomes an octal escape.
+static void WriteString(FILE *file, const char *string) {
+    fputc('"', file);
+    for (const unsigned char *c = (const unsigned char *) string; *c; c++) {
+        if (*c == '"' || *c == '\\') fprintf(file, "\\%c", *c);
+        else if (*c < ' ' || *c > '~') fprintf(file, "\\%03o", *c);
+        else fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+static const char *typeDefinitions =
+    "#ifndef CAC_TABLE_TYPES\n"
+    "#define CAC_TABLE_TYPES\n"
+    "#include <stdint.h>\n"
+    "#ifdef __cplusplus\n"
+    "#define CAC_TABLE static constexpr\n"
+    "#else\n"
+    "#define CAC_TABLE static const\n"
+    "#endif\n"
+    "enum { CAC_LAYER_HITBOX, CAC_LAYER_SHAPE, CAC_LAYER_BEZIER, CAC_LAYER_EMPTY };\n"
+    "enum { CAC_SHAPE_CIRCLE, CAC_SHAPE_RECTANGLE, CAC_SHAPE_CAPSULE };\n"
+    "typedef struct CacVector2 { float x; float y; } CacVector2;\n"
+    "// circle: a = radius. rectangle: a = rightX, b = bottomY. capsule: a = radius, b = height.\n"
+    "typedef struct CacShape { int32_t type; int32_t a; int32_t b; float rotation; } CacShape;\n"
+    "typedef struct CacHitbox { int32_t layer; int32_t knockbackX; int32_t knockbackY; int32_t damage; int32_t stun; CacShape shape; } CacHitbox;\n"
+    "typedef struct CacShapeLayer { int32_t layer; uint32_t flags; CacShape shape; } CacShapeLayer;\n"
+    "typedef struct CacTemplate { char const *name; int32_t knockbackX; int32_t knockbackY; int32_t damage; int32_t stun; uint32_t flags; CacShape shape; } CacTemplate;\n"
+    "typedef struct CacBezierPoint { CacVector2 position; float extentsLeft; float extentsRight; float rotation; } CacBezierPoint;\n"
+    "// shape is zeroed for layers without one.\n"
+    "typedef struct CacLayerSample { CacVector2 position; CacShape shape; } CacLayerSample;\n"
+    "#endif\n\n";
+
+bool CodegenWrite(EditorState *state, const char *symbol, FILE *file) {
+    const char *s = symbol;
+    int frameCount = state->frameCount;
+    int layerCount = state->layerCount;
+    int maskWords = layerCount > 0 ? (layerCount + 31) / 32 : 1;
+    int layerSlots = layerCount > 0 ? layerCount : 1;
+    LayerTemplate **templates = malloc(sizeof(LayerTemplate *) * layerSlots);
+    int *layerTemplates = malloc(sizeof(int) * layerSlots);
+    int templateCount = EditorStateTemplatesUsed(state, templates, layerTemplates);
+    
+    int hitboxCount = 0;
+    int shapeCount = 0;
+    int bezierCount = 0;
+    int keyedCount = 0;
+    for (int i = 0; i < layerCount; i++) {
+        if (LIST_COUNT(state->layers[i].keys) > 0) keyedCount++;
+        switch (state->layers[i].type) {
+            case LAYER_HITBOX: hitboxCount++; break;
+            case LAYER_SHAPE: shapeCount++; break;
+            case LAYER_BEZIER: bezierCount++; break;
+            case LAYER_EMPTY: break;
+        }
+    }
+
+    fprintf(file, "// Generated by cac. Do not edit.\n");
+    fprintf(file, "#ifndef CAC_%s_TABLES_H\n#define CAC_%s_TABLES_H\n\n", s, s);
+    fputs(typeDefinitions, file);
+
+    fprintf(file, "enum {\n");
+    fprintf(file, "    %s_FRAME_COUNT = %i,\n", s, frameCount);
+    fprintf(file, "    %s_LAYER_COUNT = %i,\n", s, layerCount);
+    fprintf(file, "    %s_DURATION = %lli,\n", s, EditorStateDuration(state));
+    fprintf(file, "    %s_ACTIVE_LAYER_WORDS = %i,\n", s, maskWords);
+    fprintf(file, "    %s_HITBOX_COUNT = %i,\n", s, hitboxCount);
+    fprintf(file, "    %s_SHAPE_COUNT = %i,\n", s, shapeCount);
+    fprintf(file, "    %s_BEZIER_COUNT = %i,\n", s, bezierCount);
+    fprintf(file, "    %s_KEYED_COUNT = %i,\n", s, keyedCount);
+    fprintf(file, "    %s_TEMPLATE_COUNT = %i\n", s, templateCount);
+    fprintf(file, "};\n\n");
+
+    fprintf(file, "CAC_TABLE int32_t %s_durations[%i] = {", s, frameCount);
+    for (int i = 0; i < frameCount; i++) fprintf(file, "%s%i", i ? ", " : "", state->frames[i].duration);
+    fprintf(file, "};\n");
+
+    fprintf(file, "CAC_TABLE int32_t %s_frame_starts[%i] = {0", s, frameCount + 1);
+    long long frameStart = 0;
+    for (int i = 0; i < frameCount; i++) {
+        frameStart += state->frames[i].duration;
+        fprintf(file, ", %lli", frameStart);
+    }
+    fprintf(file, "};\n");
+
+    fprintf(file, "CAC_TABLE uint8_t %s_can_cancel[%i] = {", s, frameCount);
+    for (int i = 0; i < frameCount; i++) fprintf(file, "%s%i", i ? ", " : "", state->frames[i].canCancel ? 1 : 0);
+    fprintf(file, "};\n");
+
+    fprintf(file, "CAC_TABLE CacVector2 %s_root_positions[%i] = {", s, frameCount);
+    for (int i = 0; i < frameCount; i++) {
+        if (i) fputs(", ", file);
+        WriteVector2(file, state->frames[i].pos);
+    }
+    fprintf(file, "};\n");
+
+    fprintf(file, "CAC_TABLE uint32_t %s_active_layers[%i][%i] = {\n", s, frameCount, maskWords);
+    for (int frameIdx = 0; frameIdx < frameCount; frameIdx++) {
+        fputs("    {", file);
+        for (int word = 0; word < maskWords; word++) {
+            unsigned int mask = 0;
+            for (int bit = 0; bit < 32 && word * 32 + bit < layerCount; bit++) {
+                if (state->layers[word * 32 + bit].framesActive[frameIdx]) mask |= 1u << bit;
+            }
+            fprintf(file, "%s0x%08xu", word ? ", " : "", mask);
+        }
+        fputs("},\n", file);
+    }
+    fprintf(file, "};\n\n");
+
+    if (layerCount > 0) {
+        fprintf(file, "CAC_TABLE char const *const %s_layer_names[%i] = {", s, layerCount);
+        for (int i = 0; i < layerCount; i++) {
+            if (i) fputs(", ", file);
+            WriteString(file, state->layers[i].name);
+        }
+        fprintf(file, "};\n");
+
+        fprintf(file, "CAC_TABLE uint8_t %s_layer_types[%i] = {", s, layerCount);
+        for (int i = 0; i < layerCount; i++) fprintf(file, "%s%i", i ? ", " : "", (int) state->layers[i].type);
+        fprintf(file, "};\n");
+
+        fprintf(file, "CAC_TABLE CacVector2 %s_layer_positions[%i] = {", s, layerCount);
+        for (int i = 0; i < layerCount; i++) {
+            if (i) fputs(", ", file);
+            WriteVector2(file, state->layers[i].transform.o);
+        }
+        fprintf(file, "};\n");
+
+        fprintf(file, "CAC_TABLE int32_t %s_layer_parents[%i] = {", s, layerCount);
+        for (int i = 0; i < layerCount; i++) fprintf(file, "%s%i", i ? ", " : "", state->layers[i].parent);
+        fprintf(file, "};\n");
+
+        int *order = malloc(sizeof(int) * layerCount);
+        bool ordered = EditorStateLayerOrder(state, order);
+        assert(ordered);
+        (void) ordered;
+        fprintf(file, "CAC_TABLE int32_t %s_layer_order[%i] = {", s, layerCount);
+        for (int i = 0; i < layerCount; i++) fprintf(file, "%s%i", i ? ", " : "", order[i]);
+        fprintf(file, "};\n");
+        free(order);
+
+        fprintf(file, "CAC_TABLE int32_t %s_layer_templates[%i] = {", s, layerCount);
+        for (int i = 0; i < layerCount; i++) fprintf(file, "%s%i", i ? ", " : "", layerTemplates[i]);
+        fprintf(file, "};\n\n");
+    }
+
+    if (templateCount > 0) {
+        fprintf(file, "CAC_TABLE CacTemplate %s_templates[%i] = {\n", s, templateCount);
+        for (int i = 0; i < templateCount; i++) {
+            LayerTemplate *layerTemplate = templates[i];
+            fputs("    {", file);
+            WriteString(file, layerTemplate->name);
+            fprintf(file, ", %i, %i, %i, %i, 0x%08xu, ", layerTemplate->knockbackX, layerTemplate->knockbackY,
+                layerTemplate->damage, layerTemplate->stun, layerTemplate->flags);
+            WriteShape(file, layerTemplate->shape);
+            fputs("},\n", file);
+        }
+        fprintf(file, "};\n");
+    }
+    free(templates);
+    free(layerTemplates);
+
+    if (hitboxCount > 0) {
+        fprintf(file, "CAC_TABLE CacHitbox %s_hitboxes[%i] = {\n", s, hitboxCount);
+        for (int i = 0; i < layerCount; i++) {
+            Layer *layer = state->layers + i;
+            if (layer->type != LAYER_HITBOX) continue;
+            fprintf(file, "    {%i, %i, %i, %i, %i, ", i, layer->hitbox.knockbackX, layer->hitbox.knockbackY, layer->hitbox.damage, layer->hitbox.stun);
+            WriteShape(file, layer->hitbox.shape);
+            fputs("},\n", file);
+        }
+        fprintf(file, "};\n");
+    }
+
+    if (shapeCount > 0) {
+        fprintf(file, "CAC_TABLE CacShapeLayer %s_shapes[%i] = {\n", s, shapeCount);
+        for (int i = 0; i < layerCount; i++) {
+            Layer *layer = state->layers + i;
+            if (layer->type != LAYER_SHAPE) continue;
+            fprintf(file, "    {%i, 0x%08xu, ", i, layer->shape.flags);
+            WriteShape(file, layer->shape.shape);
+            fputs("},\n", file);
+        }
+        fprintf(file, "};\n");
+    }
+
+    if (bezierCount > 0) {
+        fprintf(file, "CAC_TABLE int32_t %s_bezier_layers[%i] = {", s, bezierCount);
+        int bezierIdx = 0;
+        for (int i = 0; i < layerCount; i++) {
+            if (state->layers[i].type != LAYER_BEZIER) continue;
+            fprintf(file, "%s%i", bezierIdx ? ", " : "", i);
+            bezierIdx++;
+        }
+        fprintf(file, "};\n");
+
+        // Points on frames where the layer is inactive are zeroed. Check the active layer mask first.
+        fprintf(file, "CAC_TABLE CacBezierPoint %s_bezier_points[%i][%i] = {\n", s, bezierCount, frameCount);
+        for (int i = 0; i < layerCount; i++) {
+            Layer *layer = state->layers + i;
+            if (layer->type != LAYER_BEZIER) continue;
+            fputs("    {\n", file);
+            for (int frameIdx = 0; frameIdx < frameCount; frameIdx++) {
+                BezierPoint point = {0};
+                if (layer->framesActive[frameIdx]) point = layer->bezierPoints[frameIdx];
+                fputs("        {", file);
+                WriteVector2(file, point.position);
+                fputs(", ", file);
+                WriteFloat(file, point.extentsLeft);
+                fputs(", ", file);
+                WriteFloat(file, point.extentsRight);
+                fputs(", ", file);
+                WriteFloat(file, point.rotation);
+                fputs("},\n", file);
+            }
+            fputs("    },\n", file);
+        }
+        fprintf(file, "};\n");
+    }
+
+    if (keyedCount > 0) {
+        fprintf(file, "CAC_TABLE int32_t %s_keyed_layers[%i] = {", s, keyedCount);
+        int keyedIdx = 0;
+        for (int i = 0; i < layerCount; i++) {
+            if (LIST_COUNT(state->layers[i].keys) == 0) continue;
+            fprintf(file, "%s%i", keyedIdx ? ", " : "", i);
+            keyedIdx++;
+        }
+        fprintf(file, "};\n");
+
+        fprintf(file, "CAC_TABLE CacLayerSample %s_keyed_samples[%i][%i] = {\n", s, keyedCount, frameCount);
+        for (int i = 0; i < layerCount; i++) {
+            Layer *layer = state->layers + i;
+            if (LIST_COUNT(layer->keys) == 0) continue;
+            bool hasShape = LayerShapeBase(layer) != NULL;
+            fputs("    {\n", file);
+            for (int frameIdx = 0; frameIdx < frameCount; frameIdx++) {
+                LayerSample sample = LayerSampleAt(layer, frameIdx);
+                fputs("        {", file);
+                WriteVector2(file, sample.position);
+                fputs(", ", file);
+                if (hasShape) WriteShape(file, sample.shape);
+                else fputs("{0, 0, 0, 0.0f}", file);
+                fputs("},\n", file);
+            }
+            fputs("    },\n", file);
+        }
+        fprintf(file, "};\n");
+    }
+
+    fprintf(file, "\n#endif\n");
+    return !ferror(file);
+}
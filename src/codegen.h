@@ -0,0 +1,30 @@
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "editor_history.h"
+
+// Writes a C/C++ header with the whole animation as static read-only tables so nothing has to be parsed at runtime.
+// Every name is prefixed with symbol. For an animation "Jab" with F frames and L layers it contains:
+//  Jab_FRAME_COUNT, Jab_LAYER_COUNT, Jab_DURATION and a count for each of the payload tables below.
+//  Jab_durations[F]            frame durations in ms
+//  Jab_frame_starts[F + 1]     summed durations, so frame i is shown from Jab_frame_starts[i] until Jab_frame_starts[i + 1]
+//  Jab_can_cancel[F]
+//  Jab_root_positions[F]
+//  Jab_active_layers[F][W]     bit (j % 32) of word (j / 32) is set when layer j is active on the frame
+//  Jab_layer_names[L], Jab_layer_types[L], Jab_layer_positions[L]
+//  Jab_layer_parents[L]        index of the layer each one moves along with or -1. Positions are relative to it.
+//  Jab_layer_order[L]          layer indices with parents first, so world positions can be summed in one pass:
+//                                  world[j] = position[j] + (parent[j] < 0 ? 0 : world[parent[j]]) for j in order
+//  Jab_layer_templates[L]      index into Jab_templates of the template each layer is linked to or -1
+//  Jab_templates[]             the templates the layers use, with their own values. The layers' payloads below
+//                              always hold the values in effect, so only tools that care about the link read these.
+//  Jab_hitboxes[], Jab_shapes[] payloads of the hitbox and shape layers, each naming its layer index
+//  Jab_bezier_layers[], Jab_bezier_points[][F] one row of points per bezier layer
+//  Jab_keyed_layers[], Jab_keyed_samples[][F] one row per layer with keyframes, evaluated for every frame.
+//      The position and shape in the other tables are the ones of frame 0 for these layers.
+// The types shared by every generated header are guarded by CAC_TABLE_TYPES.
+bool CodegenWrite(EditorState *state, const char *symbol, FILE *file);
+
+#endif
@@ -1,13 +1,24 @@
 #include <assert.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
 #include "cJSON.h"
+#include "hash.h"
+#include "json_schema.h"
 #include "layer.h"
 #include "string_buffer.h"
+#include "string_table.h"
+#include "worker_pool.h"
 #include "editor_history.h"
 
+#define LAYER_INDEX_CAPACITY_MINIMUM 8
+#define LAYER_CAPACITY_MINIMUM 4
+#define LAYER_NAME_NUMBERED_SIZE 16 // Room for a space and the number appended by EditorStateLayerNameUnique.
+#define DESERIALIZE_PARALLEL_MIN_CELLS 16384 // Layers times frames before layers are converted on a pool.
+#define DESERIALIZE_JOBS_PER_THREAD 4 // Smaller ranges so one heavy range doesn't leave the other threads idle.
+
 EditorState EditorStateNew(int frameCount) {
     FrameInfo *frames = malloc(sizeof(FrameInfo) * frameCount);
     for (int i = 0; i < frameCount; i++) {
@@ -15,12 +26,19 @@ EditorState EditorStateNew(int frameCount) {
             .pos = (Vector2) { 0, 0 },
             .duration = 100,
             .canCancel = false,
+            .atlasRect = (Rectangle) {0.0f, 0.0f, 0.0f, 0.0f}
         };
     }
 
     return (EditorState) {
+        .sourceType = SPRITE_SOURCE_STRIP,
         .layerCount = 0,
+        .layerCapacity = 0,
         .layers = NULL,
+        .strings = StringTableNew(),
+        .templates = TemplateTableNew(NULL),
+        .layerIndex = NULL,
+        .layerIndexCapacity = 0,
         .frames = frames,
         .frameCount = frameCount,
         .frameIdx = 0,
@@ -34,54 +52,307 @@ void EditorStateFree(EditorState *state) {
     }
     free(state->layers);
     free(state->frames);
+    free(state->layerIndex);
+    StringTableRelease(state->strings);
+    TemplateTableRelease(state->templates);
+}
+
+static int LayerIndexSlot(const char *name, int capacity) {
+    return (int) (HashBytes(HASH_SEED, &name, sizeof(name)) & (capacity - 1));
+}
+
+static void LayerIndexInsert(EditorState *state, int layerIdx) {
+    int capacity = state->layerIndexCapacity;
+    int slot = LayerIndexSlot(state->layers[layerIdx].name, capacity);
+    while (state->layerIndex[slot] >= 0) slot = (slot + 1) & (capacity - 1);
+    state->layerIndex[slot] = layerIdx;
+}
+
+// Sized so layerCountMax layers keep it at most half full.
+static void EditorStateLayerIndexBuild(EditorState *state, int layerCountMax) {
+    int capacity = LAYER_INDEX_CAPACITY_MINIMUM;
+    while (capacity < layerCountMax * 2) capacity *= 2;
+    if (capacity != state->layerIndexCapacity) {
+        free(state->layerIndex);
+        state->layerIndex = malloc(sizeof(int) * capacity);
+        state->layerIndexCapacity = capacity;
+    }
+    for (int i = 0; i < capacity; i++) state->layerIndex[i] = -1;
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) LayerIndexInsert(state, layerIdx);
+}
+
+int EditorStateLayerFind(EditorState *state, const char *name) {
+    // Names are interned so once the string is found the pointer can be compared.
+    const char *interned = StringTableFind(state->strings, name);
+    if (!interned || state->layerIndexCapacity == 0) return -1;
+    
+    int mask = state->layerIndexCapacity - 1;
+    for (int slot = LayerIndexSlot(interned, state->layerIndexCapacity); state->layerIndex[slot] >= 0; slot = (slot + 1) & mask) {
+        int layerIdx = state->layerIndex[slot];
+        if (state->layers[layerIdx].name == interned) return layerIdx;
+    }
+    return -1;
+}
+
+const char *EditorStateLayerNameUnique(EditorState *state, const char *name) {
+    if (EditorStateLayerFind(state, name) < 0) return StringTableIntern(state->strings, name);
+    
+    size_t bufferSize = strlen(name) + LAYER_NAME_NUMBERED_SIZE;
+    char *numbered = malloc(bufferSize);
+    for (int number = 2;; number++) {
+        snprintf(numbered, bufferSize, "%s %i", name, number);
+        if (EditorStateLayerFind(state, numbered) < 0) break;
+    }
+    const char *interned = StringTableIntern(state->strings, numbered);
+    free(numbered);
+    return interned;
 }
 
-// Takes ownership of layer
+// Makes room for count layers in total, so adding up to that many neither reallocates the layers nor rebuilds the index.
+static void EditorStateLayersReserve(EditorState *state, int count) {
+    if (count > state->layerCapacity) {
+        state->layerCapacity = count;
+        state->layers = realloc(state->layers, sizeof(Layer) * state->layerCapacity);
+    }
+    if (count * 2 > state->layerIndexCapacity) EditorStateLayerIndexBuild(state, count);
+}
+
+// Takes ownership of layer. The name doesn't need to be interned yet and gets a number appended if it is taken.
 void EditorStateLayerAdd(EditorState *state, Layer layer) {
+    layer.name = EditorStateLayerNameUnique(state, layer.name);
+    if (layer.templateName) layer.templateName = StringTableIntern(state->strings, layer.templateName);
+    // Both the layers and the index grow by doubling, so adding a layer is constant time on average.
+    if (state->layerCount == state->layerCapacity) {
+        state->layerCapacity = state->layerCapacity > 0 ? state->layerCapacity * 2 : LAYER_CAPACITY_MINIMUM;
+        state->layers = realloc(state->layers, sizeof(Layer) * state->layerCapacity);
+    }
+    state->layers[state->layerCount] = layer;
     state->layerCount++;
-    state->layers = realloc(state->layers, sizeof(Layer) * state->layerCount);
-    state->layers[state->layerCount - 1] = layer;
+    if (state->layerCount * 2 > state->layerIndexCapacity) EditorStateLayerIndexBuild(state, state->layerCount);
+    else LayerIndexInsert(state, state->layerCount - 1);
+}
+
+bool EditorStateLayerRename(EditorState *state, int idx, const char *name) {
+    if (idx < 0 || idx >= state->layerCount || name[0] == '\0') return false;
+    int existing = EditorStateLayerFind(state, name);
+    if (existing == idx) return true;
+    if (existing >= 0) return false;
+    
+    state->layers[idx].name = StringTableIntern(state->strings, name);
+    EditorStateLayerIndexBuild(state, state->layerCount);
+    return true;
 }
 
 bool EditorStateLayerRemove(EditorState *state, int idx) {
     if (idx < 0 || idx >= state->layerCount) return false;
+    int removedParent = state->layers[idx].parent;
+    // The children take over the removed layer's transform so their world transforms stay the same. A removed layer
+    // with keys only has one transform per frame, so the one on the current frame is used for every frame.
+    Transform2D removedLocal = LayerTransformAt(state->layers + idx, state->frameIdx);
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Layer *child = state->layers + layerIdx;
+        if (child->parent != idx) continue;
+        child->transform = Transform2DMultiply(removedLocal, child->transform);
+        for (int keyIdx = 0; keyIdx < LIST_COUNT(child->keys); keyIdx++) {
+            Vector2 *position = &child->keys[keyIdx].value.position;
+            *position = Transform2DToGlobal(removedLocal, *position);
+        }
+        if (LIST_COUNT(child->keys) > 0) LayerKeysBake(child);
+    }
     LayerFree(state->layers + idx);    
     for (int layerIdx = idx + 1; layerIdx < state->layerCount; layerIdx++) {
         int newLayerIdx = layerIdx - 1;
         state->layers[newLayerIdx] = state->layers[layerIdx];
     }
     state->layerCount--;
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        int *parent = &state->layers[layerIdx].parent;
+        if (*parent == idx) *parent = removedParent;
+        if (*parent > idx) (*parent)--;
+    }
     if (state->layerIdx >= state->layerCount) state->layerIdx = state->layerCount - 1;
+    EditorStateLayerIndexBuild(state, state->layerCount);
+    return true;
+}
+
+bool EditorStateLayerIsAncestor(EditorState *state, int ancestor, int idx) {
+    // Bounded by the layer count so a cycle can't hang it.
+    for (int depth = 0; idx >= 0 && depth <= state->layerCount; depth++) {
+        idx = state->layers[idx].parent;
+        if (idx == ancestor) return true;
+    }
+    return false;
+}
+
+bool EditorStateLayerParentSet(EditorState *state, int idx, int parent) {
+    if (idx < 0 || idx >= state->layerCount || parent < -1 || parent >= state->layerCount) return false;
+    if (parent == idx || (parent >= 0 && EditorStateLayerIsAncestor(state, idx, parent))) return false;
+    state->layers[idx].parent = parent;
     return true;
 }
 
-void EditorStateAddFrame(EditorState *state, int idx) {
-    if (idx < 0 || idx >= state->frameCount) assert(false);
-    state->frameCount++; 
-    state->frames = realloc(state->frames, sizeof(FrameInfo) * state->frameCount);
+bool EditorStateLayerOrder(EditorState *state, int *order) {
+    int layerCount = state->layerCount;
+    if (layerCount == 0) return true;
+    // Depth of every layer, found by walking up to the first ancestor with a known depth.
+    int *depths = malloc(sizeof(int) * layerCount * 2);
+    int *chain = depths + layerCount;
+    for (int i = 0; i < layerCount; i++) depths[i] = -1;
 
-    // Duplicate last frame to use as the new frame. It has no allocations so we can just assign it.
-    state->frames[state->frameCount - 1] = state->frames[state->frameCount - 2];
+    bool success = true;
+    int depthMax = 0;
+    for (int layerIdx = 0; layerIdx < layerCount && success; layerIdx++) {
+        int chainCount = 0;
+        int ancestor = layerIdx;
+        while (ancestor >= 0 && depths[ancestor] < 0) {
+            if (chainCount == layerCount) {
+                success = false;
+                break;
+            }
+            chain[chainCount++] = ancestor;
+            ancestor = state->layers[ancestor].parent;
+        }
+        int depth = ancestor >= 0 ? depths[ancestor] + 1 : 0;
+        for (int i = chainCount - 1; i >= 0; i--) depths[chain[i]] = depth++;
+        if (depth - 1 > depthMax) depthMax = depth - 1;
+    }
 
-    // Resize each layer so it has the right amount of frames
-    for (int i = 0; i < state->layerCount; i++) LIST_ADD(&state->layers[i].framesActive, false); 
+    if (success) {
+        // Counting sort by depth, stable so layers of the same depth keep their order.
+        int *starts = calloc(depthMax + 2, sizeof(int));
+        for (int i = 0; i < layerCount; i++) starts[depths[i] + 1]++;
+        for (int depth = 1; depth <= depthMax + 1; depth++) starts[depth] += starts[depth - 1];
+        for (int i = 0; i < layerCount; i++) order[starts[depths[i]]++] = i;
+        free(starts);
+    }
+    free(depths);
+    return success;
 }
 
-bool EditorStateRemoveFrame(EditorState *state, int idx) {
-    if (idx < 0 || idx >= state->frameCount || state->frameCount == 1) return false;
-   
-    for (int i = idx + 1; i < state->frameCount; i++) {
-        state->frames[i - 1] = state->frames[i];
+bool EditorStateTemplateSave(EditorState *state, int idx, const char *name) {
+    if (idx < 0 || idx >= state->layerCount || TemplateFields(state->layers[idx].type) == 0) return false;
+    const char *interned = StringTableIntern(state->strings, name);
+    bool existed = TemplateTableFind(state->templates, interned) != NULL;
+    LayerTemplate *saved = TemplateTableSet(state->templates, TemplateFromLayer(state->layers + idx, interned));
+    state->layers[idx].templateName = interned;
+    state->layers[idx].templateOverrides = 0;
+    if (!existed) return true;
+
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Layer *layer = state->layers + layerIdx;
+        if (layerIdx == idx || layer->templateName != interned) continue;
+        TemplateApply(saved, layer, ~TemplateOverrides(saved, layer));
     }
+    return true;
+}
+
+bool EditorStateTemplateLink(EditorState *state, int idx, const char *name) {
+    if (idx < 0 || idx >= state->layerCount || TemplateFields(state->layers[idx].type) == 0) return false;
+    Layer *layer = state->layers + idx;
+    if (!name) {
+        layer->templateName = NULL;
+        layer->templateOverrides = 0;
+        return true;
+    }
+    LayerTemplate *layerTemplate = TemplateTableFind(state->templates, name);
+    if (!layerTemplate) return false;
+    layer->templateName = StringTableIntern(state->strings, name);
+    layer->templateOverrides = 0;
+    TemplateApply(layerTemplate, layer, TemplateFields(layer->type));
+    return true;
+}
+
+void EditorStateTemplatesSync(EditorState *state) {
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Layer *layer = state->layers + layerIdx;
+        LayerTemplate *layerTemplate = layer->templateName ? TemplateTableFind(state->templates, layer->templateName) : NULL;
+        if (layerTemplate) TemplateApply(layerTemplate, layer, ~TemplateOverrides(layerTemplate, layer));
+    }
+}
 
+int EditorStateTemplatesUsed(EditorState *state, LayerTemplate **used, int *layerTemplates) {
+    int usedCount = 0;
     for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
-        for (int frameIdx = idx + 1; frameIdx < state->frameCount; frameIdx++) {
-            state->layers[layerIdx].framesActive[frameIdx - 1] = state->layers[layerIdx].framesActive[frameIdx];
+        Layer *layer = state->layers + layerIdx;
+        bool linked = layer->templateName && TemplateFields(layer->type);
+        LayerTemplate *layerTemplate = linked ? TemplateTableFind(state->templates, layer->templateName) : NULL;
+        layerTemplates[layerIdx] = -1;
+        if (!layerTemplate) continue;
+        int usedIdx = 0;
+        while (usedIdx < usedCount && used[usedIdx] != layerTemplate) usedIdx++;
+        if (usedIdx == usedCount) used[usedCount++] = layerTemplate;
+        layerTemplates[layerIdx] = usedIdx;
+    }
+    return usedCount;
+}
+
+// Opens count uninitialized frames at idx in the frames and every layer's per frame lists. Each list is grown
+// to its final size once and moved with a single memmove, so the cost doesn't depend on count.
+static void FramesOpen(EditorState *state, int idx, int count) {
+    assert(0 <= idx && idx <= state->frameCount && count > 0);
+    state->frames = realloc(state->frames, sizeof(FrameInfo) * (state->frameCount + count));
+    memmove(state->frames + idx + count, state->frames + idx, sizeof(FrameInfo) * (state->frameCount - idx));
+
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Layer *layer = state->layers + layerIdx;
+        assert(LIST_COUNT(layer->framesActive) == state->frameCount);
+        LIST_INSERT_GAP(&layer->framesActive, idx, count);
+        if (layer->type == LAYER_BEZIER) {
+            assert(LIST_COUNT(layer->bezierPoints) == state->frameCount);
+            LIST_INSERT_GAP(&layer->bezierPoints, idx, count);
         }
-        assert(LIST_COUNT(state->layers[layerIdx].framesActive) == state->frameCount);
-        LIST_POP(state->layers[layerIdx].framesActive);
+        LayerKeysFramesInsert(layer, idx, count);
     }
-    state->frameCount--;
+    state->frameCount += count;
+}
+
+void EditorStateFramesInsert(EditorState *state, int idx, int count) {
+    assert(0 <= idx && idx <= state->frameCount && count > 0);
+    // New frames take their timing and position from the frame before them, or after them at the start.
+    FrameInfo frameTemplate = state->frames[idx > 0 ? idx - 1 : 0];
+    FramesOpen(state, idx, count);
+    for (int i = idx; i < idx + count; i++) state->frames[i] = frameTemplate;
+
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Layer *layer = state->layers + layerIdx;
+        memset(layer->framesActive + idx, 0, sizeof(bool) * count);
+        // Undefined while inactive, zeroed anyway so saved files don't depend on leftover memory.
+        if (layer->type == LAYER_BEZIER) memset(layer->bezierPoints + idx, 0, sizeof(BezierPoint) * count);
+        LayerKeysBake(layer);
+    }
+}
+
+void EditorStateFramesDuplicate(EditorState *state, int idx, int count) {
+    assert(0 <= idx && count > 0 && idx + count <= state->frameCount);
+    // The copies go right after the range, so opening them doesn't move the range itself.
+    FramesOpen(state, idx + count, count);
+    memcpy(state->frames + idx + count, state->frames + idx, sizeof(FrameInfo) * count);
+
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Layer *layer = state->layers + layerIdx;
+        memcpy(layer->framesActive + idx + count, layer->framesActive + idx, sizeof(bool) * count);
+        if (layer->type == LAYER_BEZIER) memcpy(layer->bezierPoints + idx + count, layer->bezierPoints + idx, sizeof(BezierPoint) * count);
+        LayerKeysFramesDuplicate(layer, idx, count);
+        LayerKeysBake(layer);
+    }
+}
+
+bool EditorStateFramesRemove(EditorState *state, int idx, int count) {
+    if (idx < 0 || count <= 0 || idx + count > state->frameCount || count == state->frameCount) return false;
+
+    memmove(state->frames + idx, state->frames + idx + count, sizeof(FrameInfo) * (state->frameCount - idx - count));
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Layer *layer = state->layers + layerIdx;
+        assert(LIST_COUNT(layer->framesActive) == state->frameCount);
+        LIST_REMOVE_RANGE(layer->framesActive, idx, count);
+        if (layer->type == LAYER_BEZIER) {
+            assert(LIST_COUNT(layer->bezierPoints) == state->frameCount);
+            LIST_REMOVE_RANGE(layer->bezierPoints, idx, count);
+        }
+        LayerKeysFramesRemove(layer, idx, count);
+        LayerKeysBake(layer);
+    }
+    state->frameCount -= count;
     return true;
 }
 
@@ -96,14 +367,14 @@ EditorState EditorStateDeepCopy(EditorState *state) {
         for (int i = 0; i < state->layerCount; i++) {
             Layer *layer = layersCopy + i;
 
-            char *name = malloc(layer->nameBufferLength);
-            memcpy(name, layer->name, layer->nameBufferLength);
-            layer->name = name;
+            // The name is interned in the shared string table so it is not copied.
             layer->framesActive = LIST_CLONE(bool, layer->framesActive);
 
             if (layer->type == LAYER_BEZIER) {
                 layer->bezierPoints = LIST_CLONE(BezierPoint, layer->bezierPoints);
             }
+            layer->keys = LIST_CLONE(LayerKey, layer->keys);
+            layer->samples = LIST_CLONE(LayerSample, layer->samples);
         }
     }
     
@@ -111,8 +382,20 @@ EditorState EditorStateDeepCopy(EditorState *state) {
     FrameInfo *framesCopy = malloc(framesSize);
     memcpy(framesCopy, state->frames, framesSize);
 
+    int *layerIndexCopy = NULL;
+    if (state->layerIndexCapacity > 0) {
+        layerIndexCopy = malloc(sizeof(int) * state->layerIndexCapacity);
+        memcpy(layerIndexCopy, state->layerIndex, sizeof(int) * state->layerIndexCapacity);
+    }
+
     return (EditorState) {
+        .sourceType = state->sourceType,
         .layerCount = state->layerCount,
+        .layerCapacity = state->layerCount,
+        .strings = StringTableRetain(state->strings),
+        .templates = TemplateTableRetain(state->templates),
+        .layerIndex = layerIndexCopy,
+        .layerIndexCapacity = state->layerIndexCapacity,
         .frameCount = state->frameCount,
         .layers = layersCopy,
         .frames = framesCopy,
@@ -121,6 +404,47 @@ EditorState EditorStateDeepCopy(EditorState *state) {
     };
 }
 
+long long EditorStateDuration(EditorState *state) {
+    long long duration = 0;
+    for (int i = 0; i < state->frameCount; i++) duration += state->frames[i].duration;
+    return duration;
+}
+
+long long EditorStateFrameStart(EditorState *state, int frameIdx) {
+    assert(0 <= frameIdx && frameIdx < state->frameCount);
+    long long start = 0;
+    for (int i = 0; i < frameIdx; i++) start += state->frames[i].duration;
+    return start;
+}
+
+int EditorStateFrameAtTime(EditorState *state, long long time) {
+    long long duration = EditorStateDuration(state);
+    if (duration <= 0) return 0;
+    time %= duration;
+    if (time < 0) time += duration;
+
+    long long frameEnd = 0;
+    for (int i = 0; i < state->frameCount; i++) {
+        frameEnd += state->frames[i].duration;
+        if (time < frameEnd) return i;
+    }
+    return state->frameCount - 1;
+}
+
+// The string table is shared between copies so it isn't included.
+size_t EditorStateMemorySize(EditorState *state) {
+    size_t size = sizeof(Layer) * state->layerCapacity + sizeof(FrameInfo) * state->frameCount + sizeof(int) * state->layerIndexCapacity;
+    for (int i = 0; i < state->layerCount; i++) {
+        Layer *layer = state->layers + i;
+        size += LIST_SIZE_ALLOCATED(layer->framesActive);
+        if (layer->type == LAYER_BEZIER) {
+            size += LIST_SIZE_ALLOCATED(layer->bezierPoints);
+        }
+        size += LIST_SIZE_ALLOCATED(layer->keys) + LIST_SIZE_ALLOCATED(layer->samples);
+    }
+    return size;
+}
+
 /// clones everything passed in, is safe.
 EditorHistory EditorHistoryNew(EditorState *initial) {
     EditorHistory history;
@@ -169,14 +493,37 @@ void EditorHistoryChangeState(EditorHistory *history, EditorState *state, Change
     EditorState oldState = *state;
     *state = EditorStateDeepCopy(&history->_states[history->_currentStateIdx]);
     EditorStateFree(&oldState);
+    // The templates aren't part of the history, so the state may hold values they had before.
+    EditorStateTemplatesSync(state);
 }
 
-bool EditorStateSerialize(EditorState *state, const char *path) {
+size_t EditorHistoryMemorySize(EditorHistory *history) {
+    size_t size = LIST_SIZE_ALLOCATED(history->_states) + StringTableMemorySize(history->_states[0].strings);
+    for (int i = 0; i <= history->_mostRecentStateIdx; i++) {
+        size += EditorStateMemorySize(&history->_states[i]);
+    }
+    return size;
+}
+
+// The layer names are referenced instead of copied, so the json must be deleted before the state changes.
+cJSON *EditorStateToJson(EditorState *state) {
     cJSON *json = cJSON_CreateObject();
     cJSON_AddStringToObject(json, "magic", "CombatAnimator");
 
     cJSON_AddNumberToObject(json, "version", FILE_VERSION_CURRENT);
 
+    switch (state->sourceType) {
+        case SPRITE_SOURCE_STRIP:
+            cJSON_AddStringToObject(json, "source", "STRIP");
+            break;
+        case SPRITE_SOURCE_SEQUENCE:
+            cJSON_AddStringToObject(json, "source", "SEQUENCE");
+            break;
+        case SPRITE_SOURCE_ATLAS:
+            cJSON_AddStringToObject(json, "source", "ATLAS");
+            break;
+    }
+
     cJSON *layers = cJSON_CreateArray();
     for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
         Layer *layer = state->layers + layerIdx;
@@ -195,22 +542,37 @@ bool EditorStateSerialize(EditorState *state, const char *path) {
         cJSON *nameJson = cJSON_CreateStringReference(layer->name); 
         cJSON_AddItemToObject(layerJson, "name", nameJson);
 
+        // Linked layers only store what differs from their template. A missing template makes everything differ.
+        unsigned int overrides = TemplateFields(layer->type);
+        if (overrides) {
+            LayerTemplate *layerTemplate = layer->templateName ? TemplateTableFind(state->templates, layer->templateName) : NULL;
+            overrides = TemplateOverrides(layerTemplate, layer);
+            if (layer->templateName) {
+                cJSON_AddItemToObject(layerJson, "template", cJSON_CreateStringReference(layer->templateName));
+                cJSON_AddNumberToObject(layerJson, "overrides", layer->templateOverrides & TemplateFields(layer->type));
+            } else {
+                cJSON_AddNullToObject(layerJson, "template");
+            }
+        }
+
         switch (layer->type) {
             case LAYER_HITBOX:
                 cJSON_AddStringToObject(layerJson, "type", "HITBOX");
                 cJSON *hitbox = cJSON_CreateObject();
-                cJSON_AddNumberToObject(hitbox, "knockbackX", layer->hitbox.knockbackX);
-                cJSON_AddNumberToObject(hitbox, "knockbackY", layer->hitbox.knockbackY);
-                cJSON_AddNumberToObject(hitbox, "damage", layer->hitbox.damage);
-                cJSON_AddNumberToObject(hitbox, "stun", layer->hitbox.stun);
-                cJSON_AddItemToObject(hitbox, "shape", ShapeSerialize(layer->hitbox.shape));
+                if (overrides & TEMPLATE_FIELD_KNOCKBACK) {
+                    cJSON_AddNumberToObject(hitbox, "knockbackX", layer->hitbox.knockbackX);
+                    cJSON_AddNumberToObject(hitbox, "knockbackY", layer->hitbox.knockbackY);
+                }
+                if (overrides & TEMPLATE_FIELD_DAMAGE) cJSON_AddNumberToObject(hitbox, "damage", layer->hitbox.damage);
+                if (overrides & TEMPLATE_FIELD_STUN) cJSON_AddNumberToObject(hitbox, "stun", layer->hitbox.stun);
+                if (overrides & TEMPLATE_FIELD_SHAPE) cJSON_AddItemToObject(hitbox, "shape", ShapeSerialize(layer->hitbox.shape));
                 cJSON_AddItemToObject(layerJson, "hitbox", hitbox);
                 break;
             case LAYER_SHAPE:
                 cJSON_AddStringToObject(layerJson, "type", "SHAPE");
                 cJSON *shape = cJSON_CreateObject();
-                cJSON_AddItemToObject(shape, "shape", ShapeSerialize(layer->shape.shape));
-                cJSON_AddNumberToObject(shape, "flags", layer->shape.flags);
+                if (overrides & TEMPLATE_FIELD_SHAPE) cJSON_AddItemToObject(shape, "shape", ShapeSerialize(layer->shape.shape));
+                if (overrides & TEMPLATE_FIELD_FLAGS) cJSON_AddNumberToObject(shape, "flags", layer->shape.flags);
                 cJSON_AddItemToObject(layerJson, "shape", shape);
                 break;
             case LAYER_BEZIER:
@@ -218,7 +580,10 @@ bool EditorStateSerialize(EditorState *state, const char *path) {
                 cJSON *bezierPointsJson = cJSON_CreateArray();
                 int frameCount = LIST_COUNT(layer->bezierPoints);
                 for (int frameIdx = 0; frameIdx < frameCount; frameIdx++) {
-                    if (!layer->framesActive[frameIdx]) continue;
+                    if (!layer->framesActive[frameIdx]) {
+                        cJSON_AddItemToArray(bezierPointsJson, cJSON_CreateNull());
+                        continue;
+                    }
                     BezierPoint bezier = layer->bezierPoints[frameIdx];
                     cJSON *bezierJson = cJSON_CreateObject();
                     cJSON_AddNumberToObject(bezierJson, "x", bezier.position.x);
@@ -235,6 +600,20 @@ bool EditorStateSerialize(EditorState *state, const char *path) {
                 cJSON_AddStringToObject(layerJson, "type", "EMPTY");
                 break;
         }
+
+        cJSON *keysJson = cJSON_CreateArray();
+        for (int keyIdx = 0; keyIdx < LIST_COUNT(layer->keys); keyIdx++) {
+            LayerKey key = layer->keys[keyIdx];
+            cJSON *keyJson = cJSON_CreateObject();
+            cJSON_AddNumberToObject(keyJson, "frame", key.frame);
+            cJSON_AddNumberToObject(keyJson, "x", key.value.position.x);
+            cJSON_AddNumberToObject(keyJson, "y", key.value.position.y);
+            if (LayerShapeBase(layer)) cJSON_AddItemToObject(keyJson, "shape", ShapeSerialize(key.value.shape));
+            cJSON_AddItemToArray(keysJson, keyJson);
+        }
+        cJSON_AddItemToObject(layerJson, "keys", keysJson);
+        if (layer->parent >= 0) cJSON_AddStringToObject(layerJson, "parent", state->layers[layer->parent].name);
+        else cJSON_AddNullToObject(layerJson, "parent");
         cJSON_AddItemToArray(layers, layerJson);
     }
     cJSON_AddItemToObject(json, "layers", layers);
@@ -247,10 +626,22 @@ bool EditorStateSerialize(EditorState *state, const char *path) {
         cJSON_AddBoolToObject(frame, "canCancel", frameInfo.canCancel);
         cJSON_AddNumberToObject(frame, "x", frameInfo.pos.x);
         cJSON_AddNumberToObject(frame, "y", frameInfo.pos.y);
+        if (state->sourceType == SPRITE_SOURCE_ATLAS) {
+            cJSON *atlas = cJSON_CreateObject();
+            cJSON_AddNumberToObject(atlas, "x", frameInfo.atlasRect.x);
+            cJSON_AddNumberToObject(atlas, "y", frameInfo.atlasRect.y);
+            cJSON_AddNumberToObject(atlas, "width", frameInfo.atlasRect.width);
+            cJSON_AddNumberToObject(atlas, "height", frameInfo.atlasRect.height);
+            cJSON_AddItemToObject(frame, "atlas", atlas);
+        }
         cJSON_AddItemToArray(frames, frame);
     }
     cJSON_AddItemToObject(json, "frames", frames);
+    return json;
+}
 
+bool EditorStateSerialize(EditorState *state, const char *path) {
+    cJSON *json = EditorStateToJson(state);
     FILE *file = fopen(path, "w+");
     if (!file) {
         cJSON_Delete(json);
@@ -264,6 +655,295 @@ bool EditorStateSerialize(EditorState *state, const char *path) {
     return true;
 }
 
+// Keys read from each kind of object in the file. Indices into the field arrays filled by JsonSchemaRead.
+enum {FILE_MAGIC, FILE_VERSION, FILE_SOURCE, FILE_FRAMES, FILE_LAYERS, FILE_FIELD_COUNT};
+static const char *const fileKeys[] = {"magic", "version", "source", "frames", "layers"};
+enum {FRAME_X, FRAME_Y, FRAME_DURATION, FRAME_CAN_CANCEL, FRAME_ATLAS, FRAME_FIELD_COUNT};
+static const char *const frameKeys[] = {"x", "y", "duration", "canCancel", "atlas"};
+enum {ATLAS_X, ATLAS_Y, ATLAS_WIDTH, ATLAS_HEIGHT, ATLAS_FIELD_COUNT};
+static const char *const atlasKeys[] = {"x", "y", "width", "height"};
+enum {LAYER_X, LAYER_Y, LAYER_FRAMES_ACTIVE, LAYER_TYPE, LAYER_NAME, LAYER_HITBOX_JSON, LAYER_HURTBOX_SHAPE, LAYER_SHAPE_JSON, LAYER_BEZIER_POINTS, LAYER_KEYS, LAYER_PARENT, LAYER_TEMPLATE, LAYER_OVERRIDES, LAYER_FIELD_COUNT};
+static const char *const layerKeys[] = {"x", "y", "framesActive", "type", "name", "hitbox", "hurtboxShape", "shape", "bezierPoints", "keys", "parent", "template", "overrides"};
+enum {HITBOX_KNOCKBACK_X, HITBOX_KNOCKBACK_Y, HITBOX_STUN, HITBOX_DAMAGE, HITBOX_SHAPE, HITBOX_FIELD_COUNT};
+static const char *const hitboxKeys[] = {"knockbackX", "knockbackY", "stun", "damage", "shape"};
+enum {SHAPE_LAYER_SHAPE, SHAPE_LAYER_FLAGS, SHAPE_LAYER_FIELD_COUNT};
+static const char *const shapeLayerKeys[] = {"shape", "flags"};
+enum {BEZIER_X, BEZIER_Y, BEZIER_EXTENTS_LEFT, BEZIER_EXTENTS_RIGHT, BEZIER_ROTATION, BEZIER_FIELD_COUNT};
+static const char *const bezierKeys[] = {"x", "y", "extentsLeft", "extentsRight", "rotation"};
+enum {LAYER_KEY_FRAME, LAYER_KEY_X, LAYER_KEY_Y, LAYER_KEY_SHAPE, LAYER_KEY_FIELD_COUNT};
+static const char *const layerKeyKeys[] = {"frame", "x", "y", "shape"};
+
+static JsonSchema fileSchema;
+static JsonSchema frameSchema;
+static JsonSchema atlasSchema;
+static JsonSchema layerSchema;
+static JsonSchema hitboxSchema;
+static JsonSchema shapeLayerSchema;
+static JsonSchema bezierSchema;
+static JsonSchema layerKeySchema;
+static pthread_once_t schemasOnce = PTHREAD_ONCE_INIT;
+
+static void SchemasInit(void) {
+    JsonSchemaInit(&fileSchema, fileKeys, FILE_FIELD_COUNT);
+    JsonSchemaInit(&frameSchema, frameKeys, FRAME_FIELD_COUNT);
+    JsonSchemaInit(&atlasSchema, atlasKeys, ATLAS_FIELD_COUNT);
+    JsonSchemaInit(&layerSchema, layerKeys, LAYER_FIELD_COUNT);
+    JsonSchemaInit(&hitboxSchema, hitboxKeys, HITBOX_FIELD_COUNT);
+    JsonSchemaInit(&shapeLayerSchema, shapeLayerKeys, SHAPE_LAYER_FIELD_COUNT);
+    JsonSchemaInit(&bezierSchema, bezierKeys, BEZIER_FIELD_COUNT);
+    JsonSchemaInit(&layerKeySchema, layerKeyKeys, LAYER_KEY_FIELD_COUNT);
+}
+
+// A missing value falls back to the template's, if there is one.
+static bool NumberOrTemplate(cJSON *json, LayerTemplate *layerTemplate, int templateValue, int *out) {
+    if (!json && layerTemplate) {
+        *out = templateValue;
+        return true;
+    }
+    if (!cJSON_IsNumber(json)) return false;
+    *out = (int) cJSON_GetNumberValue(json);
+    return true;
+}
+
+// Converts one layer. Only touches the layer and its JSON so layers can be converted on separate threads.
+// On failure nothing is left allocated and errorLine is the source line of the failed check, reported by the caller.
+// When the check that failed was in ShapeDeserialize, shapeErrorLine is its line there.
+// The parent is left at -1 and its name, or NULL, is put in parentName for the caller to find once every layer exists.
+// Hitbox and shape values missing from a linked layer come from its template in templates, which is only read.
+static bool LayerDeserialize(cJSON *layerJson, Layer *layer, const char **parentName, TemplateTable *templates, int frameCount, int version, int *errorLine, int *shapeErrorLine) {
+#define FAIL_RETURN do {*errorLine = __LINE__; return false;} while (0)
+#define ERROR_GOTO(label) do {*errorLine = __LINE__; goto label;} while (0)
+    if (!cJSON_IsObject(layerJson)) FAIL_RETURN;
+
+    cJSON *layerFields[LAYER_FIELD_COUNT];
+    JsonSchemaRead(&layerSchema, layerJson, layerFields);
+    
+    cJSON *x = layerFields[LAYER_X];
+    if (!cJSON_IsNumber(x)) FAIL_RETURN;
+    cJSON *y = layerFields[LAYER_Y];
+    if (!cJSON_IsNumber(y)) FAIL_RETURN;
+    Vector2 position = {
+        (float) cJSON_GetNumberValue(x),
+        (float) cJSON_GetNumberValue(y)
+    };
+    layer->transform = Transform2DFromPosition(position);
+    layer->parent = -1;
+    *parentName = NULL;
+    if (version >= 11) {
+        cJSON *parent = layerFields[LAYER_PARENT];
+        if (cJSON_IsString(parent)) *parentName = cJSON_GetStringValue(parent);
+        else if (!cJSON_IsNull(parent)) FAIL_RETURN;
+    }
+    layer->templateName = NULL;
+    layer->templateOverrides = 0;
+    LayerTemplate *layerTemplate = NULL;
+    bool overridesStored = false;
+    if (version >= 12) {
+        cJSON *templateJson = layerFields[LAYER_TEMPLATE];
+        if (cJSON_IsString(templateJson)) {
+            layer->templateName = cJSON_GetStringValue(templateJson); // Interned when the layer is added.
+            layerTemplate = TemplateTableFind(templates, layer->templateName);
+        } else if (templateJson && !cJSON_IsNull(templateJson)) {
+            FAIL_RETURN;
+        }
+        // Files saved before the overrides were stored override the values they have, see the layer types below.
+        cJSON *overrides = layerFields[LAYER_OVERRIDES];
+        if (cJSON_IsNumber(overrides)) layer->templateOverrides = (unsigned int) cJSON_GetNumberValue(overrides);
+        else if (overrides) FAIL_RETURN;
+        overridesStored = overrides != NULL;
+    }
+     
+    layer->framesActive = LIST_NEW_SIZED(bool, frameCount);
+    cJSON *framesActive = layerFields[LAYER_FRAMES_ACTIVE];
+    if (!cJSON_IsArray(framesActive)) ERROR_GOTO(delete_frames_active);
+    
+    int frameIdx = 0;
+    cJSON *frameActive;
+    cJSON_ArrayForEach(frameActive, framesActive) {
+        if (frameIdx >= LIST_COUNT(layer->framesActive) || !cJSON_IsBool(frameActive)) ERROR_GOTO(delete_frames_active);
+        layer->framesActive[frameIdx] = cJSON_IsTrue(frameActive);
+        frameIdx++;
+    }
+    
+    cJSON *type = layerFields[LAYER_TYPE];
+    if (!cJSON_IsString(type)) ERROR_GOTO(delete_frames_active);
+    const char *typeString = cJSON_GetStringValue(type);
+ 
+    cJSON *nameJson = layerFields[LAYER_NAME];
+    if (!cJSON_IsString(nameJson)) ERROR_GOTO(delete_frames_active);
+    layer->name = cJSON_GetStringValue(nameJson); // Interned when the layer is added.
+
+    if (!strcmp(typeString, "HITBOX")) {
+        cJSON *hitbox = layerFields[LAYER_HITBOX_JSON];
+        if (!cJSON_IsObject(hitbox)) ERROR_GOTO(delete_frames_active);
+        
+        cJSON *hitboxFields[HITBOX_FIELD_COUNT];
+        JsonSchemaRead(&hitboxSchema, hitbox, hitboxFields);
+        cJSON *knockbackX = hitboxFields[HITBOX_KNOCKBACK_X];
+        cJSON *knockbackY = hitboxFields[HITBOX_KNOCKBACK_Y];
+        cJSON *stun = hitboxFields[HITBOX_STUN];
+        cJSON *damage = hitboxFields[HITBOX_DAMAGE];
+        cJSON *shape = hitboxFields[HITBOX_SHAPE];
+
+        if (!NumberOrTemplate(knockbackX, layerTemplate, layerTemplate ? layerTemplate->knockbackX : 0, &layer->hitbox.knockbackX)) ERROR_GOTO(delete_frames_active);
+        if (!NumberOrTemplate(knockbackY, layerTemplate, layerTemplate ? layerTemplate->knockbackY : 0, &layer->hitbox.knockbackY)) ERROR_GOTO(delete_frames_active);
+        if (!NumberOrTemplate(stun, layerTemplate, layerTemplate ? layerTemplate->stun : 0, &layer->hitbox.stun))                     ERROR_GOTO(delete_frames_active);
+        if (!NumberOrTemplate(damage, layerTemplate, layerTemplate ? layerTemplate->damage : 0, &layer->hitbox.damage))               ERROR_GOTO(delete_frames_active);
+        if (!shape && layerTemplate) layer->hitbox.shape = layerTemplate->shape;
+        else if (!ShapeDeserialize(shape, &layer->hitbox.shape, version, shapeErrorLine)) ERROR_GOTO(delete_frames_active);
+        if (layer->templateName && !overridesStored) {
+            layer->templateOverrides = (knockbackX || knockbackY ? TEMPLATE_FIELD_KNOCKBACK : 0) | (damage ? TEMPLATE_FIELD_DAMAGE : 0)
+                | (stun ? TEMPLATE_FIELD_STUN : 0) | (shape ? TEMPLATE_FIELD_SHAPE : 0);
+        }
+
+        layer->type = LAYER_HITBOX;
+    
+    } else if (!strcmp(typeString, "HURTBOX") && version <= 7) {
+        layer->type = LAYER_SHAPE;
+        cJSON *shape = layerFields[LAYER_HURTBOX_SHAPE];
+        if (!shape || !ShapeDeserialize(shape, &layer->shape.shape, version, shapeErrorLine)) ERROR_GOTO(delete_frames_active);
+        layer->shape.flags = 1;
+    
+    } else if (!strcmp(typeString, "SHAPE") && version >= 8) {
+        layer->type = LAYER_SHAPE;
+        cJSON *shapeLayer = layerFields[LAYER_SHAPE_JSON];
+        if (!cJSON_IsObject(shapeLayer)) ERROR_GOTO(delete_frames_active);
+        cJSON *shapeLayerFields[SHAPE_LAYER_FIELD_COUNT];
+        JsonSchemaRead(&shapeLayerSchema, shapeLayer, shapeLayerFields);
+        cJSON *shape = shapeLayerFields[SHAPE_LAYER_SHAPE];
+        if (!shape && layerTemplate) layer->shape.shape = layerTemplate->shape;
+        else if (!shape || !ShapeDeserialize(shape, &layer->shape.shape, version, shapeErrorLine)) ERROR_GOTO(delete_frames_active);
+        cJSON *flags = shapeLayerFields[SHAPE_LAYER_FLAGS];
+        if (!flags && layerTemplate) layer->shape.flags = layerTemplate->flags;
+        else if (!cJSON_IsNumber(flags)) ERROR_GOTO(delete_frames_active);
+        else layer->shape.flags = cJSON_GetNumberValue(flags);
+        if (layer->templateName && !overridesStored) layer->templateOverrides = (shape ? TEMPLATE_FIELD_SHAPE : 0) | (flags ? TEMPLATE_FIELD_FLAGS : 0);
+    
+    } else if (!strcmp(typeString, "EMPTY")) {
+        layer->type = LAYER_EMPTY;
+    
+    } else if (!strcmp(typeString, "BEZIER")) {
+        layer->type = LAYER_BEZIER;
+        
+        cJSON *bezierPointsJson = layerFields[LAYER_BEZIER_POINTS];
+        if (!cJSON_IsArray(bezierPointsJson)) ERROR_GOTO(delete_frames_active);
+        int bezierPointCount = cJSON_GetArraySize(bezierPointsJson);
+        if (bezierPointCount != LIST_COUNT(layer->framesActive)) ERROR_GOTO(delete_frames_active);
+        layer->bezierPoints = LIST_NEW_SIZED(BezierPoint, bezierPointCount);
+        
+        int frameIdx = 0;
+        cJSON *bezierPointJson;
+        cJSON_ArrayForEach(bezierPointJson, bezierPointsJson) {
+            if (cJSON_IsNull(bezierPointJson)) {
+                layer->bezierPoints[frameIdx] = (BezierPoint) {0};
+                frameIdx++;
+                continue;
+            }
+            if (!cJSON_IsObject(bezierPointJson)) ERROR_GOTO(delete_bezier_points);
+           
+            cJSON *bezierFields[BEZIER_FIELD_COUNT];
+            JsonSchemaRead(&bezierSchema, bezierPointJson, bezierFields);
+            cJSON *positionX = bezierFields[BEZIER_X];
+            if (!cJSON_IsNumber(positionX)) ERROR_GOTO(delete_bezier_points);
+            cJSON *positionY = bezierFields[BEZIER_Y];
+            if (!cJSON_IsNumber(positionY)) ERROR_GOTO(delete_bezier_points);
+            cJSON *extentsLeft = bezierFields[BEZIER_EXTENTS_LEFT];
+            if (!cJSON_IsNumber(extentsLeft)) ERROR_GOTO(delete_bezier_points);
+            cJSON *extentsRight = bezierFields[BEZIER_EXTENTS_RIGHT];
+            if (!cJSON_IsNumber(extentsRight)) ERROR_GOTO(delete_bezier_points);
+            cJSON *rotation = bezierFields[BEZIER_ROTATION];
+            if (!cJSON_IsNumber(rotation)) ERROR_GOTO(delete_bezier_points);
+
+            layer->bezierPoints[frameIdx] = (BezierPoint) {
+                .position = (Vector2) {cJSON_GetNumberValue(positionX), cJSON_GetNumberValue(positionY)},
+                .extentsLeft = cJSON_GetNumberValue(extentsLeft),
+                .extentsRight = cJSON_GetNumberValue(extentsRight),
+                .rotation = cJSON_GetNumberValue(rotation)
+            };
+            frameIdx++;
+            
+            while (false) {
+delete_bezier_points:
+                LIST_FREE(layer->bezierPoints);
+                goto delete_frames_active;
+            }
+        }
+    } else ERROR_GOTO(delete_frames_active);
+
+    layer->keys = LIST_NEW(LayerKey);
+    layer->samples = LIST_NEW(LayerSample);
+    if (version >= 10) {
+        cJSON *keysJson = layerFields[LAYER_KEYS];
+        if (!cJSON_IsArray(keysJson)) ERROR_GOTO(delete_keys);
+        Shape *shapeBase = LayerShapeBase(layer);
+        cJSON *keyJson;
+        cJSON_ArrayForEach(keyJson, keysJson) {
+            if (!cJSON_IsObject(keyJson)) ERROR_GOTO(delete_keys);
+            cJSON *keyFields[LAYER_KEY_FIELD_COUNT];
+            JsonSchemaRead(&layerKeySchema, keyJson, keyFields);
+            cJSON *frame = keyFields[LAYER_KEY_FRAME];
+            if (!cJSON_IsNumber(frame)) ERROR_GOTO(delete_keys);
+            cJSON *keyX = keyFields[LAYER_KEY_X];
+            if (!cJSON_IsNumber(keyX)) ERROR_GOTO(delete_keys);
+            cJSON *keyY = keyFields[LAYER_KEY_Y];
+            if (!cJSON_IsNumber(keyY)) ERROR_GOTO(delete_keys);
+
+            LayerKey key = {
+                .frame = (int) cJSON_GetNumberValue(frame),
+                .value.position = (Vector2) {(float) cJSON_GetNumberValue(keyX), (float) cJSON_GetNumberValue(keyY)}
+            };
+            // Keys are sorted with at most one per frame.
+            int keyCount = LIST_COUNT(layer->keys);
+            if (key.frame < 0 || key.frame >= frameCount) ERROR_GOTO(delete_keys);
+            if (keyCount > 0 && key.frame <= layer->keys[keyCount - 1].frame) ERROR_GOTO(delete_keys);
+            if (shapeBase) {
+                if (!ShapeDeserialize(keyFields[LAYER_KEY_SHAPE], &key.value.shape, version, shapeErrorLine)) ERROR_GOTO(delete_keys);
+                if (key.value.shape.type != shapeBase->type) ERROR_GOTO(delete_keys);
+            }
+            LIST_ADD(&layer->keys, key);
+        }
+        LayerKeysBake(layer);
+    }
+    // Values a file has for fields the layer doesn't override, as when its template was missing, follow the template.
+    layer->templateOverrides &= TemplateFields(layer->type);
+    if (layerTemplate) TemplateApply(layerTemplate, layer, ~TemplateOverrides(layerTemplate, layer));
+    return true;
+
+delete_keys:
+    LIST_FREE(layer->keys);
+    LIST_FREE(layer->samples);
+    if (layer->type == LAYER_BEZIER) LIST_FREE(layer->bezierPoints);
+delete_frames_active:
+    LIST_FREE(layer->framesActive);
+    return false;
+#undef ERROR_GOTO
+#undef FAIL_RETURN
+}
+
+typedef struct LayerDeserializeJob {
+    cJSON *json;
+    Layer *layers; // The job's range of the output layers.
+    const char **parentNames; // The job's range of the parent names.
+    TemplateTable *templates;
+    int layerCount;
+    int frameCount;
+    int version;
+    int failedIdx; // Index into layers of the first layer that failed or -1. Later layers in the range are skipped.
+    int errorLine;
+    int shapeErrorLine; // 0 unless the failed check was in ShapeDeserialize.
+} LayerDeserializeJob;
+
+static void LayerDeserializeJobRun(void *data) {
+    LayerDeserializeJob *job = data;
+    cJSON *layerJson = job->json;
+    for (int i = 0; i < job->layerCount; i++, layerJson = layerJson->next) {
+        if (!LayerDeserialize(layerJson, job->layers + i, job->parentNames + i, job->templates, job->frameCount, job->version, &job->errorLine, &job->shapeErrorLine)) {
+            job->failedIdx = i;
+            return;
+        }
+    }
+}
+
 bool EditorStateDeserialize(EditorState *out, const char *path) {
     struct stat st;
     if (stat(path, &st) < 0) {
@@ -291,9 +971,13 @@ bool EditorStateDeserialize(EditorState *out, const char *path) {
     }
 
 #define ERROR_GOTO(label) do {printf("Failed to parse file %s. Error: %s at line %i.\n", path, __FILE__, __LINE__); goto label;} while (0)
-    cJSON *magic = cJSON_GetObjectItem(json, "magic");
+    pthread_once(&schemasOnce, SchemasInit);
+    cJSON *fileFields[FILE_FIELD_COUNT];
+    JsonSchemaRead(&fileSchema, json, fileFields);
+
+    cJSON *magic = fileFields[FILE_MAGIC];
     if (!cJSON_IsString(magic)) ERROR_GOTO(delete_json);
-    cJSON *versionJson = cJSON_GetObjectItem(json, "version");
+    cJSON *versionJson = fileFields[FILE_VERSION];
     int version;
     if (!versionJson) {
         version = 0;
@@ -311,167 +995,171 @@ bool EditorStateDeserialize(EditorState *out, const char *path) {
         ERROR_GOTO(delete_json);
     }
 
-    cJSON *frames = cJSON_GetObjectItem(json, "frames");
+    SpriteSourceType sourceType = SPRITE_SOURCE_STRIP;
+    if (version >= 9) {
+        cJSON *source = fileFields[FILE_SOURCE];
+        if (!cJSON_IsString(source)) ERROR_GOTO(delete_json);
+        const char *sourceString = cJSON_GetStringValue(source);
+        if (!strcmp(sourceString, "STRIP")) sourceType = SPRITE_SOURCE_STRIP;
+        else if (!strcmp(sourceString, "SEQUENCE")) sourceType = SPRITE_SOURCE_SEQUENCE;
+        else if (!strcmp(sourceString, "ATLAS")) sourceType = SPRITE_SOURCE_ATLAS;
+        else ERROR_GOTO(delete_json);
+    }
+
+    cJSON *frames = fileFields[FILE_FRAMES];
     if (!cJSON_IsArray(frames)) ERROR_GOTO(delete_json);
     *out = EditorStateNew(cJSON_GetArraySize(frames));
+    out->sourceType = sourceType;
+    // Loaded before the layers since linked layers take the values they don't store from it.
+    TemplateTableRelease(out->templates);
+    out->templates = TemplateTableLoad(path);
 
     cJSON *frameJson;
     int frameIdx = 0;
     cJSON_ArrayForEach(frameJson, frames) {
-        cJSON *x = cJSON_GetObjectItem(frameJson, "x");
+        cJSON *frameFields[FRAME_FIELD_COUNT];
+        JsonSchemaRead(&frameSchema, frameJson, frameFields);
+
+        cJSON *x = frameFields[FRAME_X];
         if (!cJSON_IsNumber(x)) ERROR_GOTO(delete_editor_state);
-        cJSON *y = cJSON_GetObjectItem(frameJson, "y");
+        cJSON *y = frameFields[FRAME_Y];
         if (!cJSON_IsNumber(y)) ERROR_GOTO(delete_editor_state);
-        cJSON *duration = cJSON_GetObjectItem(frameJson, "duration");
+        cJSON *duration = frameFields[FRAME_DURATION];
         if (!cJSON_IsNumber(duration)) ERROR_GOTO(delete_editor_state);
-        cJSON *canCancel = cJSON_GetObjectItem(frameJson, "canCancel");
+        cJSON *canCancel = frameFields[FRAME_CAN_CANCEL];
         if (!cJSON_IsBool(canCancel)) ERROR_GOTO(delete_editor_state);
+        
+        Rectangle atlasRect = {0.0f, 0.0f, 0.0f, 0.0f};
+        if (sourceType == SPRITE_SOURCE_ATLAS) {
+            cJSON *atlas = frameFields[FRAME_ATLAS];
+            if (!cJSON_IsObject(atlas)) ERROR_GOTO(delete_editor_state);
+            cJSON *atlasFields[ATLAS_FIELD_COUNT];
+            JsonSchemaRead(&atlasSchema, atlas, atlasFields);
+            cJSON *atlasX = atlasFields[ATLAS_X];
+            if (!cJSON_IsNumber(atlasX)) ERROR_GOTO(delete_editor_state);
+            cJSON *atlasY = atlasFields[ATLAS_Y];
+            if (!cJSON_IsNumber(atlasY)) ERROR_GOTO(delete_editor_state);
+            cJSON *atlasWidth = atlasFields[ATLAS_WIDTH];
+            if (!cJSON_IsNumber(atlasWidth)) ERROR_GOTO(delete_editor_state);
+            cJSON *atlasHeight = atlasFields[ATLAS_HEIGHT];
+            if (!cJSON_IsNumber(atlasHeight)) ERROR_GOTO(delete_editor_state);
+            atlasRect = (Rectangle) {
+                .x = (float) cJSON_GetNumberValue(atlasX),
+                .y = (float) cJSON_GetNumberValue(atlasY),
+                .width = (float) cJSON_GetNumberValue(atlasWidth),
+                .height = (float) cJSON_GetNumberValue(atlasHeight)
+            };
+        }
+
         out->frames[frameIdx] = (FrameInfo) {
             .pos = (Vector2) {
                     .x = (float) cJSON_GetNumberValue(x),
                     .y = (float)  cJSON_GetNumberValue(y)
             },
             .duration = (int) cJSON_GetNumberValue(duration),
-            .canCancel = cJSON_IsTrue(canCancel)
+            .canCancel = cJSON_IsTrue(canCancel),
+            .atlasRect = atlasRect
         };
         frameIdx++;
     }
 
-    cJSON *layers = cJSON_GetObjectItem(json, "layers");
+    cJSON *layers = fileFields[FILE_LAYERS];
     if (!cJSON_IsArray(layers)) ERROR_GOTO(delete_editor_state);
-    cJSON *layerJson;
-    cJSON_ArrayForEach(layerJson, layers) {
-        if (!cJSON_IsObject(layerJson)) ERROR_GOTO(delete_editor_state);
-        
-        Layer layer;
-        
-        cJSON *x = cJSON_GetObjectItem(layerJson, "x");
-        if (!cJSON_IsNumber(x)) ERROR_GOTO(delete_editor_state);
-        cJSON *y = cJSON_GetObjectItem(layerJson, "y");
-        if (!cJSON_IsNumber(y)) ERROR_GOTO(delete_editor_state);
-        Vector2 position = {
-            (float) cJSON_GetNumberValue(x),
-            (float) cJSON_GetNumberValue(y)
+    int layerCount = cJSON_GetArraySize(layers);
+    Layer *loaded = malloc(sizeof(Layer) * (layerCount > 0 ? layerCount : 1));
+    const char **parentNames = malloc(sizeof(char *) * (layerCount > 0 ? layerCount : 1));
+    
+    // Layers are independent so big files convert them in contiguous ranges on a pool.
+    // Small files aren't worth starting threads for and run the same jobs inline.
+    int threadCount = 1;
+    if ((long) layerCount * out->frameCount >= DESERIALIZE_PARALLEL_MIN_CELLS) threadCount = WORKER_POOL_THREADS_DEFAULT;
+    int jobCount = threadCount == 1 ? 1 : threadCount * DESERIALIZE_JOBS_PER_THREAD;
+    if (jobCount > layerCount) jobCount = layerCount > 0 ? layerCount : 1;
+    LayerDeserializeJob *jobs = malloc(sizeof(LayerDeserializeJob) * jobCount);
+    
+    cJSON *layerJson = layers->child;
+    int layerStart = 0;
+    for (int i = 0; i < jobCount; i++) {
+        int layerEnd = (int) ((long) layerCount * (i + 1) / jobCount);
+        jobs[i] = (LayerDeserializeJob) {
+            .json = layerJson,
+            .layers = loaded + layerStart,
+            .parentNames = parentNames + layerStart,
+            .templates = out->templates,
+            .layerCount = layerEnd - layerStart,
+            .frameCount = out->frameCount,
+            .version = version,
+            .failedIdx = -1,
+            .errorLine = 0,
+            .shapeErrorLine = 0
         };
-        layer.transform = Transform2DFromPosition(position);
-         
-        layer.framesActive = LIST_NEW_SIZED(bool, out->frameCount);
-        cJSON *framesActive = cJSON_GetObjectItem(layerJson, "framesActive");
-        if (!cJSON_IsArray(framesActive)) ERROR_GOTO(delete_frames_active);
-        
-        int frameIdx = 0;
-        cJSON *frameActive;
-        cJSON_ArrayForEach(frameActive, framesActive) {
-            if (frameIdx >= LIST_COUNT(layer.framesActive) || !cJSON_IsBool(frameActive)) ERROR_GOTO(delete_frames_active);
-            layer.framesActive[frameIdx] = cJSON_IsTrue(frameActive);
-            frameIdx++;
+        for (int j = layerStart; j < layerEnd; j++) layerJson = layerJson->next;
+        layerStart = layerEnd;
+    }
+    
+    if (threadCount == 1) {
+        LayerDeserializeJobRun(jobs);
+    } else {
+        WorkerPool *pool = WorkerPoolNew(threadCount);
+        for (int i = 0; i < jobCount; i++) WorkerPoolPush(pool, LayerDeserializeJobRun, jobs + i);
+        WorkerPoolWait(pool);
+        WorkerPoolFree(pool);
+    }
+    
+    // Joined in file order. The first failed layer in the file is the one reported no matter which job finished first.
+    int failedJob = -1;
+    for (int i = 0; i < jobCount; i++) {
+        if (jobs[i].failedIdx >= 0) {
+            failedJob = i;
+            break;
         }
-        
-        cJSON *type = cJSON_GetObjectItem(layerJson, "type");
-        if (!cJSON_IsString(type)) ERROR_GOTO(delete_frames_active);
-        const char *typeString = cJSON_GetStringValue(type);
-     
-        cJSON *nameJson = cJSON_GetObjectItem(layerJson, "name");
-        if (!cJSON_IsString(nameJson)) ERROR_GOTO(delete_frames_active);
-        char *name = cJSON_GetStringValue(nameJson);
-        
-        layer.nameBufferLength = strlen(name) + 1;
-        if (layer.nameBufferLength < LAYER_NAME_BUFFER_INITIAL_SIZE) layer.nameBufferLength = LAYER_NAME_BUFFER_INITIAL_SIZE;
-        layer.name = malloc(layer.nameBufferLength);
-        strcpy(layer.name, name);
-
-        if (!strcmp(typeString, "HITBOX")) {
-            cJSON *hitbox = cJSON_GetObjectItem(layerJson, "hitbox");
-            if (!cJSON_IsObject(hitbox)) ERROR_GOTO(delete_name);
-            
-            cJSON *knockbackX = cJSON_GetObjectItem(hitbox, "knockbackX");
-            cJSON *knockbackY = cJSON_GetObjectItem(hitbox, "knockbackY");
-            cJSON *stun = cJSON_GetObjectItem(hitbox, "stun");
-            cJSON *damage = cJSON_GetObjectItem(hitbox, "damage");
-            cJSON *shape = cJSON_GetObjectItem(hitbox, "shape");
-
-            if (!cJSON_IsNumber(knockbackX))    ERROR_GOTO(delete_name);
-            if (!cJSON_IsNumber(knockbackY))    ERROR_GOTO(delete_name);
-            if (!cJSON_IsNumber(stun))          ERROR_GOTO(delete_name);
-            if (!cJSON_IsNumber(damage))        ERROR_GOTO(delete_name);
-            if (!ShapeDeserialize(shape, &layer.hitbox.shape, version)) ERROR_GOTO(delete_name);
-
-            layer.type = LAYER_HITBOX;
-            layer.hitbox.knockbackX = (int) cJSON_GetNumberValue(knockbackX);
-            layer.hitbox.knockbackY = (int) cJSON_GetNumberValue(knockbackY);
-            layer.hitbox.stun = (int) cJSON_GetNumberValue(stun);
-            layer.hitbox.damage = (int) cJSON_GetNumberValue(damage);
-        
-        } else if (!strcmp(typeString, "HURTBOX") && version <= 7) {
-            layer.type = LAYER_SHAPE;
-            cJSON *shape = cJSON_GetObjectItem(layerJson, "hurtboxShape");
-            if (!shape || !ShapeDeserialize(shape, &layer.shape.shape, version)) ERROR_GOTO(delete_name);
-            layer.shape.flags = 1;
-        
-        } else if (!strcmp(typeString, "SHAPE") && version >= 8) {
-            layer.type = LAYER_SHAPE;
-            cJSON *shapeLayer = cJSON_GetObjectItem(layerJson, "shape");
-            if (!cJSON_IsObject(shapeLayer)) ERROR_GOTO(delete_name);
-            cJSON *shape = cJSON_GetObjectItem(shapeLayer, "shape");
-            if (!shape || !ShapeDeserialize(shape, &layer.shape.shape, version)) ERROR_GOTO(delete_name);
-            cJSON *flags = cJSON_GetObjectItem(shapeLayer, "flags");
-            if (!cJSON_IsNumber(flags)) ERROR_GOTO(delete_name);
-            layer.shape.flags = cJSON_GetNumberValue(flags);
-        
-        } else if (!strcmp(typeString, "EMPTY")) {
-            layer.type = LAYER_EMPTY;
-        
-        } else if (!strcmp(typeString, "BEZIER")) {
-            layer.type = LAYER_BEZIER;
-            
-            cJSON *bezierPointsJson = cJSON_GetObjectItem(layerJson, "bezierPoints");
-            if (!cJSON_IsArray(bezierPointsJson)) ERROR_GOTO(delete_name);
-            int bezierPointCount = cJSON_GetArraySize(bezierPointsJson);
-            if (bezierPointCount != LIST_COUNT(layer.framesActive)) ERROR_GOTO(delete_bezier_points);
-            layer.bezierPoints = LIST_NEW_SIZED(BezierPoint, bezierPointCount);
-            
-            int frameIdx = 0;
-            cJSON *bezierPointJson;
-            cJSON_ArrayForEach(bezierPointJson, bezierPointsJson) {
-                if (cJSON_IsNull(bezierPointJson)) continue; 
-                if (!cJSON_IsObject(bezierPointJson)) ERROR_GOTO(delete_bezier_points);
-               
-                cJSON *positionX = cJSON_GetObjectItem(bezierPointJson,"x");
-                if (!cJSON_IsNumber(positionX)) ERROR_GOTO(delete_bezier_points);
-                cJSON *positionY = cJSON_GetObjectItem(bezierPointJson, "y");
-                if (!cJSON_IsNumber(positionY)) ERROR_GOTO(delete_bezier_points);
-                cJSON *extentsLeft = cJSON_GetObjectItem(bezierPointJson, "extentsLeft");
-                if (!cJSON_IsNumber(extentsLeft)) ERROR_GOTO(delete_bezier_points);
-                cJSON *extentsRight = cJSON_GetObjectItem(bezierPointJson, "extentsRight");
-                if (!cJSON_IsNumber(extentsRight)) ERROR_GOTO(delete_bezier_points);
-                cJSON *rotation = cJSON_GetObjectItem(bezierPointJson, "rotation");
-                if (!cJSON_IsNumber(rotation)) ERROR_GOTO(delete_bezier_points);
-
-                layer.bezierPoints[frameIdx] = (BezierPoint) {
-                    .position = (Vector2) {cJSON_GetNumberValue(positionX), cJSON_GetNumberValue(positionY)},
-                    .extentsLeft = cJSON_GetNumberValue(extentsLeft),
-                    .extentsRight = cJSON_GetNumberValue(extentsRight),
-                    .rotation = cJSON_GetNumberValue(rotation)
-                };
-                frameIdx++;
-                
-                while (false) {
-delete_bezier_points:
-                    LIST_FREE(layer.bezierPoints);
-                    goto delete_name;
-                }
-            }
-        } else ERROR_GOTO(delete_name);
+    }
+    if (failedJob >= 0) {
+        LayerDeserializeJob *job = jobs + failedJob;
+        printf("Failed to parse file %s. Error: %s at line %i in layer %i.\n",
+            path, __FILE__, job->errorLine, (int) (job->layers - loaded) + job->failedIdx);
+        if (job->shapeErrorLine) printf("The shape failed in ShapeDeserialize at line %i.\n", job->shapeErrorLine);
+        // Linked layers can leave values out, which only fails when their template is gone.
+        cJSON *failedJson = job->json;
+        for (int i = 0; i < job->failedIdx; i++) failedJson = failedJson->next;
+        const char *templateName = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(failedJson, "template"));
+        if (templateName && !TemplateTableFind(out->templates, templateName)) {
+            printf("It uses the template \"%s\", which isn't in %s.\n", templateName, out->templates->path);
+        }
+        for (int i = 0; i < jobCount; i++) {
+            int convertedCount = jobs[i].failedIdx >= 0 ? jobs[i].failedIdx : jobs[i].layerCount;
+            for (int j = 0; j < convertedCount; j++) LayerFree(jobs[i].layers + j);
+        }
+        free(jobs);
+        free(loaded);
+        free(parentNames);
+        goto delete_editor_state;
+    }
+    free(jobs);
     
-        EditorStateLayerAdd(out, layer);
-        continue;
+    // Names are interned on this thread since the string table isn't shared between threads. Every slot is reserved
+    // and the index sized up front, so each add is only the uniqueness check and one insert.
+    EditorStateLayersReserve(out, layerCount);
+    for (int i = 0; i < layerCount; i++) {
+        const char *name = loaded[i].name;
+        EditorStateLayerAdd(out, loaded[i]);
+        if (strcmp(out->layers[out->layerCount - 1].name, name)) {
+            printf("Layer name \"%s\" was used more than once. Renamed to \"%s\".\n", name, out->layers[out->layerCount - 1].name);
+        }
+    }
+    free(loaded);
 
-delete_name:
-        free(layer.name);
-delete_frames_active:
-        free(layer.framesActive);
-        goto delete_editor_state;
+    // Parents are found by name once every layer is there, since they can come after their children.
+    for (int i = 0; i < layerCount; i++) {
+        if (!parentNames[i]) continue;
+        int parent = EditorStateLayerFind(out, parentNames[i]);
+        if (parent < 0 || !EditorStateLayerParentSet(out, i, parent)) {
+            printf("Layer \"%s\" has the parent \"%s\", which doesn't exist or is one of its children.\n", out->layers[i].name, parentNames[i]);
+            free(parentNames);
+            ERROR_GOTO(delete_editor_state);
+        }
     }
+    free(parentNames);
 
     cJSON_Delete(json);
     return true;
@@ -483,3 +1171,4 @@ delete_json:
     return false;
 #undef ERROR_GOTO
 }
+
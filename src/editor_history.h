@@ -5,6 +5,8 @@
 #include "cJSON.h"
 #include "layer.h"
 #include "list.h"
+#include "string_table.h"
+#include "template_table.h"
 
 #define HISTORY_BUFFER_SIZE_INCREMENT 1024
 #define FRAME_DURATION_UNIT_PER_SECOND 1000.0f
@@ -31,21 +33,45 @@
 // 8: Renamed the hurtbox layer to the shape layer.
 //      It can be used for different kinds shapes now (i.e. hurtboxes, windboxes, grab boxes, etc.)
 //      It has a flags field that can be set and then interpreted by whatever is playing the animation to get these effects.
+// 9: Added the "source" field that says where the frame images come from. Older files are always horizontal strips.
+//      Atlas sources store the rect of each frame in the packed image as "atlas" in the frame.
+// 10: Added "keys" to every layer: sparse keyframes of the position and, for hitbox and shape layers, the shape.
+//      Each key has a "frame", "x", "y" and "shape". An empty array means the layer is the same on every frame.
+// 11: Added "parent" to every layer: the name of the layer it moves along with, or null.
+//      The position and keys of a layer with a parent are relative to the parent's origin.
+// 12: Added "template" to hitbox and shape layers: the name of the template in the project's template table they
+//      follow, or null. Linked layers also have "overrides", the TemplateField bits of the values they keep, and
+//      leave the other hitbox and shape values out of the file. Without "overrides" the values present are the ones kept.
 
 // Oldest supported version of the file format
 #define FILE_VERSION_OLDEST 7
 // Most recent file version
-#define FILE_VERSION_CURRENT 8
+#define FILE_VERSION_CURRENT 12
+
+typedef enum SpriteSourceType {
+    SPRITE_SOURCE_STRIP, // <name>.png holding every frame side by side with equal widths.
+    SPRITE_SOURCE_SEQUENCE, // <name>/ directory holding one numbered png per frame.
+    SPRITE_SOURCE_ATLAS // <name>.png packed arbitrarily. Each frame stores its own rect.
+} SpriteSourceType;
 
 typedef struct FrameInfo {
     int duration;
     bool canCancel;
     Vector2 pos;
+    Rectangle atlasRect; // Only used by atlas sources.
 } FrameInfo;
 
 typedef struct EditorState {
+    SpriteSourceType sourceType;
     Layer *layers;
     int layerCount;
+    int layerCapacity; // Slots allocated in layers, which grows by doubling.
+    StringTable *strings; // Layer names. Shared with every copy of the state.
+    TemplateTable *templates; // The project's templates. Shared with every copy of the state as well.
+    // Name to layer lookup. Open addressed by the interned name pointer, holds layer indices or -1.
+    // Added layers are inserted, it is rebuilt when it passes half full and when layers are removed or renamed.
+    int *layerIndex;
+    int layerIndexCapacity;
     FrameInfo *frames;
     int frameCount;
     int layerIdx;
@@ -67,11 +93,50 @@ EditorState EditorStateNew(int frameCount);
 void EditorStateFree(EditorState *state);
 
 void EditorStateLayerAdd(EditorState *state, Layer layer);
+// Children of the removed layer move to its parent. Its transform is folded into their transforms and keys so they
+// stay where they were, on every frame unless the removed layer has keys, then on the current frame.
 bool EditorStateLayerRemove(EditorState *state, int idx);
-void EditorStateAddFrame(EditorState *state, int idx);
-bool EditorStateRemoveFrame(EditorState *state, int idx);
+// Fails if the name is empty or another layer already has it.
+bool EditorStateLayerRename(EditorState *state, int idx, const char *name);
+int EditorStateLayerFind(EditorState *state, const char *name); // -1 if there is no layer with that name.
+// Interns name, or name followed by the lowest number that no layer has, e.g. "Hitbox 2".
+const char *EditorStateLayerNameUnique(EditorState *state, const char *name);
+// Makes parent, or nothing with -1, the layer the one at idx moves along with. The position and keys aren't changed,
+// so they are now relative to the new parent's origin. Fails if the layer would become its own ancestor.
+bool EditorStateLayerParentSet(EditorState *state, int idx, int parent);
+bool EditorStateLayerIsAncestor(EditorState *state, int ancestor, int idx);
+// Fills order with every layer index so parents come before their children, which keeps layer order otherwise.
+// Evaluating world transforms in that order needs a single pass. Returns false if the parents form a cycle.
+bool EditorStateLayerOrder(EditorState *state, int *order);
+// Makes the values of the layer at idx the template named name, replacing the values of an existing one, and links
+// the layer to it without overrides. Other linked layers take the new values of the fields they didn't override.
+// Fails for layers without hitbox or shape values. The table isn't saved.
+bool EditorStateTemplateSave(EditorState *state, int idx, const char *name);
+// Links the layer at idx to the template and gives it every value of it, or unlinks it for NULL and keeps the values.
+// Either way the overrides are cleared. Fails if there is no such template or the layer can't be linked.
+bool EditorStateTemplateLink(EditorState *state, int idx, const char *name);
+// Gives every linked layer the current values of its template for the fields it doesn't override.
+void EditorStateTemplatesSync(EditorState *state);
+// Puts the templates the layers are linked to in used, in order of first use, and the index of each layer's template
+// in used, or -1, in layerTemplates. Both hold layerCount entries. Links to templates missing from the table count as
+// unlinked. Returns how many templates were used.
+int EditorStateTemplatesUsed(EditorState *state, LayerTemplate **used, int *layerTemplates);
+// Frame ranges. Each one moves the frames along with every layer's framesActive and bezierPoints.
+// Inserts count frames before idx, which can be frameCount to append. Layers start out disabled on them.
+void EditorStateFramesInsert(EditorState *state, int idx, int count);
+// Inserts a copy of the count frames at idx, layers included, right after them.
+void EditorStateFramesDuplicate(EditorState *state, int idx, int count);
+// Fails if the range is out of bounds or covers every frame.
+bool EditorStateFramesRemove(EditorState *state, int idx, int count);
 EditorState EditorStateDeepCopy(EditorState *state);
+size_t EditorStateMemorySize(EditorState *state); // Bytes of heap memory owned by the state.
+
+// Timing helpers. These match what a game computes from the frame durations.
+long long EditorStateDuration(EditorState *state);
+long long EditorStateFrameStart(EditorState *state, int frameIdx);
+int EditorStateFrameAtTime(EditorState *state, long long time); // Loops when time is past the end.
 
+cJSON *EditorStateToJson(EditorState *state);
 bool EditorStateSerialize(EditorState *state, const char *path);
 bool EditorStateDeserialize(EditorState *state, const char *path);
 
@@ -81,5 +146,6 @@ void EditorHistoryFree(EditorHistory *history);
 
 void EditorHistoryCommitState(EditorHistory *history, EditorState *state);
 void EditorHistoryChangeState(EditorHistory *history, EditorState *state, ChangeOptions option);
+size_t EditorHistoryMemorySize(EditorHistory *history); // Walks every stored state.
 
 #endif
@@ -0,0 +1,597 @@
+#include <assert.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "build_cache.h"
+#include "bytes.h"
+#include "cJSON.h"
+#include "codegen.h"
+#include "editor_history.h"
+#include "files.h"
+#include "layer.h"
+#include "list.h"
+#include "string_buffer.h"
+#include "template_table.h"
+#include "timer.h"
+#include "worker_pool.h"
+#include "export.h"
+
+bool ExportFormatParse(const char *string, ExportFormat *format) {
+    if (!strcmp(string, "json")) *format = EXPORT_FORMAT_JSON;
+    else if (!strcmp(string, "bin")) *format = EXPORT_FORMAT_BINARY;
+    else if (!strcmp(string, "header")) *format = EXPORT_FORMAT_HEADER;
+    else if (!strcmp(string, "tables")) *format = EXPORT_FORMAT_TABLES;
+    else if (!strcmp(string, "compact")) *format = EXPORT_FORMAT_COMPACT;
+    else return false;
+    return true;
+}
+
+const char *ExportFormatExtension(ExportFormat format) {
+    switch (format) {
+        case EXPORT_FORMAT_JSON: return ".json";
+        case EXPORT_FORMAT_BINARY: return ".cab";
+        case EXPORT_FORMAT_HEADER: return ".h";
+        case EXPORT_FORMAT_TABLES: return ".tables.h";
+        case EXPORT_FORMAT_COMPACT: return ".cabq";
+    }
+    assert(false);
+    return NULL;
+}
+
+static void WriteShape(LIST(unsigned char) *buffer, Shape shape) {
+    BytesWriteU8(buffer, (uint8_t) shape.type);
+    switch (shape.type) {
+        case SHAPE_CIRCLE:
+            BytesWriteI32(buffer, shape.circleRadius);
+            break;
+        case SHAPE_RECTANGLE:
+            BytesWriteI32(buffer, shape.rectangle.rightX);
+            BytesWriteI32(buffer, shape.rectangle.bottomY);
+            break;
+        case SHAPE_CAPSULE:
+            BytesWriteI32(buffer, shape.capsule.radius);
+            BytesWriteI32(buffer, shape.capsule.height);
+            BytesWriteF32(buffer, shape.capsule.rotation);
+            break;
+    }
+}
+
+LIST(unsigned char) ExportBinary(EditorState *state) {
+    LIST(unsigned char) buffer = LIST_NEW(unsigned char);
+    LIST_ADD_ARRAY(&buffer, EXPORT_BINARY_MAGIC, 4);
+    BytesWriteU32(&buffer, EXPORT_BINARY_VERSION);
+    BytesWriteU32(&buffer, (uint32_t) state->frameCount);
+    BytesWriteU32(&buffer, (uint32_t) state->layerCount);
+
+    for (int i = 0; i < state->frameCount; i++) {
+        FrameInfo frame = state->frames[i];
+        BytesWriteI32(&buffer, frame.duration);
+        BytesWriteU8(&buffer, frame.canCancel);
+        BytesWriteF32(&buffer, frame.pos.x);
+        BytesWriteF32(&buffer, frame.pos.y);
+    }
+
+    int layerSlots = state->layerCount > 0 ? state->layerCount : 1;
+    LayerTemplate **templates = malloc(sizeof(LayerTemplate *) * layerSlots);
+    int *layerTemplates = malloc(sizeof(int) * layerSlots);
+    int templateCount = EditorStateTemplatesUsed(state, templates, layerTemplates);
+    BytesWriteU16(&buffer, (uint16_t) templateCount);
+    for (int i = 0; i < templateCount; i++) {
+        LayerTemplate *layerTemplate = templates[i];
+        int nameLength = (int) strlen(layerTemplate->name);
+        if (nameLength > UINT16_MAX) nameLength = UINT16_MAX;
+        BytesWriteU16(&buffer, (uint16_t) nameLength);
+        LIST_ADD_ARRAY(&buffer, layerTemplate->name, nameLength);
+        BytesWriteI32(&buffer, layerTemplate->knockbackX);
+        BytesWriteI32(&buffer, layerTemplate->knockbackY);
+        BytesWriteI32(&buffer, layerTemplate->damage);
+        BytesWriteI32(&buffer, layerTemplate->stun);
+        BytesWriteU32(&buffer, layerTemplate->flags);
+        WriteShape(&buffer, layerTemplate->shape);
+    }
+
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Layer *layer = state->layers + layerIdx;
+        BytesWriteU8(&buffer, (uint8_t) layer->type);
+        int nameLength = (int) strlen(layer->name);
+        if (nameLength > UINT16_MAX) nameLength = UINT16_MAX;
+        BytesWriteU16(&buffer, (uint16_t) nameLength);
+        LIST_ADD_ARRAY(&buffer, layer->name, nameLength);
+        BytesWriteI32(&buffer, layer->parent);
+        int sampleCount = LIST_COUNT(layer->keys) > 0 ? state->frameCount : 1;
+        BytesWriteU8(&buffer, sampleCount > 1);
+        for (int frameIdx = 0; frameIdx < sampleCount; frameIdx++) {
+            Vector2 position = LayerSampleAt(layer, frameIdx).position;
+            BytesWriteF32(&buffer, position.x);
+            BytesWriteF32(&buffer, position.y);
+        }
+        for (int frameIdx = 0; frameIdx < state->frameCount; frameIdx++) BytesWriteU8(&buffer, layer->framesActive[frameIdx]);
+
+        unsigned int overrides = 0;
+        if (TemplateFields(layer->type)) {
+            int templateIdx = layerTemplates[layerIdx];
+            overrides = TemplateOverrides(templateIdx >= 0 ? templates[templateIdx] : NULL, layer);
+            BytesWriteU16(&buffer, (uint16_t) (int16_t) templateIdx);
+            BytesWriteU8(&buffer, (uint8_t) overrides);
+        }
+        switch (layer->type) {
+            case LAYER_HITBOX:
+                if (overrides & TEMPLATE_FIELD_KNOCKBACK) {
+                    BytesWriteI32(&buffer, layer->hitbox.knockbackX);
+                    BytesWriteI32(&buffer, layer->hitbox.knockbackY);
+                }
+                if (overrides & TEMPLATE_FIELD_DAMAGE) BytesWriteI32(&buffer, layer->hitbox.damage);
+                if (overrides & TEMPLATE_FIELD_STUN) BytesWriteI32(&buffer, layer->hitbox.stun);
+                break;
+            case LAYER_SHAPE:
+                if (overrides & TEMPLATE_FIELD_FLAGS) BytesWriteU32(&buffer, layer->shape.flags);
+                break;
+            case LAYER_BEZIER:
+                for (int frameIdx = 0; frameIdx < state->frameCount; frameIdx++) {
+                    if (!layer->framesActive[frameIdx]) continue;
+                    BezierPoint point = layer->bezierPoints[frameIdx];
+                    BytesWriteF32(&buffer, point.position.x);
+                    BytesWriteF32(&buffer, point.position.y);
+                    BytesWriteF32(&buffer, point.extentsLeft);
+                    BytesWriteF32(&buffer, point.extentsRight);
+                    BytesWriteF32(&buffer, point.rotation);
+                }
+                break;
+            case LAYER_EMPTY:
+                break;
+        }
+        if (overrides & TEMPLATE_FIELD_SHAPE) {
+            for (int frameIdx = 0; frameIdx < sampleCount; frameIdx++) WriteShape(&buffer, LayerSampleAt(layer, frameIdx).shape);
+        }
+    }
+    free(templates);
+    free(layerTemplates);
+
+    if (state->layerCount > 0) {
+        int *order = malloc(sizeof(int) * state->layerCount);
+        bool ordered = EditorStateLayerOrder(state, order);
+        assert(ordered);
+        (void) ordered;
+        for (int i = 0; i < state->layerCount; i++) BytesWriteU32(&buffer, (uint32_t) order[i]);
+        free(order);
+    }
+    return buffer;
+}
+
+typedef struct CompactWriter {
+    LIST(unsigned char) *buffer;
+    // What is being written, only used to name values that don't fit. owner is NULL for frames and frame is -1 for
+    // values that aren't per frame.
+    const char *ownerKind;
+    const char *owner;
+    int frame;
+    bool valid; // false after the first value that didn't fit. Later values are still written but not reported.
+} CompactWriter;
+
+static void CompactInvalid(CompactWriter *writer, const char *what, double value) {
+    if (!writer->valid) return;
+    writer->valid = false;
+    printf("The %s %g", what, value);
+    if (writer->owner) printf(" of %s \"%s\"", writer->ownerKind, writer->owner);
+    if (writer->frame >= 0) printf(" on frame %i", writer->frame);
+    printf(" doesn't fit the compact format.\n");
+}
+
+static void WriteCompactI16(CompactWriter *writer, double value, const char *what) {
+    double rounded = round(value);
+    if (!isfinite(value) || rounded < INT16_MIN || rounded > INT16_MAX) {
+        CompactInvalid(writer, what, value);
+        rounded = 0.0;
+    }
+    BytesWriteU16(writer->buffer, (uint16_t) (int16_t) rounded);
+}
+
+static void WriteCompactU16(CompactWriter *writer, long value, const char *what) {
+    if (value < 0 || value > UINT16_MAX) {
+        CompactInvalid(writer, what, (double) value);
+        value = 0;
+    }
+    BytesWriteU16(writer->buffer, (uint16_t) value);
+}
+
+static void WriteCompactAngle(CompactWriter *writer, float radians, const char *what) {
+    if (!isfinite(radians)) {
+        CompactInvalid(writer, what, radians);
+        radians = 0.0f;
+    }
+    double turns = (double) radians / (2.0 * PI);
+    double steps = round((turns - floor(turns)) * 65536.0);
+    BytesWriteU16(writer->buffer, (uint16_t) ((uint32_t) steps & 0xFFFF));
+}
+
+static void WriteCompactName(CompactWriter *writer, const char *name) {
+    size_t length = strlen(name);
+    if (length > UINT8_MAX) {
+        CompactInvalid(writer, "name length", (double) length);
+        length = 0;
+    }
+    BytesWriteU8(writer->buffer, (uint8_t) length);
+    LIST_ADD_ARRAY(writer->buffer, name, length);
+}
+
+static void WriteCompactShape(CompactWriter *writer, Shape shape) {
+    BytesWriteU8(writer->buffer, (uint8_t) shape.type);
+    switch (shape.type) {
+        case SHAPE_CIRCLE:
+            WriteCompactI16(writer, shape.circleRadius, "circle radius");
+            break;
+        case SHAPE_RECTANGLE:
+            WriteCompactI16(writer, shape.rectangle.rightX, "rectangle right");
+            WriteCompactI16(writer, shape.rectangle.bottomY, "rectangle bottom");
+            break;
+        case SHAPE_CAPSULE:
+            WriteCompactI16(writer, shape.capsule.radius, "capsule radius");
+            WriteCompactI16(writer, shape.capsule.height, "capsule height");
+            WriteCompactAngle(writer, shape.capsule.rotation, "capsule rotation");
+            break;
+    }
+}
+
+static void WriteFrameBits(LIST(unsigned char) *buffer, const bool *values, int frameCount) {
+    for (int byteIdx = 0; byteIdx < (frameCount + 7) / 8; byteIdx++) {
+        uint8_t bits = 0;
+        for (int bit = 0; bit < 8 && byteIdx * 8 + bit < frameCount; bit++) {
+            if (values[byteIdx * 8 + bit]) bits |= (uint8_t) (1u << bit);
+        }
+        BytesWriteU8(buffer, bits);
+    }
+}
+
+bool ExportCompact(EditorState *state, LIST(unsigned char) *out) {
+    CompactWriter writer = {.buffer = out, .frame = -1, .valid = true};
+    LIST_ADD_ARRAY(out, EXPORT_COMPACT_MAGIC, 4);
+    BytesWriteU16(out, EXPORT_COMPACT_VERSION);
+    WriteCompactU16(&writer, state->frameCount, "frame count");
+    // Parents are i16 so the layer count has to fit one as well.
+    if (state->layerCount > INT16_MAX) CompactInvalid(&writer, "layer count", state->layerCount);
+    BytesWriteU16(out, (uint16_t) state->layerCount);
+
+    int layerSlots = state->layerCount > 0 ? state->layerCount : 1;
+    LayerTemplate **templates = malloc(sizeof(LayerTemplate *) * layerSlots);
+    int *layerTemplates = malloc(sizeof(int) * layerSlots);
+    int templateCount = EditorStateTemplatesUsed(state, templates, layerTemplates);
+    BytesWriteU16(out, (uint16_t) templateCount);
+
+    bool *canCancel = malloc(sizeof(bool) * (state->frameCount > 0 ? state->frameCount : 1));
+    for (int i = 0; i < state->frameCount; i++) {
+        FrameInfo frame = state->frames[i];
+        writer.frame = i;
+        WriteCompactU16(&writer, frame.duration, "duration");
+        WriteCompactI16(&writer, frame.pos.x, "x");
+        WriteCompactI16(&writer, frame.pos.y, "y");
+        canCancel[i] = frame.canCancel;
+    }
+    writer.frame = -1;
+    WriteFrameBits(out, canCancel, state->frameCount);
+    free(canCancel);
+
+    writer.ownerKind = "template";
+    for (int i = 0; i < templateCount; i++) {
+        LayerTemplate *layerTemplate = templates[i];
+        writer.owner = layerTemplate->name;
+        WriteCompactName(&writer, layerTemplate->name);
+        WriteCompactI16(&writer, layerTemplate->knockbackX, "knockback x");
+        WriteCompactI16(&writer, layerTemplate->knockbackY, "knockback y");
+        WriteCompactI16(&writer, layerTemplate->damage, "damage");
+        WriteCompactI16(&writer, layerTemplate->stun, "stun");
+        BytesWriteU32(out, layerTemplate->flags);
+        WriteCompactShape(&writer, layerTemplate->shape);
+    }
+
+    writer.ownerKind = "layer";
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Layer *layer = state->layers + layerIdx;
+        writer.owner = layer->name;
+        writer.frame = -1;
+        int sampleCount = LIST_COUNT(layer->keys) > 0 ? state->frameCount : 1;
+        BytesWriteU8(out, (uint8_t) (layer->type | (sampleCount > 1) << 7));
+        WriteCompactName(&writer, layer->name);
+        BytesWriteU16(out, (uint16_t) (int16_t) layer->parent);
+        for (int frameIdx = 0; frameIdx < sampleCount; frameIdx++) {
+            writer.frame = sampleCount > 1 ? frameIdx : -1;
+            Vector2 position = LayerSampleAt(layer, frameIdx).position;
+            WriteCompactI16(&writer, position.x, "x");
+            WriteCompactI16(&writer, position.y, "y");
+        }
+        writer.frame = -1;
+        WriteFrameBits(out, layer->framesActive, state->frameCount);
+
+        unsigned int overrides = 0;
+        if (TemplateFields(layer->type)) {
+            int templateIdx = layerTemplates[layerIdx];
+            overrides = TemplateOverrides(templateIdx >= 0 ? templates[templateIdx] : NULL, layer);
+            BytesWriteU16(out, (uint16_t) (int16_t) templateIdx);
+            BytesWriteU8(out, (uint8_t) overrides);
+        }
+        switch (layer->type) {
+            case LAYER_HITBOX:
+                if (overrides & TEMPLATE_FIELD_KNOCKBACK) {
+                    WriteCompactI16(&writer, layer->hitbox.knockbackX, "knockback x");
+                    WriteCompactI16(&writer, layer->hitbox.knockbackY, "knockback y");
+                }
+                if (overrides & TEMPLATE_FIELD_DAMAGE) WriteCompactI16(&writer, layer->hitbox.damage, "damage");
+                if (overrides & TEMPLATE_FIELD_STUN) WriteCompactI16(&writer, layer->hitbox.stun, "stun");
+                break;
+            case LAYER_SHAPE:
+                if (overrides & TEMPLATE_FIELD_FLAGS) BytesWriteU32(out, layer->shape.flags);
+                break;
+            case LAYER_BEZIER:
+                for (int frameIdx = 0; frameIdx < state->frameCount; frameIdx++) {
+                    if (!layer->framesActive[frameIdx]) continue;
+                    BezierPoint point = layer->bezierPoints[frameIdx];
+                    writer.frame = frameIdx;
+                    WriteCompactI16(&writer, point.position.x, "bezier x");
+                    WriteCompactI16(&writer, point.position.y, "bezier y");
+                    WriteCompactI16(&writer, point.extentsLeft, "bezier left extent");
+                    WriteCompactI16(&writer, point.extentsRight, "bezier right extent");
+                    WriteCompactAngle(&writer, point.rotation, "bezier rotation");
+                }
+                break;
+            case LAYER_EMPTY:
+                break;
+        }
+        if (overrides & TEMPLATE_FIELD_SHAPE) {
+            for (int frameIdx = 0; frameIdx < sampleCount; frameIdx++) {
+                writer.frame = sampleCount > 1 ? frameIdx : -1;
+                WriteCompactShape(&writer, LayerSampleAt(layer, frameIdx).shape);
+            }
+        }
+    }
+    free(templates);
+    free(layerTemplates);
+
+    if (state->layerCount > 0) {
+        int *order = malloc(sizeof(int) * state->layerCount);
+        bool ordered = EditorStateLayerOrder(state, order);
+        assert(ordered);
+        (void) ordered;
+        for (int i = 0; i < state->layerCount; i++) BytesWriteU16(out, (uint16_t) order[i]);
+        free(order);
+    }
+    return writer.valid;
+}
+
+static void WriteHeader(LIST(unsigned char) data, const char *symbol, FILE *file) {
+    fprintf(file, "// Generated by cac. Do not edit.\n");
+    fprintf(file, "#ifndef CAC_%s_H\n#define CAC_%s_H\n\n", symbol, symbol);
+    fprintf(file, "static const unsigned int %s_size = %i;\n", symbol, LIST_COUNT(data));
+    fprintf(file, "static const unsigned char %s[] = {", symbol);
+    for (int i = 0; i < LIST_COUNT(data); i++) {
+        if (i % 16 == 0) fputs("\n    ", file);
+        fprintf(file, "0x%02x,", data[i]);
+    }
+    fprintf(file, "\n};\n\n#endif\n");
+}
+
+bool ExportWrite(EditorState *state, ExportFormat format, const char *symbol, FILE *file) {
+    switch (format) {
+        case EXPORT_FORMAT_JSON: {
+            cJSON *json = EditorStateToJson(state);
+            char *str = cJSON_PrintUnformatted(json);
+            cJSON_Delete(json);
+            if (!str) return false;
+            fputs(str, file);
+            free(str);
+        } break;
+        
+        case EXPORT_FORMAT_BINARY: {
+            LIST(unsigned char) data = ExportBinary(state);
+            fwrite(data, 1, LIST_COUNT(data), file);
+            LIST_FREE(data);
+        } break;
+
+        case EXPORT_FORMAT_HEADER: {
+            LIST(unsigned char) data = ExportBinary(state);
+            WriteHeader(data, symbol, file);
+            LIST_FREE(data);
+        } break;
+
+        case EXPORT_FORMAT_TABLES:
+            return CodegenWrite(state, symbol, file);
+
+        case EXPORT_FORMAT_COMPACT: {
+            LIST(unsigned char) data = LIST_NEW(unsigned char);
+            bool valid = ExportCompact(state, &data);
+            if (valid) fwrite(data, 1, LIST_COUNT(data), file);
+            LIST_FREE(data);
+            if (!valid) return false;
+        } break;
+    }
+    return !ferror(file);
+}
+
+// "attacks/Jab-2.json" becomes "Jab_2"
+static char *ExportSymbol(const char *path) {
+    const char *baseName = FilesBaseName(path);
+    const char *dot = strrchr(baseName, '.');
+    int length = dot ? (int) (dot - baseName) : (int) strlen(baseName);
+    
+    StringBuffer symbolBuffer = STRING_BUFFER_NEW();
+    if (length == 0 || isdigit((unsigned char) baseName[0])) StringBufferAddChar(&symbolBuffer, '_');
+    for (int i = 0; i < length; i++) {
+        char c = baseName[i];
+        StringBufferAddChar(&symbolBuffer, isalnum((unsigned char) c) ? c : '_');
+    }
+    return StringBufferFree(&symbolBuffer);
+}
+
+typedef enum ExportResult {
+    EXPORT_RESULT_WRITTEN,
+    EXPORT_RESULT_UP_TO_DATE,
+    EXPORT_RESULT_CACHED, // Written from the build cache without deserializing the input.
+    EXPORT_RESULT_FAILED
+} ExportResult;
+
+typedef struct ExportJob {
+    const char *inputPath;
+    char *outputPath;
+    char *symbol;
+    ExportOptions *options;
+    
+    ExportResult result;
+    long bytesIn;
+    long bytesOut;
+} ExportJob;
+
+static long FileSize(const char *path) {
+    struct stat fileStat;
+    if (stat(path, &fileStat) != 0) return 0;
+    return (long) fileStat.st_size;
+}
+
+static void ExportJobRun(void *data) {
+    ExportJob *job = data;
+    job->bytesIn = FileSize(job->inputPath);
+    
+    // Linked layers get values from the project's templates, so the output depends on them as well.
+    char *templatesPath = TemplateTablePath(job->inputPath);
+    bool templatesModified = FilesModifiedAfter(templatesPath, job->outputPath);
+    free(templatesPath);
+    bool outputExists = FileSize(job->outputPath) > 0;
+    if (!job->options->force && outputExists && !FilesModifiedAfter(job->inputPath, job->outputPath) && !templatesModified) {
+        job->result = EXPORT_RESULT_UP_TO_DATE;
+        return;
+    }
+
+    job->result = EXPORT_RESULT_FAILED;
+    uint64_t cacheKey = 0;
+    if (job->options->cacheDirectory) {
+        size_t inputSize;
+        unsigned char *input = FilesRead(job->inputPath, &inputSize);
+        if (!input) return;
+        size_t variantSize = strlen(job->symbol) + sizeof(":0123456789abcdef");
+        char *variant = malloc(variantSize);
+        snprintf(variant, variantSize, "%s:%016llx", job->symbol, (unsigned long long) TemplateTableFileHash(job->inputPath));
+        cacheKey = BuildCacheKey(input, inputSize, ExportFormatExtension(job->options->format), variant);
+        free(variant);
+        free(input);
+        
+        size_t cachedSize;
+        unsigned char *cached = BuildCacheLoad(job->options->cacheDirectory, cacheKey, &cachedSize);
+        if (cached) {
+            if (FilesWrite(job->outputPath, cached, cachedSize)) {
+                job->result = EXPORT_RESULT_CACHED;
+            } else {
+                remove(job->outputPath);
+            }
+            free(cached);
+            return;
+        }
+    }
+
+    EditorState state;
+    if (!EditorStateDeserialize(&state, job->inputPath)) return;
+    
+    bool binary = job->options->format == EXPORT_FORMAT_BINARY || job->options->format == EXPORT_FORMAT_COMPACT;
+    FILE *file = fopen(job->outputPath, binary ? "wb" : "w");
+    if (file) {
+        if (ExportWrite(&state, job->options->format, job->symbol, file)) job->result = EXPORT_RESULT_WRITTEN;
+        fclose(file);
+    }
+    EditorStateFree(&state);
+    
+    if (job->result != EXPORT_RESULT_WRITTEN) {
+        remove(job->outputPath); // Don't leave a partial output that looks up to date.
+        return;
+    }
+    job->bytesOut = FileSize(job->outputPath);
+    if (job->options->cacheDirectory) {
+        size_t outputSize;
+        unsigned char *output = FilesRead(job->outputPath, &outputSize);
+        if (output) BuildCacheSave(job->options->cacheDirectory, cacheKey, output, outputSize);
+        free(output);
+    }
+}
+
+int ExportRun(LIST(char *) inputs, ExportOptions *options) {
+    if (!FilesMakeDirectory(options->outputDirectory)) {
+        printf("Failed to create the output directory %s.\n", options->outputDirectory);
+        return LIST_COUNT(inputs);
+    }
+    
+    double timeStart = TimerSeconds();
+    int jobCount = LIST_COUNT(inputs);
+    ExportJob *jobs = calloc(jobCount > 0 ? jobCount : 1, sizeof(ExportJob));
+    WorkerPool *pool = WorkerPoolNew(options->threadCount);
+    
+    int failures = 0;
+    for (int i = 0; i < jobCount; i++) {
+        ExportJob *job = jobs + i;
+        job->inputPath = inputs[i];
+        job->options = options;
+        job->symbol = ExportSymbol(inputs[i]);
+        
+        StringBuffer nameBuffer = STRING_BUFFER_NEW();
+        StringBufferAddString(&nameBuffer, FilesBaseName(inputs[i]));
+        char *dot = strrchr(nameBuffer.raw, '.');
+        if (dot) {
+            nameBuffer.length = (int) (dot - nameBuffer.raw);
+            *dot = '\0';
+        }
+        StringBufferAddString(&nameBuffer, ExportFormatExtension(options->format));
+        char *name = StringBufferFree(&nameBuffer);
+        job->outputPath = FilesJoin(options->outputDirectory, name);
+        free(name);
+
+        // Outputs are flattened into one directory so two inputs with the same name would clobber each other.
+        bool duplicate = false;
+        for (int j = 0; j < i && !duplicate; j++) duplicate = !strcmp(jobs[j].outputPath, job->outputPath);
+        if (duplicate) {
+            job->result = EXPORT_RESULT_FAILED;
+            printf("Skipping %s because another input already exports to %s.\n", job->inputPath, job->outputPath);
+            continue;
+        }
+        WorkerPoolPush(pool, ExportJobRun, job);
+    }
+    WorkerPoolWait(pool);
+    WorkerPoolFree(pool);
+    double seconds = TimerSeconds() - timeStart;
+
+    int written = 0;
+    int cachedCount = 0;
+    long bytesIn = 0;
+    long bytesOut = 0;
+    for (int i = 0; i < jobCount; i++) {
+        ExportJob *job = jobs + i;
+        switch (job->result) {
+            case EXPORT_RESULT_WRITTEN:
+                printf("Exported %s to %s.\n", job->inputPath, job->outputPath);
+                written++;
+                bytesIn += job->bytesIn;
+                bytesOut += job->bytesOut;
+                break;
+            case EXPORT_RESULT_CACHED:
+                printf("Restored %s from the build cache.\n", job->outputPath);
+                cachedCount++;
+                break;
+            case EXPORT_RESULT_UP_TO_DATE:
+                break;
+            case EXPORT_RESULT_FAILED:
+                printf("Failed to export %s.\n", job->inputPath);
+                failures++;
+                break;
+        }
+        free(job->outputPath);
+        free(job->symbol);
+    }
+    free(jobs);
+    
+    double megabytes = (double) bytesIn / (1024.0 * 1024.0);
+    printf("%i exported, %i from cache, %i up to date, %i failed in %.3f s using %i threads.\n",
+        written, cachedCount, jobCount - written - cachedCount - failures, failures, seconds, options->threadCount);
+    if (seconds > 0.0 && written > 0) {
+        printf("Throughput: %.1f files/s, %.2f MB/s in, %.2f MB written.\n",
+            written / seconds, megabytes / seconds, (double) bytesOut / (1024.0 * 1024.0));
+    }
+    return failures;
+}
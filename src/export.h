@@ -0,0 +1,98 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "editor_history.h"
+#include "list.h"
+
+#define EXPORT_DIRECTORY_DEFAULT "export"
+#define EXPORT_BINARY_MAGIC "CABN"
+#define EXPORT_BINARY_VERSION 4
+#define EXPORT_COMPACT_MAGIC "CABQ"
+#define EXPORT_COMPACT_VERSION 1
+
+// Binary layout. Everything is little endian, floats are IEEE 754 singles. No padding.
+//  char[4] magic, u32 version, u32 frameCount, u32 layerCount
+//  frameCount times: i32 duration, u8 canCancel, f32 x, f32 y
+//  u16 templateCount, templateCount times:
+//      u16 nameLength, nameLength bytes of name, i32 knockbackX, i32 knockbackY, i32 damage, i32 stun, u32 flags, shape
+//  layerCount times:
+//      u8 type (LayerType), u16 nameLength, nameLength bytes of name (no terminator), i32 parent, u8 keyed
+//      keyed ? frameCount times : once: f32 x, f32 y
+//      frameCount times: u8 active
+//      LAYER_HITBOX and LAYER_SHAPE: i16 template index or -1, u8 overrides, then
+//          LAYER_HITBOX: the overridden ones of i32 knockbackX and i32 knockbackY, i32 damage, i32 stun
+//          LAYER_SHAPE: u32 flags if overridden
+//          keyed ? frameCount shapes : shape if the shape is overridden
+//      Override bits: 1 knockback, 2 damage, 4 stun, 8 flags, 16 shape.
+//      LAYER_BEZIER: for each active frame: f32 x, f32 y, f32 extentsLeft, f32 extentsRight, f32 rotation
+//  layerCount times: u32 layer index, ordered so parents come before their children
+//  shape: u8 type (ShapeType), then
+//      SHAPE_CIRCLE: i32 radius
+//      SHAPE_RECTANGLE: i32 rightX, i32 bottomY
+//      SHAPE_CAPSULE: i32 radius, i32 height, f32 rotation
+// Keyed layers have their keyframes evaluated for every frame, so readers never interpolate.
+// Only the templates the layers use are written. Layers without a template override everything, and keyed layers
+// always override the shape. Readers can keep one copy of each template and the overrides per layer.
+// Positions are relative to the origin of the parent, or to the sprite for parent -1. Going through the layers in the
+// order at the end and adding each parent's world position gives every world position in a single pass.
+// Version 1 had no keyed byte and always one position and shape. Version 2 had no parents and no order.
+// Version 3 had no templates and every hitbox and shape value in each layer.
+
+// Compact layout. The binary layout with every value quantized for runtimes that only need pixel precision.
+//  char[4] magic, u16 version, u16 frameCount, u16 layerCount, u16 templateCount
+//  frameCount times: u16 duration, i16 x, i16 y
+//  frame bits: canCancel
+//  templateCount times:
+//      u8 nameLength, name, i16 knockbackX, i16 knockbackY, i16 damage, i16 stun, u32 flags, shape
+//  layerCount times:
+//      u8 type (LayerType) | keyed << 7, u8 nameLength, name, i16 parent
+//      keyed ? frameCount times : once: i16 x, i16 y
+//      frame bits: active
+//      LAYER_HITBOX and LAYER_SHAPE: i16 template index or -1, u8 overrides, then the overridden values as above
+//          with i16 in place of each i32
+//      LAYER_BEZIER: for each active frame: i16 x, i16 y, i16 extentsLeft, i16 extentsRight, angle rotation
+//  layerCount times: u16 layer index, ordered so parents come before their children
+//  shape: u8 type (ShapeType), then
+//      SHAPE_CIRCLE: i16 radius
+//      SHAPE_RECTANGLE: i16 rightX, i16 bottomY
+//      SHAPE_CAPSULE: i16 radius, i16 height, angle rotation
+//  frame bits: (frameCount + 7) / 8 bytes, bit (i % 8) of byte (i / 8) for frame i
+//  angle: u16 in 1/65536 of a turn counterclockwise like the radians it comes from, wrapped into [0, 65536)
+// Pixels are rounded to the nearest integer, so positions are within half a pixel and angles within half a step of
+// the source. Exporting fails instead of clamping when a value doesn't fit its field, naming the value.
+// Flags keep all 32 bits since every bit can be set in the editor.
+// The header format is the binary format embedded in a C array.
+// The tables format is a header of typed static arrays, see codegen.h.
+
+typedef enum ExportFormat {
+    EXPORT_FORMAT_JSON, // Same as the source file without whitespace.
+    EXPORT_FORMAT_BINARY,
+    EXPORT_FORMAT_HEADER,
+    EXPORT_FORMAT_TABLES,
+    EXPORT_FORMAT_COMPACT
+} ExportFormat;
+
+typedef struct ExportOptions {
+    ExportFormat format;
+    const char *outputDirectory;
+    int threadCount;
+    bool force; // Write outputs even if they are newer than their inputs.
+    const char *cacheDirectory; // Build cache to restore outputs from and add them to. NULL to not use one.
+} ExportOptions;
+
+bool ExportFormatParse(const char *string, ExportFormat *format);
+const char *ExportFormatExtension(ExportFormat format);
+
+LIST(unsigned char) ExportBinary(EditorState *state);
+// Appends the compact layout to out. Prints the first value that doesn't fit and returns false if there is one.
+bool ExportCompact(EditorState *state, LIST(unsigned char) *out);
+// symbol is the C identifier used by the header format.
+bool ExportWrite(EditorState *state, ExportFormat format, const char *symbol, FILE *file);
+
+// Exports every input file into the output directory with one job per file on a worker pool.
+// Prints a line per file and a throughput summary. Returns the number of files that failed.
+int ExportRun(LIST(char *) inputs, ExportOptions *options);
+
+#endif
@@ -0,0 +1,123 @@
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include "list.h"
+#include "string_buffer.h"
+#include "files.h"
+
+static bool HasExtension(const char *path, const char *extension) {
+    const char *dot = strrchr(FilesBaseName(path), '.');
+    return dot && strcmp(dot, extension) == 0;
+}
+
+// "./export" and "export" should both match the skipped directory.
+static const char *PathStripCurrent(const char *path) {
+    while (path[0] == '.' && (path[1] == '/' || path[1] == '\\')) path += 2;
+    return path;
+}
+
+void FilesCollect(const char *path, const char *extension, const char *skipDirectory, LIST(char *) *paths) {
+    struct stat fileStat;
+    if (stat(path, &fileStat) != 0) {
+        printf("Failed to obtain information about the file at %s. Skipping.\n", path);
+        return;
+    }
+
+    if (S_ISREG(fileStat.st_mode)) {
+        if (!HasExtension(path, extension)) return;
+        StringBuffer pathBuffer = STRING_BUFFER_NEW();
+        StringBufferAddString(&pathBuffer, path);
+        LIST_ADD(paths, StringBufferFree(&pathBuffer));
+        return;
+    }
+    
+    if (!S_ISDIR(fileStat.st_mode)) return; // no symlink support
+    if (skipDirectory && strcmp(PathStripCurrent(path), PathStripCurrent(skipDirectory)) == 0) return;
+
+    DIR *dir = opendir(path);
+    if (!dir) {
+        printf("Failed to open directory at %s\n", path);
+        return;
+    }
+    
+    // Sort the entries so the order doesn't depend on the file system.
+    LIST(char *) names = LIST_NEW(char *);
+    struct dirent *directoryEntry;
+    while ((directoryEntry = readdir(dir))) {
+        if (strcmp(directoryEntry->d_name, ".") == 0 || strcmp(directoryEntry->d_name, "..") == 0) continue;
+        LIST_ADD(&names, FilesJoin(path, directoryEntry->d_name));
+    }
+    closedir(dir);
+    
+    for (int i = 1; i < LIST_COUNT(names); i++) { // insertion sort, directories are small
+        char *name = names[i];
+        int j = i - 1;
+        for (; j >= 0 && strcmp(names[j], name) > 0; j--) names[j + 1] = names[j];
+        names[j + 1] = name;
+    }
+    
+    for (int i = 0; i < LIST_COUNT(names); i++) {
+        FilesCollect(names[i], extension, skipDirectory, paths);
+        free(names[i]);
+    }
+    LIST_FREE(names);
+}
+
+bool FilesMakeDirectory(const char *path) {
+    struct stat fileStat;
+    if (stat(path, &fileStat) == 0) return S_ISDIR(fileStat.st_mode);
+#ifdef _WIN32
+    return _mkdir(path) == 0;
+#else
+    return mkdir(path, 0755) == 0;
+#endif
+}
+
+const char *FilesBaseName(const char *path) {
+    const char *baseName = path;
+    for (const char *c = path; *c; c++) {
+        if (*c == '/' || *c == '\\') baseName = c + 1;
+    }
+    return baseName;
+}
+
+char *FilesJoin(const char *directory, const char *name) {
+    StringBuffer pathBuffer = STRING_BUFFER_NEW();
+    StringBufferAddString(&pathBuffer, directory);
+    StringBufferAddChar(&pathBuffer, '/');
+    StringBufferAddString(&pathBuffer, name);
+    return StringBufferFree(&pathBuffer);
+}
+
+bool FilesModifiedAfter(const char *path, const char *reference) {
+    struct stat pathStat;
+    struct stat referenceStat;
+    if (stat(path, &pathStat) != 0 || stat(reference, &referenceStat) != 0) return false;
+    return pathStat.st_mtime > referenceStat.st_mtime;
+}
+
+unsigned char *FilesRead(const char *path, size_t *size) {
+    struct stat fileStat;
+    if (stat(path, &fileStat) != 0) return NULL;
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    unsigned char *data = malloc(fileStat.st_size > 0 ? fileStat.st_size : 1);
+    *size = fread(data, 1, fileStat.st_size, file);
+    fclose(file);
+    return data;
+}
+
+bool FilesWrite(const char *path, const void *data, size_t size) {
+    FILE *file = fopen(path, "wb");
+    if (!file) return false;
+    bool success = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && success;
+}
@@ -0,0 +1,19 @@
+#ifndef FILES_H
+#define FILES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "list.h"
+
+// Adds every regular file under path whose name ends with extension (e.g. ".json") to paths.
+// If path is a file it is added as long as the extension matches. Directories named skipDirectory are not entered.
+// The paths are malloc'ed and owned by the caller.
+void FilesCollect(const char *path, const char *extension, const char *skipDirectory, LIST(char *) *paths);
+bool FilesMakeDirectory(const char *path); // true if the directory exists afterwards.
+const char *FilesBaseName(const char *path); // Points into path.
+char *FilesJoin(const char *directory, const char *name);
+bool FilesModifiedAfter(const char *path, const char *reference); // false if either is missing.
+unsigned char *FilesRead(const char *path, size_t *size); // Whole file, malloc'ed. NULL if it can't be read.
+bool FilesWrite(const char *path, const void *data, size_t size);
+
+#endif
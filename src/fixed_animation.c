@@ -0,0 +1,279 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bytes.h"
+#include "fixed_point.h"
+#include "list.h"
+#include "fixed_animation.h"
+
+// The override bits of the compact export, see export.h.
+enum {
+    COMPACT_KNOCKBACK = 1 << 0,
+    COMPACT_DAMAGE = 1 << 1,
+    COMPACT_STUN = 1 << 2,
+    COMPACT_FLAGS = 1 << 3,
+    COMPACT_SHAPE = 1 << 4
+};
+
+static Fixed ReadPixels(BytesReader *reader) {
+    return FixedFromInt(BytesReadI16(reader));
+}
+
+static FixedVector2 ReadPosition(BytesReader *reader) {
+    FixedVector2 position;
+    position.x = ReadPixels(reader);
+    position.y = ReadPixels(reader);
+    return position;
+}
+
+static FixedShape ReadShape(BytesReader *reader) {
+    FixedShape shape = {0};
+    int type = BytesReadU8(reader);
+    switch (type) {
+        case FIXED_SHAPE_CIRCLE:
+            shape.circleRadius = ReadPixels(reader);
+            break;
+        case FIXED_SHAPE_RECTANGLE:
+            shape.rectangle.rightX = ReadPixels(reader);
+            shape.rectangle.bottomY = ReadPixels(reader);
+            break;
+        case FIXED_SHAPE_CAPSULE:
+            shape.capsule.radius = ReadPixels(reader);
+            shape.capsule.height = ReadPixels(reader);
+            shape.capsule.rotation = BytesReadU16(reader);
+            break;
+        default:
+            reader->failed = true;
+            return shape;
+    }
+    shape.type = (FixedShapeType) type;
+    return shape;
+}
+
+static void ReadFrameBits(BytesReader *reader, bool *values, int frameCount) {
+    const unsigned char *bytes = BytesRead(reader, (size_t) (frameCount + 7) / 8);
+    for (int frame = 0; frame < frameCount; frame++) values[frame] = bytes && (bytes[frame / 8] >> (frame % 8)) & 1;
+}
+
+// Layers that aren't keyed have one value for every frame.
+static FixedLayer LayerRead(BytesReader *reader, int frameCount, int layerCount, const FixedShape *templateShapes, int templateCount) {
+    int typeAndKeyed = BytesReadU8(reader);
+    int type = typeAndKeyed & 0x7F;
+    bool keyed = typeAndKeyed >> 7;
+    BytesRead(reader, BytesReadU8(reader)); // The name.
+    int parent = BytesReadI16(reader);
+    if (type > FIXED_LAYER_EMPTY || parent < -1 || parent >= layerCount) reader->failed = true;
+
+    FixedLayer layer = {
+        .type = (FixedLayerType) type,
+        .parent = parent,
+        .basisX = {FIXED_ONE, 0},
+        .basisY = {0, FIXED_ONE},
+        .active = LIST_NEW_SIZED(bool, frameCount),
+        .positions = LIST_NEW_SIZED(FixedVector2, frameCount),
+        .shapes = LIST_NEW(FixedShape),
+        .bezierPoints = LIST_NEW(FixedBezierPoint)
+    };
+    int sampleCount = keyed ? frameCount : 1;
+    for (int sample = 0; sample < sampleCount; sample++) {
+        FixedVector2 position = ReadPosition(reader);
+        for (int frame = sample; frame < (keyed ? sample + 1 : frameCount); frame++) layer.positions[frame] = position;
+    }
+    ReadFrameBits(reader, layer.active, frameCount);
+
+    bool hasShape = type == FIXED_LAYER_HITBOX || type == FIXED_LAYER_SHAPE;
+    int templateIdx = -1;
+    unsigned int overrides = 0;
+    if (hasShape) {
+        templateIdx = BytesReadI16(reader);
+        overrides = BytesReadU8(reader);
+        // Layers without a template have every value.
+        if (templateIdx < -1 || templateIdx >= templateCount || (templateIdx < 0 && !(overrides & COMPACT_SHAPE))) {
+            reader->failed = true;
+            templateIdx = -1;
+        }
+    }
+    // Hitbox values and flags aren't part of poses, they are only skipped.
+    if (type == FIXED_LAYER_HITBOX) {
+        int valueCount = (overrides & COMPACT_KNOCKBACK ? 2 : 0) + (overrides & COMPACT_DAMAGE ? 1 : 0) + (overrides & COMPACT_STUN ? 1 : 0);
+        BytesRead(reader, 2 * (size_t) valueCount);
+    } else if (type == FIXED_LAYER_SHAPE && overrides & COMPACT_FLAGS) {
+        BytesRead(reader, 4);
+    } else if (type == FIXED_LAYER_BEZIER) {
+        LIST_RESERVE(&layer.bezierPoints, frameCount);
+        LIST_SHRINK(layer.bezierPoints, frameCount);
+        for (int frame = 0; frame < frameCount; frame++) {
+            FixedBezierPoint point = {0};
+            if (layer.active[frame]) {
+                point.position = ReadPosition(reader);
+                point.extentsLeft = ReadPixels(reader);
+                point.extentsRight = ReadPixels(reader);
+                point.rotation = BytesReadU16(reader);
+            }
+            layer.bezierPoints[frame] = point;
+        }
+    }
+
+    if (hasShape) {
+        LIST_RESERVE(&layer.shapes, frameCount);
+        LIST_SHRINK(layer.shapes, frameCount);
+        if (overrides & COMPACT_SHAPE) {
+            for (int sample = 0; sample < sampleCount; sample++) {
+                FixedShape shape = ReadShape(reader);
+                for (int frame = sample; frame < (keyed ? sample + 1 : frameCount); frame++) layer.shapes[frame] = shape;
+            }
+        } else {
+            FixedShape shape = templateIdx >= 0 ? templateShapes[templateIdx] : (FixedShape) {0};
+            for (int frame = 0; frame < frameCount; frame++) layer.shapes[frame] = shape;
+        }
+    }
+    return layer;
+}
+
+bool FixedAnimationFromCompact(const unsigned char *data, size_t size, FixedAnimation *out) {
+    BytesReader reader = {.data = data, .size = size, .at = 0, .failed = false};
+    const unsigned char *magic = BytesRead(&reader, 4);
+    if (!magic || memcmp(magic, FIXED_ANIMATION_COMPACT_MAGIC, 4) || BytesReadU16(&reader) != FIXED_ANIMATION_COMPACT_VERSION) {
+        return false;
+    }
+    int frameCount = BytesReadU16(&reader);
+    int layerCount = BytesReadU16(&reader);
+    int templateCount = BytesReadU16(&reader);
+    if (reader.failed || layerCount > INT16_MAX) return false;
+
+    FixedAnimation animation = {
+        .frameCount = frameCount,
+        .layerCount = 0, // Counts the layers read so far, so failing frees only those.
+        .frames = LIST_NEW_SIZED(FixedFrame, frameCount),
+        .frameStarts = LIST_NEW_SIZED(int64_t, frameCount + 1),
+        .layers = LIST_NEW_SIZED(FixedLayer, layerCount),
+        .order = LIST_NEW_SIZED(int, layerCount)
+    };
+    animation.frameStarts[0] = 0;
+    for (int i = 0; i < frameCount; i++) {
+        FixedFrame *frame = animation.frames + i;
+        frame->duration = BytesReadU16(&reader);
+        frame->position = ReadPosition(&reader);
+        animation.frameStarts[i + 1] = animation.frameStarts[i] + frame->duration;
+    }
+    bool *canCancel = malloc(sizeof(bool) * (frameCount > 0 ? frameCount : 1));
+    ReadFrameBits(&reader, canCancel, frameCount);
+    for (int i = 0; i < frameCount; i++) animation.frames[i].canCancel = canCancel[i];
+    free(canCancel);
+
+    FixedShape *templateShapes = malloc(sizeof(FixedShape) * (templateCount > 0 ? templateCount : 1));
+    for (int i = 0; i < templateCount; i++) {
+        BytesRead(&reader, BytesReadU8(&reader)); // The name.
+        BytesRead(&reader, 4 * 2 + 4); // The hitbox values and flags.
+        templateShapes[i] = ReadShape(&reader);
+    }
+    while (animation.layerCount < layerCount && !reader.failed) {
+        animation.layers[animation.layerCount] = LayerRead(&reader, frameCount, layerCount, templateShapes, templateCount);
+        animation.layerCount++;
+    }
+    free(templateShapes);
+
+    // Poses are made in this order, so every layer has to be in it once and after its parent.
+    bool *placed = calloc(layerCount > 0 ? layerCount : 1, sizeof(bool));
+    for (int i = 0; i < layerCount && !reader.failed; i++) {
+        int layerIdx = BytesReadU16(&reader);
+        int parent = layerIdx < layerCount ? animation.layers[layerIdx].parent : -1;
+        if (layerIdx >= layerCount || placed[layerIdx] || (parent >= 0 && !placed[parent])) {
+            reader.failed = true;
+            break;
+        }
+        placed[layerIdx] = true;
+        animation.order[i] = layerIdx;
+    }
+    free(placed);
+
+    if (reader.failed || reader.at != reader.size) {
+        FixedAnimationFree(&animation);
+        return false;
+    }
+    *out = animation;
+    return true;
+}
+
+
+void FixedAnimationFree(FixedAnimation *animation) {
+    for (int i = 0; i < animation->layerCount; i++) {
+        FixedLayer *layer = animation->layers + i;
+        LIST_FREE(layer->active);
+        LIST_FREE(layer->positions);
+        LIST_FREE(layer->shapes);
+        LIST_FREE(layer->bezierPoints);
+    }
+    LIST_FREE(animation->frames);
+    LIST_FREE(animation->frameStarts);
+    LIST_FREE(animation->layers);
+    LIST_FREE(animation->order);
+}
+
+int FixedAnimationFrameAt(const FixedAnimation *animation, int64_t time) {
+    int64_t duration = animation->frameStarts[animation->frameCount];
+    if (duration <= 0) return 0;
+    time %= duration;
+    if (time < 0) time += duration;
+
+    // The last frame starting at or before the time. Zero length frames are skipped like EditorStateFrameAtTime does.
+    int low = 0;
+    int high = animation->frameCount - 1;
+    while (low < high) {
+        int middle = low + (high - low + 1) / 2;
+        if (animation->frameStarts[middle] <= time) low = middle;
+        else high = middle - 1;
+    }
+    return low;
+}
+
+void FixedAnimationPose(const FixedAnimation *animation, int frame, FixedLayerPose *poses) {
+    assert(0 <= frame && frame < animation->frameCount);
+    for (int i = 0; i < animation->layerCount; i++) {
+        int layerIdx = animation->order[i];
+        FixedLayer *layer = animation->layers + layerIdx;
+        FixedTransform local = {
+            .o = layer->positions[frame],
+            .x = layer->basisX,
+            .y = layer->basisY
+        };
+        FixedLayerPose *pose = poses + layerIdx;
+        pose->world = layer->parent < 0 ? local : FixedTransformMultiply(poses[layer->parent].world, local);
+        pose->shape = LIST_COUNT(layer->shapes) > 0 ? layer->shapes[frame] : (FixedShape) {0};
+        pose->active = layer->active[frame];
+    }
+}
+
+void FixedCapsuleCenters(FixedShape capsule, FixedTransform world, FixedVector2 *centers) {
+    assert(capsule.type == FIXED_SHAPE_CAPSULE);
+    FixedTransform transform = FixedTransformMultiply(world, FixedTransformFromRotation(capsule.capsule.rotation));
+    centers[0] = FixedTransformToGlobal(transform, (FixedVector2) {0, -capsule.capsule.height});
+    centers[1] = FixedTransformToGlobal(transform, (FixedVector2) {0, capsule.capsule.height});
+}
+
+FixedVector2 FixedBezierLerp(FixedBezierPoint p0, FixedBezierPoint p1, Fixed t) {
+    assert(0 <= t && t <= FIXED_ONE);
+
+    FixedVector2 control0 = FixedVector2Add(p0.position, FixedVector2Rotate((FixedVector2) {p0.extentsRight, 0}, p0.rotation));
+    FixedVector2 control1 = FixedVector2Add(p1.position, FixedVector2Rotate((FixedVector2) {-p1.extentsLeft, 0}, p1.rotation));
+
+    FixedVector2 q0 = FixedVector2Lerp(p0.position, control0, t);
+    FixedVector2 q1 = FixedVector2Lerp(control0, control1, t);
+    FixedVector2 q2 = FixedVector2Lerp(control1, p1.position, t);
+
+    FixedVector2 r0 = FixedVector2Lerp(q0, q1, t);
+    FixedVector2 r1 = FixedVector2Lerp(q1, q2, t);
+
+    return FixedVector2Lerp(r0, r1, t);
+}
+
+bool FixedAnimationBezierSample(const FixedAnimation *animation, int layerIdx, int frame, Fixed t, FixedTransform world, FixedVector2 *point) {
+    FixedLayer *layer = animation->layers + layerIdx;
+    assert(layer->type == FIXED_LAYER_BEZIER);
+    if (frame + 1 >= animation->frameCount || !layer->active[frame] || !layer->active[frame + 1]) return false;
+    *point = FixedTransformToGlobal(world, FixedBezierLerp(layer->bezierPoints[frame], layer->bezierPoints[frame + 1], t));
+    return true;
+}
@@ -0,0 +1,106 @@
+#ifndef FIXED_ANIMATION_H
+#define FIXED_ANIMATION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "fixed_point.h"
+#include "list.h"
+
+#define FIXED_ANIMATION_COMPACT_MAGIC "CABQ" // The EXPORT_COMPACT_MAGIC and EXPORT_COMPACT_VERSION it reads.
+#define FIXED_ANIMATION_COMPACT_VERSION 1
+
+// An animation converted to fixed point once so it can be evaluated bit for bit the same on every client, see
+// fixed_point.h. Keyed layers get a value per frame, interpolated while converting or by the export, so evaluating a
+// frame is lookups, one transform multiply per layer and no allocation. Nothing is shared with the data it was made from.
+// Games load the compact export with this, fixed_point, bytes, list and allocator and nothing from the editor.
+// fixed_animation_state.h converts editor states instead.
+
+// The values of ShapeType and LayerType, which the exports store.
+typedef enum FixedShapeType {
+    FIXED_SHAPE_CIRCLE,
+    FIXED_SHAPE_RECTANGLE,
+    FIXED_SHAPE_CAPSULE
+} FixedShapeType;
+
+typedef enum FixedLayerType {
+    FIXED_LAYER_HITBOX,
+    FIXED_LAYER_SHAPE,
+    FIXED_LAYER_BEZIER,
+    FIXED_LAYER_EMPTY
+} FixedLayerType;
+
+typedef struct FixedShape {
+    FixedShapeType type;
+    union {
+        Fixed circleRadius;
+        struct {
+            Fixed rightX;
+            Fixed bottomY;
+        } rectangle;
+        struct {
+            Fixed radius;
+            Fixed height;
+            FixedAngle rotation;
+        } capsule;
+    };
+} FixedShape;
+
+typedef struct FixedBezierPoint {
+    FixedVector2 position;
+    Fixed extentsLeft;
+    Fixed extentsRight;
+    FixedAngle rotation;
+} FixedBezierPoint;
+
+typedef struct FixedFrame {
+    int32_t duration;
+    bool canCancel;
+    FixedVector2 position; // The root position.
+} FixedFrame;
+
+typedef struct FixedLayer {
+    FixedLayerType type;
+    int parent;
+    FixedVector2 basisX; // Of the layer's transform, the origin is in positions.
+    FixedVector2 basisY;
+    LIST(bool) active; // One per frame, like the rest.
+    LIST(FixedVector2) positions; // Relative to the parent's origin when there is one.
+    LIST(FixedShape) shapes; // Empty for layers without a shape.
+    LIST(FixedBezierPoint) bezierPoints; // Empty for other layers. Zeroed on frames where the layer isn't active.
+} FixedLayer;
+
+typedef struct FixedAnimation {
+    int frameCount;
+    int layerCount;
+    LIST(FixedFrame) frames;
+    LIST(int64_t) frameStarts; // frameCount + 1 summed durations, the last one is the whole duration.
+    LIST(FixedLayer) layers;
+    LIST(int) order; // Layer indices with parents first.
+} FixedAnimation;
+
+// What one layer looks like on a frame.
+typedef struct FixedLayerPose {
+    FixedTransform world; // Relative to the sprite.
+    FixedShape shape; // Unused by bezier and empty layers.
+    bool active;
+} FixedLayerPose;
+
+// Reads what ExportCompact wrote, with its whole pixels. Fails for data that is cut short, has bytes left over, isn't
+// of FIXED_ANIMATION_COMPACT_VERSION or has a layer order that doesn't put parents first, and leaves nothing allocated.
+bool FixedAnimationFromCompact(const unsigned char *data, size_t size, FixedAnimation *out);
+void FixedAnimationFree(FixedAnimation *animation);
+// The frame shown time units after the start, looping like EditorStateFrameAtTime.
+int FixedAnimationFrameAt(const FixedAnimation *animation, int64_t time);
+// Fills one pose per layer for the frame.
+void FixedAnimationPose(const FixedAnimation *animation, int frame, FixedLayerPose *poses);
+
+// The centers of the two end circles of a capsule placed by world.
+void FixedCapsuleCenters(FixedShape capsule, FixedTransform world, FixedVector2 *centers);
+// The same curve as BezierLerp with t in [0, FIXED_ONE].
+FixedVector2 FixedBezierLerp(FixedBezierPoint p0, FixedBezierPoint p1, Fixed t);
+// The point t along the curve of a bezier layer from frame to the next one, placed by world. Returns false if the
+// layer isn't active on both frames, which is when the editor doesn't draw that piece either.
+bool FixedAnimationBezierSample(const FixedAnimation *animation, int layerIdx, int frame, Fixed t, FixedTransform world, FixedVector2 *point);
+
+#endif
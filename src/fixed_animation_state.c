@@ -0,0 +1,213 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "editor_history.h"
+#include "fixed_animation.h"
+#include "fixed_point.h"
+#include "layer.h"
+#include "list.h"
+#include "fixed_animation_state.h"
+
+// What is being converted, only used to name values that don't fit like the compact export does. layer is NULL for
+// frames and frame is -1 for values that aren't per frame.
+typedef struct Converter {
+    const char *layer;
+    int frame;
+    bool valid; // false after the first value that didn't fit. Later values become 0 and aren't reported.
+} Converter;
+
+static void ConvertInvalid(Converter *converter, const char *what, double value) {
+    if (!converter->valid) return;
+    converter->valid = false;
+    printf("The %s %g", what, value);
+    if (converter->layer) printf(" of layer \"%s\"", converter->layer);
+    if (converter->frame >= 0) printf(" on frame %i", converter->frame);
+    printf(" doesn't fit fixed point.\n");
+}
+
+static Fixed ConvertFloat(Converter *converter, float value, const char *what) {
+    if (!isfinite(value) || value < FIXED_FLOAT_MIN || value > FIXED_FLOAT_MAX) {
+        ConvertInvalid(converter, what, value);
+        return 0;
+    }
+    return FixedFromFloat(value);
+}
+
+static Fixed ConvertInt(Converter *converter, int value, const char *what) {
+    if (value < FIXED_FLOAT_MIN || value > FIXED_FLOAT_MAX) {
+        ConvertInvalid(converter, what, value);
+        return 0;
+    }
+    return FixedFromInt(value);
+}
+
+static int32_t ConvertAngle(Converter *converter, float radians, const char *what) {
+    if (!isfinite(radians) || fabsf(radians) > FIXED_RADIANS_MAX) {
+        ConvertInvalid(converter, what, radians);
+        return 0;
+    }
+    return FixedAngleStepsFromRadians(radians);
+}
+
+static FixedVector2 ConvertVector(Converter *converter, Vector2 vector, const char *whatX, const char *whatY) {
+    return (FixedVector2) {ConvertFloat(converter, vector.x, whatX), ConvertFloat(converter, vector.y, whatY)};
+}
+
+// Capsule rotations stay unwrapped until keys are interpolated, see FixedAngleStepsFromRadians.
+typedef struct KeyValue {
+    FixedVector2 position;
+    FixedShape shape;
+    int32_t rotationSteps;
+} KeyValue;
+
+static KeyValue KeyValueFromSample(Converter *converter, LayerSample sample, bool hasShape) {
+    KeyValue value = {.position = ConvertVector(converter, sample.position, "x", "y")};
+    if (!hasShape) return value;
+    Shape shape = sample.shape;
+    value.shape.type = (FixedShapeType) shape.type;
+    switch (shape.type) {
+        case SHAPE_CIRCLE:
+            value.shape.circleRadius = ConvertInt(converter, shape.circleRadius, "radius");
+            break;
+        case SHAPE_RECTANGLE:
+            value.shape.rectangle.rightX = ConvertInt(converter, shape.rectangle.rightX, "rectangle right x");
+            value.shape.rectangle.bottomY = ConvertInt(converter, shape.rectangle.bottomY, "rectangle bottom y");
+            break;
+        case SHAPE_CAPSULE:
+            value.shape.capsule.radius = ConvertInt(converter, shape.capsule.radius, "capsule radius");
+            value.shape.capsule.height = ConvertInt(converter, shape.capsule.height, "capsule height");
+            value.rotationSteps = ConvertAngle(converter, shape.capsule.rotation, "capsule rotation");
+            value.shape.capsule.rotation = (FixedAngle) value.rotationSteps;
+            break;
+    }
+    return value;
+}
+
+// Like LayerKeysBake: sizes are rounded to whole pixels the way the editor rounds them, positions aren't.
+static KeyValue KeyValueLerp(KeyValue a, KeyValue b, int32_t numerator, int32_t denominator, bool hasShape) {
+    KeyValue value = a;
+    value.position.x = FixedLerpRatio(a.position.x, b.position.x, numerator, denominator);
+    value.position.y = FixedLerpRatio(a.position.y, b.position.y, numerator, denominator);
+    if (!hasShape) return value;
+    switch (a.shape.type) {
+        case FIXED_SHAPE_CIRCLE:
+            value.shape.circleRadius = FixedRound(FixedLerpRatio(a.shape.circleRadius, b.shape.circleRadius, numerator, denominator));
+            break;
+        case FIXED_SHAPE_RECTANGLE:
+            value.shape.rectangle.rightX = FixedRound(FixedLerpRatio(a.shape.rectangle.rightX, b.shape.rectangle.rightX, numerator, denominator));
+            value.shape.rectangle.bottomY = FixedRound(FixedLerpRatio(a.shape.rectangle.bottomY, b.shape.rectangle.bottomY, numerator, denominator));
+            break;
+        case FIXED_SHAPE_CAPSULE:
+            value.shape.capsule.radius = FixedRound(FixedLerpRatio(a.shape.capsule.radius, b.shape.capsule.radius, numerator, denominator));
+            value.shape.capsule.height = FixedRound(FixedLerpRatio(a.shape.capsule.height, b.shape.capsule.height, numerator, denominator));
+            value.rotationSteps = FixedLerpRatio(a.rotationSteps, b.rotationSteps, numerator, denominator);
+            value.shape.capsule.rotation = (FixedAngle) value.rotationSteps;
+            break;
+    }
+    return value;
+}
+
+static FixedLayer LayerConvert(Converter *converter, Layer *layer, int frameCount) {
+    converter->layer = layer->name;
+    converter->frame = -1;
+    FixedLayer converted = {
+        .type = (FixedLayerType) layer->type,
+        .parent = layer->parent,
+        .basisX = ConvertVector(converter, layer->transform.x, "basis x.x", "basis x.y"),
+        .basisY = ConvertVector(converter, layer->transform.y, "basis y.x", "basis y.y"),
+        .active = LIST_NEW_SIZED(bool, frameCount),
+        .positions = LIST_NEW_SIZED(FixedVector2, frameCount),
+        .shapes = LIST_NEW(FixedShape),
+        .bezierPoints = LIST_NEW(FixedBezierPoint)
+    };
+    for (int frame = 0; frame < frameCount; frame++) converted.active[frame] = layer->framesActive[frame];
+
+    bool hasShape = LayerShapeBase(layer) != NULL;
+    if (hasShape) {
+        LIST_RESERVE(&converted.shapes, frameCount);
+        LIST_SHRINK(converted.shapes, frameCount);
+    }
+    // The keys are interpolated here instead of converting the samples the editor baked in floats.
+    int keyCount = LIST_COUNT(layer->keys);
+    KeyValue still = KeyValueFromSample(converter, LayerSampleAt(layer, 0), hasShape);
+    int keyIdx = 0;
+    for (int frame = 0; frame < frameCount; frame++) {
+        KeyValue value = still;
+        if (keyCount > 0) {
+            // Values of keys are named by the frame of the key.
+            while (keyIdx < keyCount && layer->keys[keyIdx].frame <= frame) keyIdx++;
+            if (keyIdx == 0) {
+                converter->frame = layer->keys[0].frame;
+                value = KeyValueFromSample(converter, layer->keys[0].value, hasShape);
+            } else if (keyIdx == keyCount) {
+                converter->frame = layer->keys[keyCount - 1].frame;
+                value = KeyValueFromSample(converter, layer->keys[keyCount - 1].value, hasShape);
+            } else {
+                LayerKey *previous = layer->keys + keyIdx - 1;
+                LayerKey *next = layer->keys + keyIdx;
+                converter->frame = previous->frame;
+                KeyValue previousValue = KeyValueFromSample(converter, previous->value, hasShape);
+                converter->frame = next->frame;
+                KeyValue nextValue = KeyValueFromSample(converter, next->value, hasShape);
+                value = KeyValueLerp(previousValue, nextValue, frame - previous->frame, next->frame - previous->frame, hasShape);
+            }
+        }
+        converted.positions[frame] = value.position;
+        if (hasShape) converted.shapes[frame] = value.shape;
+    }
+
+    if (layer->type == LAYER_BEZIER) {
+        LIST_RESERVE(&converted.bezierPoints, frameCount);
+        LIST_SHRINK(converted.bezierPoints, frameCount);
+        for (int frame = 0; frame < frameCount; frame++) {
+            BezierPoint point = layer->bezierPoints[frame];
+            converted.bezierPoints[frame] = (FixedBezierPoint) {0};
+            if (!layer->framesActive[frame]) continue;
+            converter->frame = frame;
+            converted.bezierPoints[frame] = (FixedBezierPoint) {
+                .position = ConvertVector(converter, point.position, "bezier x", "bezier y"),
+                .extentsLeft = ConvertFloat(converter, point.extentsLeft, "bezier left extent"),
+                .extentsRight = ConvertFloat(converter, point.extentsRight, "bezier right extent"),
+                .rotation = (FixedAngle) ConvertAngle(converter, point.rotation, "bezier rotation")
+            };
+        }
+    }
+    return converted;
+}
+
+bool FixedAnimationFromState(EditorState *state, FixedAnimation *out) {
+    Converter converter = {.frame = -1, .valid = true};
+    FixedAnimation animation = {
+        .frameCount = state->frameCount,
+        .layerCount = state->layerCount,
+        .frames = LIST_NEW_SIZED(FixedFrame, state->frameCount),
+        .frameStarts = LIST_NEW_SIZED(int64_t, state->frameCount + 1),
+        .layers = LIST_NEW_SIZED(FixedLayer, state->layerCount),
+        .order = LIST_NEW_SIZED(int, state->layerCount)
+    };
+    animation.frameStarts[0] = 0;
+    for (int i = 0; i < state->frameCount; i++) {
+        FrameInfo frame = state->frames[i];
+        converter.frame = i;
+        animation.frames[i] = (FixedFrame) {
+            .duration = frame.duration,
+            .canCancel = frame.canCancel,
+            .position = ConvertVector(&converter, frame.pos, "x", "y")
+        };
+        animation.frameStarts[i + 1] = animation.frameStarts[i] + frame.duration;
+    }
+    for (int i = 0; i < state->layerCount; i++) animation.layers[i] = LayerConvert(&converter, state->layers + i, state->frameCount);
+
+    bool ordered = EditorStateLayerOrder(state, animation.order);
+    assert(ordered);
+    (void) ordered;
+    if (!converter.valid) {
+        FixedAnimationFree(&animation);
+        return false;
+    }
+    *out = animation;
+    return true;
+}
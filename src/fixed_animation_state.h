@@ -0,0 +1,15 @@
+#ifndef FIXED_ANIMATION_STATE_H
+#define FIXED_ANIMATION_STATE_H
+
+#include <stdbool.h>
+#include "editor_history.h"
+#include "fixed_animation.h"
+
+// Converts an editor state to a FixedAnimation without exporting it first, keeping the positions the compact export
+// rounds to whole pixels. Only the editor side needs this, games load the compact export with fixed_animation.h.
+
+// Expects the layers to have an order, which loaded and edited states always have. Fails naming the first value
+// outside the range of fixed_point.h, like the compact export, and leaves nothing allocated.
+bool FixedAnimationFromState(EditorState *state, FixedAnimation *out);
+
+#endif
@@ -0,0 +1,182 @@
+#include <math.h>
+#include <stdint.h>
+#include "fixed_point.h"
+
+#define FIXED_PI 3.14159265358979323846
+
+// sin(i / 1024 turns) in Q16.16 for i in [0, 256], written out so no libm is involved at runtime.
+static const int32_t sineQuarter[257] = {
+    0, 402, 804, 1206, 1608, 2010, 2412, 2814,
+    3216, 3617, 4019, 4420, 4821, 5222, 5623, 6023,
+    6424, 6824, 7224, 7623, 8022, 8421, 8820, 9218,
+    9616, 10014, 10411, 10808, 11204, 11600, 11996, 12391,
+    12785, 13180, 13573, 13966, 14359, 14751, 15143, 15534,
+    15924, 16314, 16703, 17091, 17479, 17867, 18253, 18639,
+    19024, 19409, 19792, 20175, 20557, 20939, 21320, 21699,
+    22078, 22457, 22834, 23210, 23586, 23961, 24335, 24708,
+    25080, 25451, 25821, 26190, 26558, 26925, 27291, 27656,
+    28020, 28383, 28745, 29106, 29466, 29824, 30182, 30538,
+    30893, 31248, 31600, 31952, 32303, 32652, 33000, 33347,
+    33692, 34037, 34380, 34721, 35062, 35401, 35738, 36075,
+    36410, 36744, 37076, 37407, 37736, 38064, 38391, 38716,
+    39040, 39362, 39683, 40002, 40320, 40636, 40951, 41264,
+    41576, 41886, 42194, 42501, 42806, 43110, 43412, 43713,
+    44011, 44308, 44604, 44898, 45190, 45480, 45769, 46056,
+    46341, 46624, 46906, 47186, 47464, 47741, 48015, 48288,
+    48559, 48828, 49095, 49361, 49624, 49886, 50146, 50404,
+    50660, 50914, 51166, 51417, 51665, 51911, 52156, 52398,
+    52639, 52878, 53114, 53349, 53581, 53812, 54040, 54267,
+    54491, 54714, 54934, 55152, 55368, 55582, 55794, 56004,
+    56212, 56418, 56621, 56823, 57022, 57219, 57414, 57607,
+    57798, 57986, 58172, 58356, 58538, 58718, 58896, 59071,
+    59244, 59415, 59583, 59750, 59914, 60075, 60235, 60392,
+    60547, 60700, 60851, 60999, 61145, 61288, 61429, 61568,
+    61705, 61839, 61971, 62101, 62228, 62353, 62476, 62596,
+    62714, 62830, 62943, 63054, 63162, 63268, 63372, 63473,
+    63572, 63668, 63763, 63854, 63944, 64031, 64115, 64197,
+    64277, 64354, 64429, 64501, 64571, 64639, 64704, 64766,
+    64827, 64884, 64940, 64993, 65043, 65091, 65137, 65180,
+    65220, 65259, 65294, 65328, 65358, 65387, 65413, 65436,
+    65457, 65476, 65492, 65505, 65516, 65525, 65531, 65535,
+    65536
+};
+
+// floor(value / 2^shift) without shifting negative numbers, which C leaves up to the implementation.
+static int64_t FloorShift(int64_t value, int shift) {
+    int64_t divisor = (int64_t) 1 << shift;
+    int64_t quotient = value / divisor; // C99 truncates toward zero.
+    if (value % divisor < 0) quotient--;
+    return quotient;
+}
+
+// Halves round up, so the result doesn't depend on the sign.
+static Fixed RoundShift(int64_t value) {
+    return (Fixed) FloorShift(value + FIXED_HALF, FIXED_SHIFT);
+}
+
+Fixed FixedFromFloat(float value) {
+    return (Fixed) roundf(value * (float) FIXED_ONE);
+}
+
+Fixed FixedFromInt(int value) {
+    return (Fixed) value * FIXED_ONE;
+}
+
+float FixedToFloat(Fixed value) {
+    return (float) value / (float) FIXED_ONE;
+}
+
+Fixed FixedRound(Fixed value) {
+    Fixed whole = ~(FIXED_ONE - 1);
+    return value >= 0 ? (value + FIXED_HALF) & whole : -((-value + FIXED_HALF) & whole);
+}
+
+int32_t FixedAngleStepsFromRadians(float radians) {
+    // Done in double so the single rounding at the end is the only one.
+    return (int32_t) round((double) radians * (FIXED_ANGLE_TURN / (2.0 * FIXED_PI)));
+}
+
+Fixed FixedMul(Fixed a, Fixed b) {
+    return RoundShift((int64_t) a * b);
+}
+
+Fixed FixedLerp(Fixed a, Fixed b, Fixed t) {
+    // In 64 bits until the end since b - a only fits there, the result is between a and b for t in [0, FIXED_ONE].
+    return (Fixed) (a + FloorShift(((int64_t) b - a) * t + FIXED_HALF, FIXED_SHIFT));
+}
+
+Fixed FixedLerpRatio(Fixed a, Fixed b, int32_t numerator, int32_t denominator) {
+    if (denominator < 0) {
+        numerator = -numerator;
+        denominator = -denominator;
+    }
+    // Rounding to nearest is floor((2 * n + d) / (2 * d)).
+    int64_t twice = 2 * ((int64_t) b - a) * numerator + denominator;
+    int64_t quotient = twice / (2 * (int64_t) denominator);
+    if (twice % (2 * (int64_t) denominator) < 0) quotient--;
+    return (Fixed) (a + quotient);
+}
+
+// sin over the first quarter, steps in [0, FIXED_ANGLE_TURN / 4].
+static Fixed SineQuarter(int steps) {
+    int idx = steps >> 6;
+    int fraction = steps & 63;
+    if (fraction == 0) return sineQuarter[idx];
+    // The table only grows over the quarter so the shifted value is never negative.
+    return sineQuarter[idx] + (((sineQuarter[idx + 1] - sineQuarter[idx]) * fraction + 32) >> 6);
+}
+
+Fixed FixedSin(FixedAngle angle) {
+    int quarter = FIXED_ANGLE_TURN / 4;
+    int steps = angle % quarter;
+    switch (angle / quarter) {
+        case 0: return SineQuarter(steps);
+        case 1: return SineQuarter(quarter - steps);
+        case 2: return -SineQuarter(steps);
+        default: return -SineQuarter(quarter - steps);
+    }
+}
+
+Fixed FixedCos(FixedAngle angle) {
+    return FixedSin((FixedAngle) (angle + FIXED_ANGLE_TURN / 4));
+}
+
+FixedVector2 FixedVector2Add(FixedVector2 a, FixedVector2 b) {
+    return (FixedVector2) {a.x + b.x, a.y + b.y};
+}
+
+FixedVector2 FixedVector2Lerp(FixedVector2 a, FixedVector2 b, Fixed t) {
+    return (FixedVector2) {FixedLerp(a.x, b.x, t), FixedLerp(a.y, b.y, t)};
+}
+
+FixedVector2 FixedVector2Rotate(FixedVector2 vector, FixedAngle angle) {
+    int64_t cosine = FixedCos(angle);
+    int64_t sine = FixedSin(angle);
+    return (FixedVector2) {
+        .x = RoundShift(vector.x * cosine - vector.y * sine),
+        .y = RoundShift(vector.x * sine + vector.y * cosine)
+    };
+}
+
+FixedTransform FixedTransformIdentity(void) {
+    return (FixedTransform) {
+        .o = {0, 0},
+        .x = {FIXED_ONE, 0},
+        .y = {0, FIXED_ONE}
+    };
+}
+
+FixedTransform FixedTransformFromPosition(FixedVector2 position) {
+    FixedTransform transform = FixedTransformIdentity();
+    transform.o = position;
+    return transform;
+}
+
+FixedTransform FixedTransformFromRotation(FixedAngle angle) {
+    Fixed cosine = FixedCos(angle);
+    Fixed sine = FixedSin(angle);
+    return (FixedTransform) {
+        .o = {0, 0},
+        .x = {cosine, sine},
+        .y = {-sine, cosine}
+    };
+}
+
+// Each component sums its products before the one rounding, like Transform2DMultiply does in floats.
+FixedTransform FixedTransformMultiply(FixedTransform a, FixedTransform b) {
+    return (FixedTransform) {
+        .x.x = RoundShift((int64_t) a.x.x * b.x.x + (int64_t) a.y.x * b.x.y),
+        .x.y = RoundShift((int64_t) a.x.y * b.x.x + (int64_t) a.y.y * b.x.y),
+        .y.x = RoundShift((int64_t) a.x.x * b.y.x + (int64_t) a.y.x * b.y.y),
+        .y.y = RoundShift((int64_t) a.x.y * b.y.x + (int64_t) a.y.y * b.y.y),
+        .o.x = RoundShift((int64_t) a.x.x * b.o.x + (int64_t) a.y.x * b.o.y) + a.o.x,
+        .o.y = RoundShift((int64_t) a.x.y * b.o.x + (int64_t) a.y.y * b.o.y) + a.o.y
+    };
+}
+
+FixedVector2 FixedTransformToGlobal(FixedTransform transform, FixedVector2 vector) {
+    return (FixedVector2) {
+        .x = RoundShift((int64_t) transform.x.x * vector.x + (int64_t) transform.y.x * vector.y) + transform.o.x,
+        .y = RoundShift((int64_t) transform.x.y * vector.x + (int64_t) transform.y.y * vector.y) + transform.o.y
+    };
+}
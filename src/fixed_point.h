@@ -0,0 +1,65 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+#define FIXED_SHIFT 16
+#define FIXED_ONE ((Fixed) 1 << FIXED_SHIFT)
+#define FIXED_HALF ((Fixed) 1 << (FIXED_SHIFT - 1))
+#define FIXED_ANGLE_TURN 65536 // FixedAngle steps in a full turn.
+// The floats that can be converted: values within the compact export's range and angles of up to 16384 turns.
+#define FIXED_FLOAT_MIN ((float) INT16_MIN)
+#define FIXED_FLOAT_MAX ((float) INT16_MAX)
+#define FIXED_RADIANS_MAX (16384.0f * 6.28318530718f)
+
+// Q16.16 math for evaluating animations the same way on every machine, for rollback netcode that has to re-simulate
+// ticks bit for bit. Only integer operations with fully defined results are used: no floats, no shifts of negative
+// numbers and no libm, so the compiler, its flags and the platform can't change a result. Values must stay within
+// +-32768 (pixels) like the compact export's. Floats are only converted once, when an animation is loaded.
+typedef int32_t Fixed;
+// 1/65536 of a turn, counterclockwise like the radians of the editor. The same unit as the compact export's angles.
+typedef uint16_t FixedAngle;
+
+typedef struct FixedVector2 {
+    Fixed x;
+    Fixed y;
+} FixedVector2;
+
+// The fixed point version of Transform2D, with the same conventions.
+typedef struct FixedTransform {
+    FixedVector2 o;
+    FixedVector2 x;
+    FixedVector2 y;
+} FixedTransform;
+
+// Round to nearest. Rounding is exact in IEEE 754 so the same float always gives the same Fixed. Expects values
+// between FIXED_FLOAT_MIN and FIXED_FLOAT_MAX, and the same for the ints.
+Fixed FixedFromFloat(float value);
+Fixed FixedFromInt(int value);
+float FixedToFloat(Fixed value); // For drawing and tests, never for feeding results back.
+Fixed FixedRound(Fixed value); // To the nearest whole number, halves away from zero like roundf.
+// Radians without wrapping so lerping between two of them turns the same way as lerping the floats would. Expects
+// them within FIXED_RADIANS_MAX either way.
+int32_t FixedAngleStepsFromRadians(float radians);
+
+Fixed FixedMul(Fixed a, Fixed b); // Rounded to nearest.
+Fixed FixedLerp(Fixed a, Fixed b, Fixed t); // t in [0, FIXED_ONE], any a and b.
+// a + (b - a) * numerator / denominator rounded to nearest, for stepping between keys without a rounded t. The ratio
+// has to be in [0, 1] as well.
+Fixed FixedLerpRatio(Fixed a, Fixed b, int32_t numerator, int32_t denominator);
+
+// From a table of a quarter turn with 256 steps, linearly interpolated. Within 1.2 / 65536 of the exact value.
+Fixed FixedSin(FixedAngle angle);
+Fixed FixedCos(FixedAngle angle);
+
+FixedVector2 FixedVector2Add(FixedVector2 a, FixedVector2 b);
+FixedVector2 FixedVector2Lerp(FixedVector2 a, FixedVector2 b, Fixed t);
+FixedVector2 FixedVector2Rotate(FixedVector2 vector, FixedAngle angle);
+
+FixedTransform FixedTransformIdentity(void);
+FixedTransform FixedTransformFromPosition(FixedVector2 position);
+FixedTransform FixedTransformFromRotation(FixedAngle angle);
+FixedTransform FixedTransformMultiply(FixedTransform a, FixedTransform b);
+FixedVector2 FixedTransformToGlobal(FixedTransform transform, FixedVector2 vector);
+
+#endif
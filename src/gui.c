@@ -1,13 +1,17 @@
 #include <assert.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "raylib.h"
 #include "raygui.h"
 
+#include "arena.h"
 #include "list.h"
 #include "string_buffer.h"
+#include "text_cache.h"
 
 #include "gui.h"
 
@@ -31,8 +35,103 @@ DrawCommand DrawCommandString(Vector2 pos, char *text, Font *font, int fontSize,
     };
 }
 
+DrawCommand DrawCommandInteger(Vector2 pos, int integer, Font *font, int fontSize, Color color) {
+    return (DrawCommand) {
+        .type = DRAW_COMMAND_INTEGER,
+        .string.pos = pos,
+        .string.integer = integer,
+        .string.font = font,
+        .string.fontSize = fontSize,
+        .string.color = color
+    };
+}
+
+DrawCommand DrawCommandCircle(Vector2 center, float radius, Color color) {
+    return (DrawCommand) {
+        .type = DRAW_COMMAND_CIRCLE,
+        .shape.center = center,
+        .shape.radius = {radius, radius},
+        .shape.color = color
+    };
+}
+
+DrawCommand DrawCommandRhombus(Vector2 center, float xSize, float ySize, Color color) {
+    return (DrawCommand) {
+        .type = DRAW_COMMAND_RHOMBUS,
+        .shape.center = center,
+        .shape.radius = {xSize, ySize},
+        .shape.color = color
+    };
+}
+
+unsigned long long DrawCommandKey(int layer, DrawKind kind, unsigned int texture, unsigned int sequence) {
+    return ((unsigned long long) layer << DRAW_KEY_LAYER_SHIFT)
+        | ((unsigned long long) kind << DRAW_KEY_KIND_SHIFT)
+        | (((unsigned long long) texture & DRAW_KEY_TEXTURE_MASK) << DRAW_KEY_TEXTURE_SHIFT)
+        | ((unsigned long long) sequence & DRAW_KEY_SEQUENCE_MASK);
+}
+
+static int DrawCommandCompare(const void *a, const void *b) {
+    unsigned long long keyA = ((const DrawCommand *) a)->key;
+    unsigned long long keyB = ((const DrawCommand *) b)->key;
+    return (keyA > keyB) - (keyA < keyB);
+}
+
+void DrawCommandsDraw(LIST(DrawCommand) commands, TextCache *textCache) {
+    // Every key holds a unique sequence number so qsort ends up stable.
+    qsort(commands, LIST_COUNT(commands), sizeof(DrawCommand), DrawCommandCompare);
+    
+    for (int i = 0; i < LIST_COUNT(commands); i++) {
+        DrawCommand *command = commands + i;
+        switch (command->type) {
+            case DRAW_COMMAND_RECT:
+                DrawRectangleRec(command->rect.bounds, command->rect.color);
+                break;
+            case DRAW_COMMAND_STRING:
+            case DRAW_COMMAND_INTEGER: {
+                Font font = *command->string.font;
+                float fontSize = (float) command->string.fontSize;
+                float spacing = fontSize / (float) font.baseSize;
+                TextRun run = command->type == DRAW_COMMAND_STRING
+                    ? TextCacheGet(textCache, font, fontSize, spacing, command->string.text)
+                    : TextCacheGetInteger(textCache, font, fontSize, spacing, command->string.integer);
+                TextCacheDraw(textCache, font, run, command->string.pos, command->string.color);
+            } break;
+            case DRAW_COMMAND_CIRCLE:
+                DrawCircleV(command->shape.center, command->shape.radius.x, command->shape.color);
+                break;
+            case DRAW_COMMAND_RHOMBUS:
+                DrawRhombus(command->shape.center, command->shape.radius.x, command->shape.radius.y, command->shape.color);
+                break;
+        }
+    }
+}
+
+void DrawRhombus(Vector2 pos, float xSize, float ySize, Color color) {
+    Vector2 topPoint = {pos.x, pos.y - ySize};
+    Vector2 leftPoint = {pos.x - xSize, pos.y};
+    Vector2 rightPoint = {pos.x + xSize, pos.y};
+    Vector2 bottomPoint = {pos.x, pos.y + ySize};
+    DrawTriangle(rightPoint, topPoint, leftPoint, color); // must be in counterclockwise order
+    DrawTriangle(leftPoint, bottomPoint, rightPoint, color);
+}
+
+static unsigned int DrawCommandTexture(DrawCommand command) {
+    bool text = command.type == DRAW_COMMAND_STRING || command.type == DRAW_COMMAND_INTEGER;
+    return text ? command.string.font->texture.id : 0;
+}
+
+static void WindowPush(Window *window, DrawKind kind, DrawCommand command) {
+    WindowManager *manager = window->manager;
+    int layer = (int) (window - manager->windows) + 1;
+    command.key = DrawCommandKey(layer, kind, DrawCommandTexture(command), manager->commandSequence++);
+    LIST_ADD(&manager->commands, command);
+}
+
 static int WindowMeasureText(Window *window, char *text) {
-    return (int) MeasureTextEx(*window->theme->font, text, window->theme->fontSize, window->theme->fontSize / window->theme->font->baseSize).x;
+    Font font = *window->theme->font;
+    float fontSize = (float) window->theme->fontSize;
+    return (int) TextCacheGet(window->manager->textCache, font, fontSize, fontSize / (float) font.baseSize, text).size.x;
 }
 
 bool WindowButton(Window *window, char *text, ButtonTheme *theme) {
@@ -71,8 +170,8 @@ bool WindowButton(Window *window, char *text, ButtonTheme *theme) {
         }
     }
     
-    LIST_ADD(&m->commands, DrawCommandRect(rect, colorRect));
-    LIST_ADD(&m->commands, DrawCommandString(textPos, strdup(text), window->theme->font, window->theme->fontSize, colorText));
+    WindowPush(window, DRAW_KIND_RECT, DrawCommandRect(rect, colorRect));
+    WindowPush(window, DRAW_KIND_TEXT, DrawCommandString(textPos, ArenaStringCopy(&m->frameArena, text), window->theme->font, window->theme->fontSize, colorText));
     
     return pressed;
 }
@@ -140,15 +239,15 @@ static void WindowField(Window *window, char *text, bool *enabled, FieldTheme *t
     
     DrawCommand textCmd = DrawCommandString(
         textPos, 
-        strdup(text),
+        ArenaStringCopy(&m->frameArena, text),
         window->theme->font, 
         window->theme->fontSize,
         fontColor
     );
     
-    LIST_ADD(&m->commands, DrawCommandRect(rect, color));
-    LIST_ADD(&m->commands, DrawCommandRect(fieldRect, fieldColor));
-    LIST_ADD(&m->commands, textCmd);
+    WindowPush(window, DRAW_KIND_RECT, DrawCommandRect(rect, color));
+    WindowPush(window, DRAW_KIND_RECT, DrawCommandRect(fieldRect, fieldColor));
+    WindowPush(window, DRAW_KIND_TEXT, textCmd);
 
 }
 
@@ -190,14 +289,16 @@ WindowManager WindowManagerNew() {
     return (WindowManager) {
         .windows = LIST_NEW(Window),
         .commands = LIST_NEW(DrawCommand),
-        .commandsAll = LIST_NEW(DrawCommand)
+        .textCache = TextCacheNew(),
+        .frameArena = ArenaNew(GUI_ARENA_BLOCK_SIZE)
     };
 }
 
 void WindowManagerFree(WindowManager *manager) {
     LIST_FREE(manager->windows);
     LIST_FREE(manager->commands);
-    LIST_FREE(manager->commandsAll);
+    TextCacheFree(manager->textCache);
+    ArenaFree(&manager->frameArena);
 }
 
 void WindowManagerAddWindow(WindowManager *manager, char *title, WindowTheme *theme, Vector2 pos, int id) {
@@ -213,7 +314,9 @@ void WindowManagerAddWindow(WindowManager *manager, char *title, WindowTheme *th
 
 void WindowManagerStart(WindowManager *manager) {
     LIST_SHRINK(manager->commands, 0);
-    LIST_SHRINK(manager->commandsAll, 0);
+    manager->commandSequence = 0;
+    // The list keeps its capacity and the arena keeps its block, so a frame like the last one doesn't allocate.
+    ArenaReset(&manager->frameArena);
 
     manager->windowIdx = 0;
 
@@ -223,6 +326,11 @@ void WindowManagerStart(WindowManager *manager) {
     manager->mouseDown = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
 }
 
+void WindowManagerPush(WindowManager *manager, DrawKind kind, DrawCommand command) {
+    command.key = DrawCommandKey(0, kind, DrawCommandTexture(command), manager->commandSequence++);
+    LIST_ADD(&manager->commands, command);
+}
+
 Window *WindowManagerNext(WindowManager *manager) {
     if (manager->windowIdx != 0) {
         Window *windowPrevious = manager->windows + manager->windowIdx - 1;
@@ -249,12 +357,10 @@ Window *WindowManagerNext(WindowManager *manager) {
             windowPrevious->rect.height - titleRect.height
         };
         
-        LIST_ADD(&manager->commandsAll, DrawCommandRect(titleRect, windowPrevious->theme->titleColor));
-        LIST_ADD(&manager->commandsAll, DrawCommandString(titlePos, strdup(windowPrevious->title), windowPrevious->theme->font, windowPrevious->theme->fontSize, windowPrevious->theme->fontColor));
-        LIST_ADD(&manager->commandsAll, DrawCommandRect(bodyRect, windowPrevious->theme->bodyColor));
-        LIST_ADD_MANY(&manager->commandsAll, manager->commands);
-
-        LIST_SHRINK(manager->commands, 0);
+        // Queued after the window's contents but sorted under them by their kind.
+        WindowPush(windowPrevious, DRAW_KIND_BACKGROUND, DrawCommandRect(titleRect, windowPrevious->theme->titleColor));
+        WindowPush(windowPrevious, DRAW_KIND_TEXT, DrawCommandString(titlePos, ArenaStringCopy(&manager->frameArena, windowPrevious->title), windowPrevious->theme->font, windowPrevious->theme->fontSize, windowPrevious->theme->fontColor));
+        WindowPush(windowPrevious, DRAW_KIND_BACKGROUND, DrawCommandRect(bodyRect, windowPrevious->theme->bodyColor));
     }
 
     if (manager->windowIdx >= LIST_COUNT(manager->windows)) return NULL;
@@ -268,23 +374,5 @@ Window *WindowManagerNext(WindowManager *manager) {
 }
 
 void WindowManagerEnd(WindowManager *manager) {
-    for (int i = 0; i < LIST_COUNT(manager->commandsAll); i++) {
-        DrawCommand *command = manager->commandsAll + i;
-        switch (command->type) {
-            case DRAW_COMMAND_RECT:
-                DrawRectangleRec(command->rect.bounds, command->rect.color);
-                break;
-            case DRAW_COMMAND_STRING:
-                DrawTextEx(
-                    *command->string.font,
-                    command->string.text, 
-                    command->string.pos, 
-                    command->string.fontSize,
-                    ((float) command->string.fontSize / (float) command->string.font->baseSize),
-                    command->string.color
-                );
-                free(command->string.text);
-                break;
-        }
-    }
+    DrawCommandsDraw(manager->commands, manager->textCache);
 }
@@ -3,19 +3,46 @@
 
 #include "raylib.h"
 
+#include "arena.h"
 #include "list.h"
+#include "string_buffer.h"
+#include "text_cache.h"
+
+#define GUI_ARENA_BLOCK_SIZE 4096
+
+// Commands are queued for the whole frame and drawn sorted by a key so that things sharing a texture end up next to
+// each other and raylib can put them into one batch. From the most to the least significant bits the key holds:
+// the layer (0 for things queued outside of windows, then windows in the order they were added), the kind (backgrounds, then rects, then text), the texture id and
+// the order the command was queued in, which keeps the sort stable.
+#define DRAW_KEY_LAYER_SHIFT 48
+#define DRAW_KEY_KIND_SHIFT 44
+#define DRAW_KEY_TEXTURE_SHIFT 24
+#define DRAW_KEY_TEXTURE_MASK 0xFFFFFull
+#define DRAW_KEY_SEQUENCE_MASK 0xFFFFFFull
+
+typedef enum DrawKind {
+    DRAW_KIND_BACKGROUND, // window title bars and bodies
+    DRAW_KIND_RECT, // and every other shape
+    DRAW_KIND_TEXT
+} DrawKind;
 
 typedef struct DrawCommand {
+    unsigned long long key;
+    
     // Ideally this would be vertex information and texture handles but we'll just do this for now
     enum {
         DRAW_COMMAND_RECT,
-        DRAW_COMMAND_STRING
+        DRAW_COMMAND_STRING,
+        DRAW_COMMAND_INTEGER, // Uses string with the number instead of text.
+        DRAW_COMMAND_CIRCLE,
+        DRAW_COMMAND_RHOMBUS
     } type;
 
     union {
         struct {
             Vector2 pos;
-            char *text;
+            char *text; // Lives in the window manager's frame arena.
+            int integer;
             Font *font;
             int fontSize;
             Color color;
@@ -25,6 +52,12 @@ typedef struct DrawCommand {
             Rectangle bounds;
             Color color;
         } rect;
+
+        struct {
+            Vector2 center;
+            Vector2 radius; // Circles only use x.
+            Color color;
+        } shape;
     };
 } DrawCommand;
 
@@ -69,8 +102,10 @@ struct Window;
 
 typedef struct WindowManager {
     LIST(struct Window) windows;
-    LIST(DrawCommand) commands; // window's current commands
-    LIST(DrawCommand) commandsAll; // all commands
+    LIST(DrawCommand) commands; // Render queue for the frame. Drawn sorted by key in WindowManagerEnd.
+    unsigned int commandSequence;
+    TextCache *textCache; // Measures and lays out the text of every widget.
+    Arena frameArena; // Memory that only lasts until the next WindowManagerStart, like the text of draw commands.
 
     bool mousePresent;
     Vector2 mousePos;
@@ -97,7 +132,13 @@ typedef struct Window {
 
 DrawCommand DrawCommandRect(Rectangle rect, Color color);
 DrawCommand DrawCommandString(Vector2 pos, char *text, Font *font, int fontSize, Color color);
-void DrawCommandsDraw(LIST(DrawCommand) commands);
+DrawCommand DrawCommandInteger(Vector2 pos, int integer, Font *font, int fontSize, Color color);
+DrawCommand DrawCommandCircle(Vector2 center, float radius, Color color);
+DrawCommand DrawCommandRhombus(Vector2 center, float xSize, float ySize, Color color);
+unsigned long long DrawCommandKey(int layer, DrawKind kind, unsigned int texture, unsigned int sequence);
+// Sorts the commands by key and draws them. Text is laid out through the cache.
+void DrawCommandsDraw(LIST(DrawCommand) commands, TextCache *textCache);
+void DrawRhombus(Vector2 pos, float xSize, float ySize, Color color);
 
 bool WindowButton(Window *window, char *text, ButtonTheme *theme);
 void WindowFieldText(Window *window, StringBuffer *buffer, bool *enabled, FieldTheme *theme);
@@ -107,6 +148,8 @@ WindowManager WindowManagerNew();
 void WindowManagerFree(WindowManager *manager);
 void WindowManagerAddWindow(WindowManager *manager, char *title, WindowTheme *theme, Vector2 pos, int id);
 void WindowManagerStart(WindowManager *manager);
+// Queues a command that isn't part of a window. Those are drawn under every window.
+void WindowManagerPush(WindowManager *manager, DrawKind kind, DrawCommand command);
 Window *WindowManagerNext(WindowManager *manager);
 void WindowManagerEnd(WindowManager *manager);
 
@@ -0,0 +1,183 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "editor_history.h"
+#include "hash.h"
+#include "layer.h"
+#include "layer_hierarchy.h"
+#include "handle_grid.h"
+
+HandleGrid HandleGridNew(void) {
+    return (HandleGrid) {
+        .entries = NULL,
+        .sources = NULL,
+        .layerCount = -1,
+        .buckets = NULL,
+        .bucketCount = 0
+    };
+}
+
+void HandleGridFree(HandleGrid *grid) {
+    free(grid->entries);
+    free(grid->sources);
+    free(grid->buckets);
+    *grid = HandleGridNew();
+}
+
+static int CellBucket(HandleGrid *grid, int cellX, int cellY) {
+    int cell[2] = {cellX, cellY};
+    return (int) (HashBytes(HASH_SEED, cell, sizeof(cell)) & (uint64_t) (grid->bucketCount - 1));
+}
+
+static int PosBucket(HandleGrid *grid, Vector2 pos) {
+    return CellBucket(grid, (int) floorf(pos.x / HANDLE_GRID_CELL_SIZE), (int) floorf(pos.y / HANDLE_GRID_CELL_SIZE));
+}
+
+static void EntryUnlink(HandleGrid *grid, int entryIdx) {
+    int *link = grid->buckets + grid->entries[entryIdx].bucket;
+    while (*link != entryIdx) link = &grid->entries[*link].next;
+    *link = grid->entries[entryIdx].next;
+}
+
+static void EntrySet(HandleGrid *grid, int entryIdx, Vector2 pos, Handle handle) {
+    HandleGridEntry *entry = grid->entries + entryIdx;
+    if (entry->handle == handle && (handle == HANDLE_NONE || (entry->pos.x == pos.x && entry->pos.y == pos.y))) return;
+
+    if (entry->handle != HANDLE_NONE) EntryUnlink(grid, entryIdx);
+    entry->pos = pos;
+    entry->handle = handle;
+    if (handle == HANDLE_NONE) return;
+    entry->bucket = PosBucket(grid, pos);
+    entry->next = grid->buckets[entry->bucket];
+    grid->buckets[entry->bucket] = entryIdx;
+}
+
+static HandleGridSource SourceGet(Layer *layer, int frame, Transform2D world, bool selected) {
+    HandleGridSource source = {.shown = selected && layer->framesActive[frame]};
+    if (!source.shown) return source;
+    source.type = layer->type;
+    source.world = world;
+    if (LayerShapeBase(layer)) source.shape = LayerSampleAt(layer, frame).shape;
+    if (layer->type == LAYER_HITBOX) {
+        source.knockbackX = layer->hitbox.knockbackX;
+        source.knockbackY = layer->hitbox.knockbackY;
+    }
+    if (layer->type == LAYER_BEZIER) source.bezierPoint = layer->bezierPoints[frame];
+    return source;
+}
+
+static bool SourceEqual(HandleGridSource *a, HandleGridSource *b) {
+    if (a->shown != b->shown) return false;
+    if (!a->shown) return true;
+    if (a->type != b->type || memcmp(&a->world, &b->world, sizeof(Transform2D)) != 0) return false;
+    switch (a->type) {
+        case LAYER_HITBOX:
+            return a->knockbackX == b->knockbackX && a->knockbackY == b->knockbackY && ShapeEqual(a->shape, b->shape);
+        case LAYER_SHAPE:
+            return ShapeEqual(a->shape, b->shape);
+        case LAYER_EMPTY:
+            return true;
+        case LAYER_BEZIER:
+            return memcmp(&a->bezierPoint, &b->bezierPoint, sizeof(BezierPoint)) == 0;
+    }
+    assert(false);
+    return false;
+}
+
+int HandleGridUpdate(HandleGrid *grid, EditorState *state, LayerHierarchy *hierarchy, const bool *selected) {
+    int slotCount = (state->layerCount + 1) * LAYER_HANDLES_MAX;
+    bool rebuild = grid->layerCount != state->layerCount;
+    if (rebuild) {
+        grid->layerCount = state->layerCount;
+        grid->entries = realloc(grid->entries, sizeof(HandleGridEntry) * slotCount);
+        for (int i = 0; i < slotCount; i++) grid->entries[i].handle = HANDLE_NONE;
+        grid->sources = realloc(grid->sources, sizeof(HandleGridSource) * (state->layerCount > 0 ? state->layerCount : 1));
+
+        int bucketCount = HANDLE_GRID_BUCKETS_MINIMUM;
+        while (bucketCount < 2 * slotCount) bucketCount *= 2;
+        grid->bucketCount = bucketCount;
+        grid->buckets = realloc(grid->buckets, sizeof(int) * bucketCount);
+        for (int i = 0; i < bucketCount; i++) grid->buckets[i] = -1;
+    }
+
+    Vector2 positions[LAYER_HANDLES_MAX];
+    Handle handles[LAYER_HANDLES_MAX];
+    int updated = 0;
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Layer *layer = state->layers + layerIdx;
+        Transform2D world = LayerHierarchyWorld(hierarchy, layerIdx);
+        HandleGridSource source = SourceGet(layer, state->frameIdx, world, selected[layerIdx]);
+        if (!rebuild && SourceEqual(&source, grid->sources + layerIdx)) continue;
+        grid->sources[layerIdx] = source;
+        updated++;
+
+        int count = source.shown ? LayerHandles(layer, state->frameIdx, world, positions, handles) : 0;
+        for (int i = 0; i < LAYER_HANDLES_MAX; i++) {
+            EntrySet(grid, layerIdx * LAYER_HANDLES_MAX + i, i < count ? positions[i] : VECTOR2_ZERO, i < count ? handles[i] : HANDLE_NONE);
+        }
+    }
+    // HANDLE_CENTER just marks the slot as used, the caller knows it is the frame position from the layer index.
+    EntrySet(grid, state->layerCount * LAYER_HANDLES_MAX, state->frames[state->frameIdx].pos, HANDLE_CENTER);
+    return updated;
+}
+
+typedef struct PickBest {
+    int entry;
+    int rank;
+    float distance;
+} PickBest;
+
+// Ranked by the frame position, then the preferred layer, then distance, then slot order within a layer.
+static void BucketPick(HandleGrid *grid, int bucket, Vector2 pos, float radius, int preferredLayer, PickBest *best) {
+    for (int entryIdx = grid->buckets[bucket]; entryIdx >= 0; entryIdx = grid->entries[entryIdx].next) {
+        HandleGridEntry *entry = grid->entries + entryIdx;
+        float dx = entry->pos.x - pos.x;
+        float dy = entry->pos.y - pos.y;
+        float distance = dx * dx + dy * dy;
+        if (distance > radius * radius) continue;
+
+        int layerIdx = entryIdx / LAYER_HANDLES_MAX;
+        int rank = layerIdx == grid->layerCount ? 0 : layerIdx == preferredLayer ? 1 : 2;
+        if (best->entry >= 0) {
+            if (rank != best->rank) {
+                if (rank > best->rank) continue;
+            } else if (distance != best->distance) {
+                if (distance > best->distance) continue;
+            } else if (entryIdx > best->entry) {
+                continue;
+            }
+        }
+        *best = (PickBest) {.entry = entryIdx, .rank = rank, .distance = distance};
+    }
+}
+
+bool HandleGridPick(HandleGrid *grid, Vector2 pos, float radius, int preferredLayer, HandleGridHit *hit) {
+    if (grid->layerCount < 0) return false;
+
+    int cellXStart = (int) floorf((pos.x - radius) / HANDLE_GRID_CELL_SIZE);
+    int cellXEnd = (int) floorf((pos.x + radius) / HANDLE_GRID_CELL_SIZE);
+    int cellYStart = (int) floorf((pos.y - radius) / HANDLE_GRID_CELL_SIZE);
+    int cellYEnd = (int) floorf((pos.y + radius) / HANDLE_GRID_CELL_SIZE);
+
+    PickBest best = {.entry = -1};
+    if ((long) (cellXEnd - cellXStart + 1) * (cellYEnd - cellYStart + 1) > grid->bucketCount) {
+        // Zoomed far out the radius covers more cells than there are buckets, so walk every bucket once instead.
+        for (int bucket = 0; bucket < grid->bucketCount; bucket++) BucketPick(grid, bucket, pos, radius, preferredLayer, &best);
+    } else {
+        // Cells sharing a bucket walk it twice, which can't change the result.
+        for (int cellY = cellYStart; cellY <= cellYEnd; cellY++) {
+            for (int cellX = cellXStart; cellX <= cellXEnd; cellX++) {
+                BucketPick(grid, CellBucket(grid, cellX, cellY), pos, radius, preferredLayer, &best);
+            }
+        }
+    }
+    if (best.entry < 0) return false;
+
+    int layerIdx = best.entry / LAYER_HANDLES_MAX;
+    hit->layerIdx = layerIdx == grid->layerCount ? HANDLE_GRID_FRAME_POS : layerIdx;
+    hit->handle = grid->entries[best.entry].handle;
+    return true;
+}
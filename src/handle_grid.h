@@ -0,0 +1,59 @@
+#ifndef HANDLE_GRID_H
+#define HANDLE_GRID_H
+
+#include <stdbool.h>
+#include "raylib.h"
+#include "editor_history.h"
+#include "layer.h"
+#include "layer_hierarchy.h"
+
+#define HANDLE_GRID_CELL_SIZE 32.0f // Sprite pixels.
+#define HANDLE_GRID_BUCKETS_MINIMUM 64
+#define HANDLE_GRID_FRAME_POS -1 // layerIdx of the frame position handle.
+
+// Spatial hash of every handle shown on the current frame, in sprite space so panning and zooming don't touch it.
+// Each layer owns LAYER_HANDLES_MAX entry slots and the frame position handle owns the slot after the layers.
+// Like the layer hierarchy, updating compares what each layer's handles are made of with the last update and only
+// recomputes the layers that differ, then only moves the entries whose position or handle changed. An unchanged
+// state costs one comparison per layer and dragging one handle re-buckets one entry.
+typedef struct HandleGridEntry {
+    Vector2 pos;
+    Handle handle; // HANDLE_NONE for unused slots, which aren't in any bucket.
+    int bucket;
+    int next; // Next entry in the same bucket or -1.
+} HandleGridEntry;
+
+// What a layer's handles are made of on a frame.
+typedef struct HandleGridSource {
+    bool shown; // The rest is only set when the layer is active and selected.
+    LayerType type;
+    Transform2D world;
+    Shape shape;
+    int knockbackX;
+    int knockbackY;
+    BezierPoint bezierPoint;
+} HandleGridSource;
+
+typedef struct HandleGrid {
+    HandleGridEntry *entries;
+    HandleGridSource *sources; // One per layer.
+    int layerCount; // Layers the slots were made for. A different count rebuilds everything.
+    int *buckets; // First entry of each bucket or -1. Power of 2 long.
+    int bucketCount;
+} HandleGrid;
+
+typedef struct HandleGridHit {
+    int layerIdx; // HANDLE_GRID_FRAME_POS for the frame position.
+    Handle handle;
+} HandleGridHit;
+
+HandleGrid HandleGridNew(void);
+void HandleGridFree(HandleGrid *grid);
+// Expects the hierarchy to be up to date with the state on the current frame. Only the handles of selected layers
+// are added, the same ones LayerDraw draws. Returns how many layers were recomputed.
+int HandleGridUpdate(HandleGrid *grid, EditorState *state, LayerHierarchy *hierarchy, const bool *selected);
+// Finds the handle closest to pos within radius. Handles of preferredLayer win over the rest so overlapping
+// layers keep picking the selected one. Returns false if there is none.
+bool HandleGridPick(HandleGrid *grid, Vector2 pos, float radius, int preferredLayer, HandleGridHit *hit);
+
+#endif
@@ -0,0 +1,21 @@
+#include <stddef.h>
+#include <stdint.h>
+#include "hash.h"
+
+uint64_t HashBytes(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= HASH_PRIME;
+    }
+    return hash;
+}
+
+uint64_t HashString(const char *str) {
+    uint64_t hash = HASH_SEED;
+    for (const unsigned char *c = (const unsigned char *) str; *c; c++) {
+        hash ^= *c;
+        hash *= HASH_PRIME;
+    }
+    return hash;
+}
@@ -0,0 +1,15 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 64 bit FNV-1a. Fast on short keys like names and not meant to resist attacks.
+#define HASH_SEED 14695981039346656037ULL
+#define HASH_PRIME 1099511628211ULL
+
+// Continues hash over more data. Start with HASH_SEED.
+uint64_t HashBytes(uint64_t hash, const void *data, size_t size);
+uint64_t HashString(const char *str);
+
+#endif
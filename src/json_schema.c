@@ -0,0 +1,52 @@
+#include <assert.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "cJSON.h"
+#include "hash.h"
+#include "json_schema.h"
+
+static uint64_t HashKey(const char *key) {
+    uint64_t hash = HASH_SEED;
+    for (const unsigned char *c = (const unsigned char *) key; *c; c++) {
+        hash ^= (unsigned char) tolower(*c);
+        hash *= HASH_PRIME;
+    }
+    return hash;
+}
+
+static bool KeyEquals(const char *a, const char *b) {
+    for (; *a && *b; a++, b++) {
+        if (tolower((unsigned char) *a) != tolower((unsigned char) *b)) return false;
+    }
+    return *a == *b;
+}
+
+void JsonSchemaInit(JsonSchema *schema, const char *const *keys, int keyCount) {
+    assert(keyCount * 2 <= JSON_SCHEMA_SLOTS);
+    schema->keys = keys;
+    schema->keyCount = keyCount;
+    memset(schema->slots, -1, sizeof(schema->slots));
+    for (int i = 0; i < keyCount; i++) {
+        int slot = (int) (HashKey(keys[i]) & (JSON_SCHEMA_SLOTS - 1));
+        while (schema->slots[slot] >= 0) slot = (slot + 1) & (JSON_SCHEMA_SLOTS - 1);
+        schema->slots[slot] = (signed char) i;
+    }
+}
+
+void JsonSchemaRead(const JsonSchema *schema, const cJSON *object, cJSON **fields) {
+    for (int i = 0; i < schema->keyCount; i++) fields[i] = NULL;
+    if (!cJSON_IsObject(object)) return;
+    
+    for (cJSON *child = object->child; child; child = child->next) {
+        if (!child->string) continue;
+        int slot = (int) (HashKey(child->string) & (JSON_SCHEMA_SLOTS - 1));
+        for (; schema->slots[slot] >= 0; slot = (slot + 1) & (JSON_SCHEMA_SLOTS - 1)) {
+            int keyIdx = schema->slots[slot];
+            if (!KeyEquals(schema->keys[keyIdx], child->string)) continue;
+            if (!fields[keyIdx]) fields[keyIdx] = child;
+            break;
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef JSON_SCHEMA_H
+#define JSON_SCHEMA_H
+
+#include "cJSON.h"
+
+#define JSON_SCHEMA_SLOTS 64 // Power of 2, at least twice the most keys in a schema.
+
+// The keys an object type is read with. Reading an object walks its children once and looks each key up in a
+// small hash table, instead of cJSON_GetObjectItem scanning every child for every key.
+// Keys match case insensitively like cJSON_GetObjectItem, and the first child with a key wins.
+typedef struct JsonSchema {
+    const char *const *keys;
+    int keyCount;
+    signed char slots[JSON_SCHEMA_SLOTS]; // Key index or -1.
+} JsonSchema;
+
+// Build every schema before threads can read them, e.g. with pthread_once.
+void JsonSchemaInit(JsonSchema *schema, const char *const *keys, int keyCount);
+// fields has keyCount entries. Each one gets the child with that key, or NULL if there isn't one.
+void JsonSchemaRead(const JsonSchema *schema, const cJSON *object, cJSON **fields);
+
+#endif
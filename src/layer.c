@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -7,6 +8,7 @@
 #include "raylib.h"
 #include "raymath.h"
 #include "rlgl.h"
+#include "json_schema.h"
 #include "layer.h"
 #include "transform_2d.h"
 
@@ -18,80 +20,91 @@ Color layerColors[] = {
 };
 
 
-void HandleDraw(Vector2 pos, Color strokeColor) {
-    DrawCircle((int) pos.x, (int) pos.y, HANDLE_RADIUS, strokeColor);
-    DrawCircle((int) pos.x, (int) pos.y, 6.0f, RAYWHITE);
+void HandleDraw(Vector2 pos, float scale, Color strokeColor) {
+    DrawCircleV(pos, HANDLE_RADIUS * scale, strokeColor);
+    DrawCircleV(pos, 6.0f * scale, RAYWHITE);
 }
 
 void ShapeDraw(Shape shape, Transform2D transform, Color color, bool outline, Color outlineColor) {
-    rlPushMatrix();
-    rlTranslatef(transform.o.x, transform.o.y, 0);
+    Vector2 points[SHAPE_OUTLINE_POINTS];
+    int count = ShapeTessellate(shape, transform, points);
+    
+    // Every shape is convex so a fan from any point fills it. The outline goes clockwise on screen and raylib
+    // culls clockwise triangles, so the fan goes the other way.
+    Vector2 fan[SHAPE_OUTLINE_POINTS];
+    for (int i = 0; i < count; i++) fan[i] = points[count - 1 - i];
+    DrawTriangleFan(fan, count, color);
+    if (!outline) return;
+    DrawLineStrip(points, count, outlineColor);
+    DrawLineV(points[count - 1], points[0], outlineColor);
+}
+
+static int ShapeHandles(Shape shape, Transform2D transform, Vector2 *positions, Handle *handles) {
+    int count = 0;
     switch (shape.type) {
         case SHAPE_CIRCLE:
-            DrawCircle(0, 0, (float) shape.circleRadius, color);
-            if (outline) DrawCircleLines(0, 0, (float) shape.circleRadius, outlineColor);
+            positions[count] = (Vector2) {(float) shape.circleRadius, 0.0f};
+            handles[count++] = HANDLE_CIRCLE_RADIUS;
             break;
 
-        case SHAPE_RECTANGLE: {
-            int x = -shape.rectangle.rightX;
-            int y = -shape.rectangle.bottomY;
-            int width = 2 * shape.rectangle.rightX;
-            int height = 2 * shape.rectangle.bottomY;
-            DrawRectangle(x, y, width, height, color);
-            if (!outline) break;
-            // have to draw it manually instead of DrawRectangleLines because the lines scale with the transform.
-            int xWidth = x + width;
-            int yHeight = y + height;
-            DrawLine(x, y, xWidth, y, outlineColor);
-            DrawLine(xWidth, y, xWidth, yHeight, outlineColor);
-            DrawLine(xWidth, yHeight, x, yHeight, outlineColor);
-            DrawLine(x, yHeight, x, y, outlineColor);
-        } break;
+        case SHAPE_RECTANGLE:
+            positions[count] = (Vector2) {(float) shape.rectangle.rightX, (float) shape.rectangle.bottomY};
+            handles[count++] = HANDLE_RECTANGLE_CORNER;
+            break;
 
-        case SHAPE_CAPSULE: {
-            rlRotatef(shape.capsule.rotation * 180.0f / PI, 0.0f, 0.0f, 1.0f);
-            Rectangle rect = {
-                .x = (float) -shape.capsule.radius,
-                .y = (float) (-shape.capsule.radius - shape.capsule.height),
-                .width = (float) shape.capsule.radius * 2.0f,
-                .height = (float) (shape.capsule.radius + shape.capsule.height) * 2.0f
-            };
-            DrawRectangleRounded(rect, 1.0f, SHAPE_SEGMENTS, color);
-            if (outline) DrawRectangleRoundedLines(rect, 1.0f, SHAPE_SEGMENTS, 0.0f, outlineColor);
-        } break;
+        case SHAPE_CAPSULE:
+            transform = Transform2DRotate(transform, shape.capsule.rotation);
+            positions[count] = (Vector2) {(float) shape.capsule.radius, 0.0f};
+            handles[count++] = HANDLE_CAPSULE_RADIUS;
+            positions[count] = (Vector2) {0.0f, (float) shape.capsule.height};
+            handles[count++] = HANDLE_CAPSULE_HEIGHT;
+            positions[count] = (Vector2) {0.0f, (float) -shape.capsule.height};
+            handles[count++] = HANDLE_CAPSULE_ROTATION;
+            break;
     }
-    rlPopMatrix();
+    Transform2DToGlobalArray(transform, positions, positions, count);
+    return count;
 }
 
-void ShapeDrawHandles(Shape shape, Transform2D transform, Color color) {
-    switch (shape.type) {
-        case SHAPE_CIRCLE: {
-            Vector2 radiusVector = {.x = (float) shape.circleRadius, .y = 0.0f};
-            Vector2 radiusPos = Transform2DBasisXFormInv(transform, radiusVector);
-            HandleDraw(Vector2Add(transform.o, radiusPos), color);
-        } break;
+int LayerHandles(Layer *layer, int frame, Transform2D world, Vector2 *positions, Handle *handles) {
+    assert(0 <= frame && frame < LIST_COUNT(layer->framesActive));
+    if (!layer->framesActive[frame]) return 0;
+    
+    int count = 0;
+    LayerSample sample = LayerSampleAt(layer, frame);
+    switch (layer->type) {
+        case LAYER_HITBOX:
+            positions[count] = Transform2DToGlobal(world, (Vector2) {(float) layer->hitbox.knockbackX, (float) layer->hitbox.knockbackY});
+            handles[count++] = HANDLE_HITBOX_KNOCKBACK;
+            count += ShapeHandles(sample.shape, world, positions + count, handles + count);
+            break;
 
-        case SHAPE_RECTANGLE: {
-            Vector2 localHandlePos = {.x = (float) shape.rectangle.rightX, .y = (float) shape.rectangle.bottomY};
-            Vector2 extents = Transform2DBasisXFormInv(transform, localHandlePos);
-            HandleDraw(Vector2Add(transform.o, extents), color);
-        } break;
+        case LAYER_SHAPE:
+            count += ShapeHandles(sample.shape, world, positions + count, handles + count);
+            break;
 
-        case SHAPE_CAPSULE: {
-            Vector2 radius = {.x = (float) shape.capsule.radius, .y = 0.0f};
-            Vector2 height = {.x = 0.0f, .y = (float) shape.capsule.height};
-            Vector2 rotation = {.x = 0.0f, .y = (float) -shape.capsule.height};
-            Transform2D xform = Transform2DRotate(transform, shape.capsule.rotation);
-
-            Vector2 globalRadius = Vector2Add(transform.o, Transform2DBasisXFormInv(xform, radius));
-            Vector2 globalHeight = Vector2Add(transform.o, Transform2DBasisXFormInv(xform, height));
-            Vector2 globalRotation = Vector2Add(transform.o, Transform2DBasisXFormInv(xform, rotation));
-
-            HandleDraw(globalRadius, color);
-            HandleDraw(globalHeight, color);
-            HandleDraw(globalRotation, color);
+        case LAYER_EMPTY:
+            break;
+
+        case LAYER_BEZIER: {
+            BezierPoint point = layer->bezierPoints[frame];
+            Transform2D transformBezier = Transform2DFromRotation(point.rotation);
+            transformBezier.o = point.position;
+            Transform2D transformLayer = Transform2DMultiply(world, transformBezier);
+            
+            positions[count] = (Vector2) {point.extentsRight, 0.0f};
+            handles[count++] = HANDLE_BEZIER_RIGHT;
+            positions[count] = (Vector2) {-point.extentsLeft, 0.0f};
+            handles[count++] = HANDLE_BEZIER_LEFT;
+            positions[count] = VECTOR2_ZERO;
+            handles[count++] = HANDLE_BEZIER_CENTER;
+            Transform2DToGlobalArray(transformLayer, positions, positions, count);
         } break;
     }
+    positions[count] = world.o;
+    handles[count++] = HANDLE_CENTER;
+    assert(count <= LAYER_HANDLES_MAX);
+    return count;
 }
 
 Vector2 BezierLerp(BezierPoint p0, BezierPoint p1, float lerp) {
@@ -110,45 +123,282 @@ Vector2 BezierLerp(BezierPoint p0, BezierPoint p1, float lerp) {
     return Vector2Lerp(r0, r1, lerp);
 }
 
+void BezierTessellate(BezierPoint p0, BezierPoint p1, Vector2 *points) {
+    for (int pointIdx = 0; pointIdx < BEZIER_SEGMENTS; pointIdx++) {
+        float lerp = ((float) pointIdx) / ((float) (BEZIER_SEGMENTS  - 1));
+        points[pointIdx] = BezierLerp(p0, p1, lerp); 
+    }
+}
+
+// Adds pointCount points along an arc of the given radius starting at angleStart.
+static int ArcTessellate(Transform2D transform, Vector2 center, float radius, float angleStart, float angleLength, int pointCount, Vector2 *points) {
+    for (int i = 0; i < pointCount; i++) {
+        float angle = angleStart + angleLength * (float) i / (float) (pointCount - 1);
+        points[i] = (Vector2) {center.x + cosf(angle) * radius, center.y + sinf(angle) * radius};
+    }
+    Transform2DToGlobalArray(transform, points, points, pointCount);
+    return pointCount;
+}
+
+bool ShapeEqual(Shape a, Shape b) {
+    if (a.type != b.type) return false;
+    switch (a.type) {
+        case SHAPE_CIRCLE: return a.circleRadius == b.circleRadius;
+        case SHAPE_RECTANGLE: return a.rectangle.rightX == b.rectangle.rightX && a.rectangle.bottomY == b.rectangle.bottomY;
+        case SHAPE_CAPSULE:
+            return a.capsule.radius == b.capsule.radius && a.capsule.height == b.capsule.height && a.capsule.rotation == b.capsule.rotation;
+    }
+    assert(false);
+    return false;
+}
+
+int ShapeTessellate(Shape shape, Transform2D transform, Vector2 *points) {
+    switch (shape.type) {
+        case SHAPE_CIRCLE: {
+            // The last point would be the same as the first so leave it out.
+            float step = 2.0f * PI / (float) SHAPE_OUTLINE_POINTS;
+            return ArcTessellate(transform, VECTOR2_ZERO, (float) shape.circleRadius, 0.0f, 2.0f * PI - step, SHAPE_OUTLINE_POINTS, points);
+        }
+
+        case SHAPE_RECTANGLE: {
+            float x = (float) shape.rectangle.rightX;
+            float y = (float) shape.rectangle.bottomY;
+            points[0] = (Vector2) {-x, -y};
+            points[1] = (Vector2) {x, -y};
+            points[2] = (Vector2) {x, y};
+            points[3] = (Vector2) {-x, y};
+            Transform2DToGlobalArray(transform, points, points, 4);
+            return 4;
+        }
+
+        case SHAPE_CAPSULE: {
+            Transform2D transformCapsule = Transform2DMultiply(transform, Transform2DFromRotation(shape.capsule.rotation));
+            float radius = (float) shape.capsule.radius;
+            float height = (float) shape.capsule.height;
+            int half = SHAPE_OUTLINE_POINTS / 2;
+            int count = ArcTessellate(transformCapsule, (Vector2) {0.0f, -height}, radius, PI, PI, half, points);
+            count += ArcTessellate(transformCapsule, (Vector2) {0.0f, height}, radius, 0.0f, PI, half, points + count);
+            return count;
+        }
+    }
+    assert(false);
+    return 0;
+}
+
+void LayerTessellate(Layer *layer, int frame, Transform2D world, LIST(Vector2) *points) {
+    Vector2 outline[SHAPE_OUTLINE_POINTS];
+    switch (layer->type) {
+        case LAYER_HITBOX:
+        case LAYER_SHAPE:
+            if (!layer->framesActive[frame]) return;
+            LIST_ADD_ARRAY(points, outline, ShapeTessellate(LayerSampleAt(layer, frame).shape, world, outline));
+            break;
+
+        case LAYER_EMPTY:
+            break;
+
+        case LAYER_BEZIER: {
+            // Beziers are drawn over every frame, not just the current one.
+            Vector2 curve[BEZIER_SEGMENTS];
+            int frameCount = LIST_COUNT(layer->framesActive) - 1;
+            for (int frameIdx = 0; frameIdx < frameCount; frameIdx++) {
+                if (!layer->framesActive[frameIdx] || !layer->framesActive[frameIdx + 1]) continue;
+                BezierTessellate(layer->bezierPoints[frameIdx], layer->bezierPoints[frameIdx + 1], curve);
+                Transform2DToGlobalArray(world, curve, curve, BEZIER_SEGMENTS);
+                LIST_ADD_ARRAY(points, curve, BEZIER_SEGMENTS);
+            }
+        } break;
+    }
+}
+
 void LayerFree(Layer *layer) {
     LIST_FREE(layer->framesActive);
-    free(layer->name);
     if (layer->type == LAYER_BEZIER) LIST_FREE(layer->bezierPoints);
+    LIST_FREE(layer->keys);
+    LIST_FREE(layer->samples);
+}
+
+Shape *LayerShapeBase(Layer *layer) {
+    switch (layer->type) {
+        case LAYER_HITBOX: return &layer->hitbox.shape;
+        case LAYER_SHAPE: return &layer->shape.shape;
+        case LAYER_BEZIER:
+        case LAYER_EMPTY:
+            return NULL;
+    }
+    assert(false);
+    return NULL;
+}
+
+LayerSample LayerSampleAt(Layer *layer, int frame) {
+    if (LIST_COUNT(layer->samples) > 0) {
+        assert(0 <= frame && frame < LIST_COUNT(layer->samples));
+        return layer->samples[frame];
+    }
+    Shape *shape = LayerShapeBase(layer);
+    return (LayerSample) {
+        .position = layer->transform.o,
+        .shape = shape ? *shape : (Shape) {0}
+    };
+}
+
+Transform2D LayerTransformAt(Layer *layer, int frame) {
+    Transform2D transform = layer->transform;
+    transform.o = LayerSampleAt(layer, frame).position;
+    return transform;
+}
+
+// Index of the first key on or after the frame.
+static int KeySearch(Layer *layer, int frame) {
+    int low = 0;
+    int high = LIST_COUNT(layer->keys);
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (layer->keys[middle].frame < frame) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+bool LayerKeyOnFrame(Layer *layer, int frame) {
+    int keyIdx = KeySearch(layer, frame);
+    return keyIdx < LIST_COUNT(layer->keys) && layer->keys[keyIdx].frame == frame;
+}
+
+void LayerEditTarget(Layer *layer, int frame, Vector2 **position, Shape **shape) {
+    if (LIST_COUNT(layer->keys) == 0) {
+        *position = &layer->transform.o;
+        *shape = LayerShapeBase(layer);
+        return;
+    }
+    if (!LayerKeyOnFrame(layer, frame)) LayerKeyToggle(layer, frame);
+    LayerKey *key = layer->keys + KeySearch(layer, frame);
+    *position = &key->value.position;
+    *shape = LayerShapeBase(layer) ? &key->value.shape : NULL;
+}
+
+void LayerKeyToggle(Layer *layer, int frame) {
+    assert(0 <= frame && frame < LIST_COUNT(layer->framesActive));
+    int keyIdx = KeySearch(layer, frame);
+    if (keyIdx < LIST_COUNT(layer->keys) && layer->keys[keyIdx].frame == frame) {
+        // Removing the last key leaves the layer showing what it showed on every frame anyway.
+        LIST_REMOVE_RANGE(layer->keys, keyIdx, 1);
+    } else {
+        LayerKey key = {.frame = frame, .value = LayerSampleAt(layer, frame)};
+        LIST_INSERT_GAP(&layer->keys, keyIdx, 1);
+        layer->keys[keyIdx] = key;
+    }
+    LayerKeysBake(layer);
+}
+
+static int LerpInt(int a, int b, float t) {
+    return (int) roundf((float) a + (float) (b - a) * t);
+}
+
+// Both shapes are always the same type since a layer's shape type never changes.
+static Shape ShapeLerp(Shape a, Shape b, float t) {
+    Shape shape = a;
+    switch (a.type) {
+        case SHAPE_CIRCLE:
+            shape.circleRadius = LerpInt(a.circleRadius, b.circleRadius, t);
+            break;
+        case SHAPE_RECTANGLE:
+            shape.rectangle.rightX = LerpInt(a.rectangle.rightX, b.rectangle.rightX, t);
+            shape.rectangle.bottomY = LerpInt(a.rectangle.bottomY, b.rectangle.bottomY, t);
+            break;
+        case SHAPE_CAPSULE:
+            shape.capsule.radius = LerpInt(a.capsule.radius, b.capsule.radius, t);
+            shape.capsule.height = LerpInt(a.capsule.height, b.capsule.height, t);
+            shape.capsule.rotation = Lerp(a.capsule.rotation, b.capsule.rotation, t);
+            break;
+    }
+    return shape;
+}
+
+void LayerKeysBake(Layer *layer) {
+    int keyCount = LIST_COUNT(layer->keys);
+    if (keyCount == 0) {
+        LIST_SHRINK(layer->samples, 0);
+        return;
+    }
+    int frameCount = LIST_COUNT(layer->framesActive);
+    LIST_RESERVE(&layer->samples, frameCount);
+    LIST_SHRINK(layer->samples, frameCount);
+    bool hasShape = LayerShapeBase(layer) != NULL;
+
+    // One pass over the frames, stepping to the next key as frames pass it.
+    int keyIdx = 0;
+    for (int frame = 0; frame < frameCount; frame++) {
+        while (keyIdx < keyCount && layer->keys[keyIdx].frame <= frame) keyIdx++;
+        LayerSample sample;
+        if (keyIdx == 0) {
+            sample = layer->keys[0].value;
+        } else if (keyIdx == keyCount) {
+            sample = layer->keys[keyCount - 1].value;
+        } else {
+            LayerKey *previous = layer->keys + keyIdx - 1;
+            LayerKey *next = layer->keys + keyIdx;
+            float t = (float) (frame - previous->frame) / (float) (next->frame - previous->frame);
+            sample.position = Vector2Lerp(previous->value.position, next->value.position, t);
+            sample.shape = hasShape ? ShapeLerp(previous->value.shape, next->value.shape, t) : previous->value.shape;
+        }
+        layer->samples[frame] = sample;
+    }
+
+    layer->transform.o = layer->samples[0].position;
+    if (hasShape) *LayerShapeBase(layer) = layer->samples[0].shape;
+}
+
+void LayerKeysFramesInsert(Layer *layer, int idx, int count) {
+    for (int i = KeySearch(layer, idx); i < LIST_COUNT(layer->keys); i++) layer->keys[i].frame += count;
+}
+
+void LayerKeysFramesDuplicate(Layer *layer, int idx, int count) {
+    // The copies were inserted at idx + count, which moved the keys from there on past them.
+    int start = KeySearch(layer, idx);
+    int end = KeySearch(layer, idx + count);
+    int copyCount = end - start;
+    if (copyCount == 0) return;
+    LIST_INSERT_GAP(&layer->keys, end, copyCount);
+    for (int i = 0; i < copyCount; i++) {
+        layer->keys[end + i] = layer->keys[start + i];
+        layer->keys[end + i].frame += count;
+    }
+}
+
+void LayerKeysFramesRemove(Layer *layer, int idx, int count) {
+    int start = KeySearch(layer, idx);
+    int end = KeySearch(layer, idx + count);
+    LIST_REMOVE_RANGE(layer->keys, start, end - start);
+    for (int i = start; i < LIST_COUNT(layer->keys); i++) layer->keys[i].frame -= count;
 }
 
-void LayerDraw(Layer *layer, int frame, Transform2D transform, bool handlesActive) {
+void LayerDraw(Layer *layer, int frame, Transform2D world, float handleScale, bool handlesActive) {
     if (layer->type != LAYER_BEZIER && !layer->framesActive[frame]) return;
     
     Color colorOutline = layerColors[layer->type];
-    
-    rlPushMatrix();
-    rlTransform2DXForm(transform);
+    LayerSample sample = LayerSampleAt(layer, frame);
 
     // Draw shapes
     switch (layer->type) {
         case LAYER_HITBOX: {
             Color color = colorOutline;
             color.a /= 4;
-            ShapeDraw(layer->hitbox.shape, layer->transform, color, handlesActive, colorOutline);
-            DrawLine(layer->transform.o.x,
-                     layer->transform.o.y,
-                     layer->transform.o.x + layer->hitbox.knockbackX,
-                     layer->transform.o.y + layer->hitbox.knockbackY,
-                     colorOutline);
+            ShapeDraw(sample.shape, world, color, handlesActive, colorOutline);
+            Vector2 knockback = {(float) layer->hitbox.knockbackX, (float) layer->hitbox.knockbackY};
+            DrawLineV(world.o, Transform2DToGlobal(world, knockback), colorOutline);
         } break;
        
         case LAYER_SHAPE: {
             Color color = colorOutline;
             color.a /= 4;
-            ShapeDraw(layer->shape.shape, layer->transform, color, handlesActive, colorOutline);
+            ShapeDraw(sample.shape, world, color, handlesActive, colorOutline);
         } break;
         
         case LAYER_EMPTY:
             break;
         
-        case LAYER_BEZIER:
-            rlPushMatrix();
-            rlTransform2DXForm(layer->transform);
+        case LAYER_BEZIER: {
             int frameCount = LIST_COUNT(layer->framesActive) - 1;
             for (int frameIdx = 0; frameIdx < frameCount; frameIdx++) {
                 // Make sure both ends of the line segment are defined before we try to draw it.
@@ -157,11 +407,9 @@ void LayerDraw(Layer *layer, int frame, Transform2D transform, bool handlesActiv
                 BezierPoint p0 = layer->bezierPoints[frameIdx];
                 BezierPoint p1 = layer->bezierPoints[frameIdx + 1];
                 
-                Vector2 points[16];
-                for (int pointIdx = 0; pointIdx < 16; pointIdx++) {
-                    float lerp = ((float) pointIdx) / ((float) (BEZIER_SEGMENTS  - 1));
-                    points[pointIdx] = BezierLerp(p0, p1, lerp); 
-                }
+                Vector2 points[BEZIER_SEGMENTS];
+                BezierTessellate(p0, p1, points);
+                Transform2DToGlobalArray(world, points, points, BEZIER_SEGMENTS);
                 DrawLineStrip(points, BEZIER_SEGMENTS, colorOutline);
             }
             
@@ -171,136 +419,25 @@ void LayerDraw(Layer *layer, int frame, Transform2D transform, bool handlesActiv
             for (int i = 0; i < LIST_COUNT(layer->framesActive); i++) {
                 if (!layer->framesActive[i]) continue;
                 BezierPoint point = layer->bezierPoints[i];
-                Vector2 left = Vector2Rotate((Vector2) {-point.extentsLeft, 0.0f}, point.rotation);
-                left = Vector2Add(left, point.position);
-                Vector2 right = Vector2Rotate((Vector2) {point.extentsRight, 0.0f}, point.rotation);
-                right = Vector2Add(right, point.position);
-                DrawLineV(left, point.position, colorLine);
-                DrawLineV(right, point.position, colorLine);
+                Vector2 extents[3] = {
+                    Vector2Add(Vector2Rotate((Vector2) {-point.extentsLeft, 0.0f}, point.rotation), point.position),
+                    point.position,
+                    Vector2Add(Vector2Rotate((Vector2) {point.extentsRight, 0.0f}, point.rotation), point.position)
+                };
+                Transform2DToGlobalArray(world, extents, extents, 3);
+                DrawLineStrip(extents, 3, colorLine);
             }
-            rlPopMatrix();
-            break;
+        } break;
     }
-    rlPopMatrix();
 
     // Draw handles
     if (!handlesActive) return;
-    Vector2 centerGlobal = Transform2DToGlobal(transform, layer->transform.o);
-    HandleDraw(centerGlobal, colorOutline);
-    switch (layer->type) {
-        case LAYER_HITBOX: {
-            Transform2D layerTransform = Transform2DMultiply(transform, layer->transform);
-            ShapeDrawHandles(layer->hitbox.shape, layerTransform, colorOutline);
-            Vector2 knockbackLocal = (Vector2) {
-                .x = (float) layer->hitbox.knockbackX,
-                .y = (float) layer->hitbox.knockbackY
-            };
-            Vector2 knockbackGlobal = Vector2Add(centerGlobal, Transform2DBasisXFormInv(transform, knockbackLocal));
-            HandleDraw(knockbackGlobal, colorOutline);
-        } break;
-        
-        case LAYER_SHAPE: {
-            Transform2D layerTransform = Transform2DMultiply(transform, layer->transform);
-            ShapeDrawHandles(layer->shape.shape, layerTransform, colorOutline);
-        } break;
-        
-        case LAYER_EMPTY:
-            break;
-        case LAYER_BEZIER: {
-            if (!layer->framesActive[frame]) break;
-            BezierPoint point = layer->bezierPoints[frame];
-            
-            Transform2D transformBezier = Transform2DFromRotation(point.rotation);
-            transformBezier.o = point.position;
-            Transform2D transformLayer = Transform2DMultiply(layer->transform, transformBezier);
-            Transform2D transformGlobal = Transform2DMultiply(transform, transformLayer);
-            
-            HandleDraw(Transform2DToGlobal(transformGlobal, (Vector2) {0.0f, 0.0f}), colorOutline);
-            HandleDraw(Transform2DToGlobal(transformGlobal, (Vector2) {-point.extentsLeft, 0.0f}), colorOutline);
-            HandleDraw(Transform2DToGlobal(transformGlobal, (Vector2) {point.extentsRight, 0.0f}), colorOutline);
-        } break;
-    }
-
-}
-
-bool HandleIsColliding(Transform2D globalTransform, Vector2 globalMousePos, Vector2 localPos) {
-    Vector2 globalHandlePos = Transform2DToGlobal(globalTransform, localPos);
-    Rectangle rect = {
-        .x = globalHandlePos.x - HANDLE_RADIUS,
-        .y = globalHandlePos.y - HANDLE_RADIUS,
-        .height = 2.0f * HANDLE_RADIUS,
-        .width = 2.0f * HANDLE_RADIUS
-    };
-    return CheckCollisionPointRec(globalMousePos, rect);
-}
-
-Handle ShapeHandleSelect(Shape shape, Transform2D transform, Vector2 globalMousePos) {
-    switch (shape.type) {
-        case SHAPE_CIRCLE: {
-            Vector2 radiusPos = (Vector2) {(float) shape.circleRadius, 0.0f};
-            if (HandleIsColliding(transform, globalMousePos, radiusPos)) return HANDLE_CIRCLE_RADIUS;
-        } break;
-
-        case SHAPE_RECTANGLE: {
-            Vector2 cornerPos = {
-                .x = (float) shape.rectangle.rightX,
-                .y = (float) shape.rectangle.bottomY
-            };
-            if (HandleIsColliding(transform, globalMousePos, cornerPos)) return HANDLE_RECTANGLE_CORNER;
-        } break;
-
-        case SHAPE_CAPSULE: {
-            Transform2D transformCapsule = Transform2DMultiply(transform, Transform2DFromRotation(shape.capsule.rotation));
-            
-            Vector2 radiusPos = {(float) shape.capsule.radius, 0.0f};
-            if (HandleIsColliding(transformCapsule, globalMousePos, radiusPos)) return HANDLE_CAPSULE_RADIUS;
-
-            Vector2 heightPos = {0.0f, (float) shape.capsule.height};
-            if (HandleIsColliding(transformCapsule, globalMousePos, heightPos)) return HANDLE_CAPSULE_HEIGHT;
-
-            Vector2 rotationPos = {0.0f, (float) -shape.capsule.height};
-            if (HandleIsColliding(transformCapsule, globalMousePos, rotationPos)) return HANDLE_CAPSULE_ROTATION;
-        } break;
-    }
-    return HANDLE_NONE;
-}
-
-Handle LayerHandleSelect(Layer *layer, int frame, Transform2D transform, Vector2 mousePos) {
-    assert(0 <= frame && frame < LIST_COUNT(layer->framesActive));
-    switch (layer->type) {
-        case LAYER_HITBOX: {
-            Vector2 knockbackHandle = {
-                .x = layer->transform.o.x + (float) layer->hitbox.knockbackX,
-                .y = layer->transform.o.y + (float) layer->hitbox.knockbackY
-            };
-            if (HandleIsColliding(transform, mousePos, knockbackHandle)) return HANDLE_HITBOX_KNOCKBACK;
-            Handle handle = ShapeHandleSelect(layer->hitbox.shape, Transform2DMultiply(transform, layer->transform), mousePos);
-            if (handle != HANDLE_NONE) return handle;
-        } break;
-
-        case LAYER_SHAPE: {
-            Handle handle = ShapeHandleSelect(layer->shape.shape, Transform2DMultiply(transform, layer->transform), mousePos);
-            if (handle != HANDLE_NONE) return handle;
-        } break;
-
-        case LAYER_EMPTY:
-            break;
-        case LAYER_BEZIER: {
-            BezierPoint point = layer->bezierPoints[frame];
-            Transform2D transformLayer = Transform2DMultiply(transform, layer->transform);
-            Transform2D transformBezier = Transform2DFromRotation(point.rotation);
-            transformBezier.o = point.position;
-            Transform2D transformGlobal = Transform2DMultiply(transformLayer, transformBezier);
-            if (HandleIsColliding(transformGlobal, mousePos, (Vector2) {point.extentsRight, 0.0f})) return HANDLE_BEZIER_RIGHT;
-            if (HandleIsColliding(transformGlobal, mousePos, (Vector2) {-point.extentsLeft, 0.0f})) return HANDLE_BEZIER_LEFT;
-            if (HandleIsColliding(transformLayer, mousePos, point.position)) return HANDLE_BEZIER_CENTER;
-        } break;
-    }
-    if (HandleIsColliding(transform, mousePos, layer->transform.o)) return HANDLE_CENTER;
-    return HANDLE_NONE;
+    Vector2 positions[LAYER_HANDLES_MAX];
+    Handle handles[LAYER_HANDLES_MAX];
+    int handleCount = LayerHandles(layer, frame, world, positions, handles);
+    for (int i = 0; i < handleCount; i++) HandleDraw(positions[i], handleScale, colorOutline);
 }
 
-
 bool ShapeHandleSet(Shape *shape, Handle handle, Vector2 handlePos, bool snapping) {
     switch (shape->type) {
         case SHAPE_CIRCLE:
@@ -340,49 +477,162 @@ bool ShapeHandleSet(Shape *shape, Handle handle, Vector2 handlePos, bool snappin
     assert(false);
 }
 
-bool LayerHandleSet(Layer *layer, int frame, Handle handle, Vector2 localMousePos, bool snapping) {
+bool LayerHandleSet(Layer *layer, int frame, const Transform2DCached *parentWorld, const Transform2DCached *world, Handle handle, Vector2 localMousePos, bool snapping) {
     assert(0 <= frame && frame < LIST_COUNT(layer->framesActive));
-    if (handle == HANDLE_CENTER) {
-        layer->transform.o = Vector2Round(localMousePos);
+    Vector2 handlePos = Transform2DCachedToLocal(world, localMousePos);
+
+    if (layer->type == LAYER_HITBOX && handle == HANDLE_HITBOX_KNOCKBACK) {
+        Vector2 knockback = Vector2Round(handlePos);
+        layer->hitbox.knockbackX = (int) knockback.x;
+        layer->hitbox.knockbackY = (int) knockback.y;
+        layer->templateOverrides |= TEMPLATE_FIELD_KNOCKBACK;
         return true;
     }
 
-    Vector2 handlePos = Transform2DToLocal(layer->transform, localMousePos);
+    if (layer->type == LAYER_BEZIER && handle != HANDLE_CENTER) {
+        BezierPoint *point = layer->bezierPoints + frame;
+
+        if (handle == HANDLE_BEZIER_CENTER) {
+            point->position = Vector2Round(handlePos);
+            return true;
+        } else if (handle == HANDLE_BEZIER_LEFT) {
+            Vector2 handleOffset = Vector2Subtract(handlePos, point->position);
+            point->rotation = Vector2Rotation(handleOffset) + PI;
+            point->extentsLeft = roundf(Vector2Length(handleOffset));
+            return true;
+        } else if (handle == HANDLE_BEZIER_RIGHT) {
+            Vector2 handleOffset = Vector2Subtract(handlePos, point->position);
+            point->rotation = Vector2Rotation(handleOffset);
+            point->extentsRight = roundf(Vector2Length(handleOffset));
+            return true;
+        }
+        return false;
+    }
+
+    // Everything else moves or reshapes the layer, which layers with keys store in the key on the frame.
+    Vector2 *position;
+    Shape *shape;
+    LayerEditTarget(layer, frame, &position, &shape);
+    bool success;
+    if (handle == HANDLE_CENTER) {
+        *position = Vector2Round(Transform2DCachedToLocal(parentWorld, localMousePos));
+        success = true;
+    } else {
+        success = shape && ShapeHandleSet(shape, handle, handlePos, snapping);
+        if (success) layer->templateOverrides |= TEMPLATE_FIELD_SHAPE;
+    }
+    if (LIST_COUNT(layer->keys) > 0) LayerKeysBake(layer);
+    return success;
+}
+
+void LayerFrameToggle(Layer *layer, int frame) {
+    assert(0 <= frame && frame < LIST_COUNT(layer->framesActive));
+    bool active = !layer->framesActive[frame];
+    layer->framesActive[frame] = active;
+    if (!active || layer->type != LAYER_BEZIER) return;
+
+    // Initialize a new bezier point
+    int frameCount = LIST_COUNT(layer->framesActive);
+    BezierPoint point;
+    point.extentsLeft = 10.0f,
+    point.extentsRight = 10.0f,
+    point.rotation = 0.0f;
+    
+    // If the points around this bezier are enabled, interpolate between them to find the bezier position.
+    bool surroundingPoints = 
+        frameCount >= 3 
+        && frame > 0 
+        && frame < frameCount - 1
+        && layer->framesActive[frame - 1]
+        && layer->framesActive[frame + 1];
+    
+    if (surroundingPoints) { // Lerp between surrouding points if they exist
+        BezierPoint prev = layer->bezierPoints[frame - 1];
+        BezierPoint next = layer->bezierPoints[frame + 1];
+        point.position = Vector2Lerp(prev.position, next.position, 0.5f);
+    } else if (frame < frameCount - 1 && layer->framesActive[frame + 1]) {
+        Vector2 origin = layer->bezierPoints[frame + 1].position;
+        origin.x -= 10.0f;
+        point.position = origin;
+    } else if (frame > 0 && layer->framesActive[frame - 1]) {
+        Vector2 origin = layer->bezierPoints[frame - 1].position;
+        origin.x += 10.0f;
+        point.position = origin;
+    } else {
+        point.position = (Vector2) {0.0f, 0.0f};    
+    }
+
+    layer->bezierPoints[frame] = point;
+}
+
+static int ScaleRound(int value, float scale) {
+    return (int) roundf((float) value * scale);
+}
+
+static void ShapeScale(Shape *shape, float scale) {
+    switch (shape->type) {
+        case SHAPE_CIRCLE:
+            shape->circleRadius = ScaleRound(shape->circleRadius, scale);
+            break;
+        case SHAPE_RECTANGLE:
+            shape->rectangle.rightX = ScaleRound(shape->rectangle.rightX, scale);
+            shape->rectangle.bottomY = ScaleRound(shape->rectangle.bottomY, scale);
+            break;
+        case SHAPE_CAPSULE:
+            shape->capsule.radius = ScaleRound(shape->capsule.radius, scale);
+            shape->capsule.height = ScaleRound(shape->capsule.height, scale);
+            break;
+    }
+}
 
+void LayerScale(Layer *layer, float scale) {
     switch (layer->type) {
         case LAYER_HITBOX:
-            if (handle == HANDLE_HITBOX_KNOCKBACK) {
-                Vector2 knockback = Vector2Round(handlePos);
-                layer->hitbox.knockbackX = (int) knockback.x;
-                layer->hitbox.knockbackY = (int) knockback.y;
-                return true;
-            }
-            return ShapeHandleSet(&layer->hitbox.shape, handle, handlePos, snapping);
+            ShapeScale(&layer->hitbox.shape, scale);
+            layer->templateOverrides |= TEMPLATE_FIELD_SHAPE;
+            break;
         case LAYER_SHAPE:
-            return ShapeHandleSet(&layer->shape.shape, handle, handlePos, snapping);
+            ShapeScale(&layer->shape.shape, scale);
+            layer->templateOverrides |= TEMPLATE_FIELD_SHAPE;
+            break;
         case LAYER_EMPTY:
-            return false;
-        case LAYER_BEZIER: {
-            BezierPoint *point = layer->bezierPoints + frame;
-
-            if (handle == HANDLE_BEZIER_CENTER) {
-                point->position = Vector2Round(handlePos);
-                return true;
-            } else if (handle == HANDLE_BEZIER_LEFT) {
-                Vector2 handleOffset = Vector2Subtract(handlePos, point->position);
-                point->rotation = Vector2Rotation(handleOffset) + PI;
-                point->extentsLeft = roundf(Vector2Length(handleOffset));
-                return true;
-            } else if (handle == HANDLE_BEZIER_RIGHT) {
-                Vector2 handleOffset = Vector2Subtract(handlePos, point->position);
-                point->rotation = Vector2Rotation(handleOffset);
-                point->extentsRight = roundf(Vector2Length(handleOffset));
-                return true;
+            break;
+        case LAYER_BEZIER:
+            // Undefined points are scaled too, which doesn't matter as they get initialized when enabled.
+            for (int i = 0; i < LIST_COUNT(layer->bezierPoints); i++) {
+                BezierPoint *point = layer->bezierPoints + i;
+                point->position = Vector2Round(Vector2Scale(point->position, scale));
+                point->extentsLeft = roundf(point->extentsLeft * scale);
+                point->extentsRight = roundf(point->extentsRight * scale);
             }
-            return false;
-        }
+            break;
     }
-    assert(false);
+    if (LIST_COUNT(layer->keys) == 0) return;
+    if (LayerShapeBase(layer)) {
+        for (int i = 0; i < LIST_COUNT(layer->keys); i++) ShapeScale(&layer->keys[i].value.shape, scale);
+    }
+    LayerKeysBake(layer);
+}
+
+bool LayerBounds(Layer *layer, int frame, Transform2D world, LIST(Vector2) *scratch, Rectangle *bounds) {
+    LIST_SHRINK(*scratch, 0);
+    LayerTessellate(layer, frame, world, scratch);
+    Vector2 positions[LAYER_HANDLES_MAX];
+    Handle handles[LAYER_HANDLES_MAX];
+    int handleCount = LayerHandles(layer, frame, world, positions, handles);
+    LIST_ADD_ARRAY(scratch, positions, handleCount);
+
+    int count = LIST_COUNT(*scratch);
+    if (count == 0) return false;
+    Vector2 min = (*scratch)[0];
+    Vector2 max = min;
+    for (int i = 1; i < count; i++) {
+        Vector2 point = (*scratch)[i];
+        min = (Vector2) {fminf(min.x, point.x), fminf(min.y, point.y)};
+        max = (Vector2) {fmaxf(max.x, point.x), fmaxf(max.y, point.y)};
+    }
+    *bounds = (Rectangle) {min.x, min.y, max.x - min.x, max.y - min.y};
+    return true;
 }
 
 cJSON *ShapeSerialize(Shape shape) {
@@ -412,14 +662,39 @@ cJSON *ShapeSerialize(Shape shape) {
     return shapeJson;
 }
 
-bool ShapeDeserialize(cJSON *json, Shape *shape, int version) {
-#define RETURN_FAIL do { printf("Cannot deserialize shape. Error: %s at %i\n", __FILE__, __LINE__); return false; } while (0)
+// Shape keys across every file version. Older versions stored the rectangle and capsule fields flat.
+enum {SHAPE_TYPE, SHAPE_TYPE_OLD, SHAPE_CIRCLE_RADIUS, SHAPE_RECTANGLE_JSON, SHAPE_RECTANGLE_RIGHT_X, SHAPE_RECTANGLE_BOTTOM_Y,
+    SHAPE_CAPSULE_JSON, SHAPE_CAPSULE_HEIGHT, SHAPE_CAPSULE_RADIUS, SHAPE_CAPSULE_ROTATION, SHAPE_FIELD_COUNT};
+static const char *const shapeKeys[] = {"type", "shapeType", "circleRadius", "rectangle", "rectangleRightX", "rectangleBottomY",
+    "capsule", "capsuleHeight", "capsuleRadius", "capsuleRotation"};
+enum {RECTANGLE_RIGHT_X, RECTANGLE_BOTTOM_Y, RECTANGLE_FIELD_COUNT};
+static const char *const rectangleKeys[] = {"rightX", "bottomY"};
+enum {CAPSULE_HEIGHT, CAPSULE_RADIUS, CAPSULE_ROTATION, CAPSULE_FIELD_COUNT};
+static const char *const capsuleKeys[] = {"height", "radius", "rotation"};
+
+static JsonSchema shapeSchema;
+static JsonSchema rectangleSchema;
+static JsonSchema capsuleSchema;
+static pthread_once_t shapeSchemasOnce = PTHREAD_ONCE_INIT;
+
+static void ShapeSchemasInit(void) {
+    JsonSchemaInit(&shapeSchema, shapeKeys, SHAPE_FIELD_COUNT);
+    JsonSchemaInit(&rectangleSchema, rectangleKeys, RECTANGLE_FIELD_COUNT);
+    JsonSchemaInit(&capsuleSchema, capsuleKeys, CAPSULE_FIELD_COUNT);
+}
+
+bool ShapeDeserialize(cJSON *json, Shape *shape, int version, int *errorLine) {
+#define RETURN_FAIL do {*errorLine = __LINE__; return false;} while (0)
     if (!json || !cJSON_IsObject(json)) RETURN_FAIL;
-    cJSON *type = cJSON_GetObjectItem(json, version >= 4 ? "type" : "shapeType");
+    pthread_once(&shapeSchemasOnce, ShapeSchemasInit);
+    cJSON *fields[SHAPE_FIELD_COUNT];
+    JsonSchemaRead(&shapeSchema, json, fields);
+
+    cJSON *type = fields[version >= 4 ? SHAPE_TYPE : SHAPE_TYPE_OLD];
     if (!cJSON_IsString(type)) RETURN_FAIL;
     char *typeString = cJSON_GetStringValue(type);
     if (!strcmp(typeString, "CIRCLE")) {
-        cJSON *radius = cJSON_GetObjectItem(json, "circleRadius");
+        cJSON *radius = fields[SHAPE_CIRCLE_RADIUS];
         if (!cJSON_IsNumber(radius)) RETURN_FAIL;
         shape->type = SHAPE_CIRCLE;
         shape->circleRadius = (int) cJSON_GetNumberValue(radius);
@@ -429,13 +704,15 @@ bool ShapeDeserialize(cJSON *json, Shape *shape, int version) {
         cJSON *bottomY;
 
         if (version >= 4) {
-            cJSON *rect = cJSON_GetObjectItem(json, "rectangle");
+            cJSON *rect = fields[SHAPE_RECTANGLE_JSON];
             if (!cJSON_IsObject(rect)) RETURN_FAIL;
-            rightX = cJSON_GetObjectItem(rect, "rightX");
-            bottomY = cJSON_GetObjectItem(rect, "bottomY");
+            cJSON *rectFields[RECTANGLE_FIELD_COUNT];
+            JsonSchemaRead(&rectangleSchema, rect, rectFields);
+            rightX = rectFields[RECTANGLE_RIGHT_X];
+            bottomY = rectFields[RECTANGLE_BOTTOM_Y];
         } else {
-            rightX = cJSON_GetObjectItem(json, "rectangleRightX");
-            bottomY = cJSON_GetObjectItem(json, "rectangleBottomY");
+            rightX = fields[SHAPE_RECTANGLE_RIGHT_X];
+            bottomY = fields[SHAPE_RECTANGLE_BOTTOM_Y];
         }
 
         if (!cJSON_IsNumber(rightX)) RETURN_FAIL;
@@ -452,15 +729,17 @@ bool ShapeDeserialize(cJSON *json, Shape *shape, int version) {
         cJSON *rotation;
 
         if (version >= 4) {
-            cJSON *capsule = cJSON_GetObjectItem(json, "capsule");
+            cJSON *capsule = fields[SHAPE_CAPSULE_JSON];
             if (!cJSON_IsObject(capsule)) RETURN_FAIL;
-            height = cJSON_GetObjectItem(capsule, "height");
-            radius = cJSON_GetObjectItem(capsule, "radius");
-            rotation = cJSON_GetObjectItem(capsule, "rotation");
+            cJSON *capsuleFields[CAPSULE_FIELD_COUNT];
+            JsonSchemaRead(&capsuleSchema, capsule, capsuleFields);
+            height = capsuleFields[CAPSULE_HEIGHT];
+            radius = capsuleFields[CAPSULE_RADIUS];
+            rotation = capsuleFields[CAPSULE_ROTATION];
         } else {
-            height = cJSON_GetObjectItem(json, "capsuleHeight");
-            radius = cJSON_GetObjectItem(json, "capsuleRadius");
-            rotation = cJSON_GetObjectItem(json, "capsuleRotation");
+            height = fields[SHAPE_CAPSULE_HEIGHT];
+            radius = fields[SHAPE_CAPSULE_RADIUS];
+            rotation = fields[SHAPE_CAPSULE_ROTATION];
         }
 
         if (!cJSON_IsNumber(height)) RETURN_FAIL;
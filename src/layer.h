@@ -9,6 +9,8 @@
 #define SHAPE_SEGMENTS 16
 #define HANDLE_RADIUS 8.0f
 #define BEZIER_SEGMENTS 16
+#define SHAPE_OUTLINE_POINTS (SHAPE_SEGMENTS * 4)
+#define LAYER_HANDLES_MAX 5
 
 #define LAYER_NAME_BUFFER_INITIAL_SIZE 32
 #define LAYER_NAME_BUFFER_RESIZE_MULTIPLIER 1.5f
@@ -49,6 +51,17 @@ typedef struct Shape {
     };
 } Shape;
 
+// Position and shape of a layer on one frame. The shape is unused by bezier and empty layers.
+typedef struct LayerSample {
+    Vector2 position;
+    Shape shape;
+} LayerSample;
+
+typedef struct LayerKey {
+    int frame;
+    LayerSample value;
+} LayerKey;
+
 // When you update this pls make sure to update the layer colors.
 typedef enum LayerType {
     LAYER_HITBOX,
@@ -67,13 +80,28 @@ typedef struct BezierPoint {
 } BezierPoint;
 
 Vector2 BezierLerp(BezierPoint p0, BezierPoint p1, float lerp);
+// Fills BEZIER_SEGMENTS points along the curve from p0 to p1.
+void BezierTessellate(BezierPoint p0, BezierPoint p1, Vector2 *points);
+
+// Hitbox and shape values a layer linked to a template can keep instead of following it, see template_table.h.
+typedef enum TemplateField {
+    TEMPLATE_FIELD_KNOCKBACK = 1 << 0,
+    TEMPLATE_FIELD_DAMAGE = 1 << 1,
+    TEMPLATE_FIELD_STUN = 1 << 2,
+    TEMPLATE_FIELD_FLAGS = 1 << 3,
+    TEMPLATE_FIELD_SHAPE = 1 << 4
+} TemplateField;
 
 typedef struct Layer {
-    Transform2D transform;
+    Transform2D transform; // Relative to the parent's origin when there is one.
     LayerType type;
+    int parent; // Index of the layer this one moves along with or -1. See EditorStateLayerParentSet.
     
-    char *name;
-    int nameBufferLength; // byte length of the buffer
+    const char *name; // Interned in the string table of the state that owns the layer. Unique within it.
+    // Template the hitbox or shape values follow, see template_table.h. Interned like the name, NULL if there is none.
+    const char *templateName;
+    // TemplateField bits of the values edited on this layer, which it keeps when the template changes.
+    unsigned int templateOverrides;
 
     LIST(bool) framesActive;
     union {
@@ -94,17 +122,67 @@ typedef struct Layer {
         // Length is frameCount.
         // A specific index is assumed to be undefined when its equivalent framesActive index is undefined.
     };
+
+    // Sparse keyframes of the position and shape, sorted by frame. Frames between two keys interpolate them and
+    // frames before the first or after the last hold it. Layers without keys show the same thing on every frame.
+    LIST(LayerKey) keys;
+    // The keys evaluated for every frame by LayerKeysBake so drawing and exporting never search the keys.
+    // Empty when there are no keys. While there are keys transform.o and the shape mirror frame 0.
+    LIST(LayerSample) samples;
 } Layer;
 
 // No layer init function because creating a layer is too complex to do in a single function because of the unions.
+// The keys and samples start out as empty lists, the parent as -1 and the template as NULL.
 void LayerFree(Layer *layer);
-bool HandleIsColliding(Transform2D globalTransform, Vector2 globalMousePos, Vector2 localPos);
-void HandleDraw(Vector2 pos, Color strokeColor);
 
-void LayerDraw(Layer *layer, int frame, Transform2D transform, bool handlesActive);
-Handle LayerHandleSelect(Layer *layer, int frame, Transform2D transform, Vector2 globalMousePos);
-bool LayerHandleSet(Layer *layer, int frame, Handle handle, Vector2 localMousePos, bool snapping);
+// The shape of hitbox and shape layers, NULL for the rest.
+Shape *LayerShapeBase(Layer *layer);
+LayerSample LayerSampleAt(Layer *layer, int frame);
+Transform2D LayerTransformAt(Layer *layer, int frame);
+// Finds what edits made on the frame change. Layers with keys edit the key on the frame, which gets added holding
+// what the frame shows if there isn't one yet, and need LayerKeysBake afterwards. Other layers edit the values
+// shared by every frame. shape is set to NULL for layers without one.
+void LayerEditTarget(Layer *layer, int frame, Vector2 **position, Shape **shape);
+// Adds a key on the frame holding what the frame shows, or removes the key that is already on it.
+void LayerKeyToggle(Layer *layer, int frame);
+bool LayerKeyOnFrame(Layer *layer, int frame);
+// Rebuilds the samples for every frame of framesActive from the keys.
+void LayerKeysBake(Layer *layer);
+// Keep the keys on the same frames when frames are inserted, duplicated or removed. None of them bake.
+void LayerKeysFramesInsert(Layer *layer, int idx, int count);
+void LayerKeysFramesDuplicate(Layer *layer, int idx, int count); // Expects the copies to already be inserted.
+void LayerKeysFramesRemove(Layer *layer, int idx, int count);
+// Handles keep the same size on screen, so scale is the inverse of the view's zoom when drawing in sprite space.
+void HandleDraw(Vector2 pos, float scale, Color strokeColor);
+
+// world is the layer's transform on the frame in sprite space, parents included. See layer_hierarchy.h.
+
+// Draws in sprite space. Expects the view transform to be applied with rlTransform2DXForm.
+void LayerDraw(Layer *layer, int frame, Transform2D world, float handleScale, bool handlesActive);
+// Fills the sprite space positions of the handles the layer shows on the frame, at most LAYER_HANDLES_MAX,
+// and returns how many there are. When handles overlap the earlier one should be picked.
+int LayerHandles(Layer *layer, int frame, Transform2D world, Vector2 *positions, Handle *handles);
+// parentWorld is the world transform of the parent, or the identity for layers without one, and world is the layer's
+// own on the frame. Both come with their inverses, as LayerHierarchyWorldCached has them. Marks what it changes as
+// overridden, see templateOverrides.
+bool LayerHandleSet(Layer *layer, int frame, const Transform2DCached *parentWorld, const Transform2DCached *world, Handle handle, Vector2 localMousePos, bool snapping);
+// Enables or disables the layer on the frame. Enabled bezier points start between their neighbours.
+void LayerFrameToggle(Layer *layer, int frame);
+// Scales the shape sizes, keys included, and bezier points around the layer origin. The origin itself doesn't move.
+// Bakes the keys, so positions of keys changed before calling it get baked as well. Marks the shape as overridden.
+void LayerScale(Layer *layer, float scale);
+// Sprite space bounds of everything the layer draws on the frame, handles included. scratch is reused between
+// calls to keep them from allocating. Returns false if the layer shows nothing on the frame.
+bool LayerBounds(Layer *layer, int frame, Transform2D world, LIST(Vector2) *scratch, Rectangle *bounds);
+
+// Compares only the fields the shape type uses.
+bool ShapeEqual(Shape a, Shape b);
+// Fills at most SHAPE_OUTLINE_POINTS points around the outline of the shape and returns how many there are.
+int ShapeTessellate(Shape shape, Transform2D transform, Vector2 *points);
+// Appends the outlines and curves the layer draws on the given frame, in sprite space. Doesn't need a window.
+void LayerTessellate(Layer *layer, int frame, Transform2D world, LIST(Vector2) *points);
 
 cJSON *ShapeSerialize(Shape shape);
-bool ShapeDeserialize(cJSON *json, Shape *shape, int version);
+// On failure errorLine is the source line of the failed check, for the caller to report.
+bool ShapeDeserialize(cJSON *json, Shape *shape, int version, int *errorLine);
 #endif
@@ -0,0 +1,87 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+#include "editor_history.h"
+#include "layer.h"
+#include "list.h"
+#include "transform_2d.h"
+#include "layer_hierarchy.h"
+
+LayerHierarchy LayerHierarchyNew(void) {
+    return (LayerHierarchy) {
+        .order = LIST_NEW(int),
+        .parents = LIST_NEW(int),
+        .locals = LIST_NEW(Transform2D),
+        .worlds = LIST_NEW(Transform2DCached),
+        .changed = LIST_NEW(bool)
+    };
+}
+
+void LayerHierarchyFree(LayerHierarchy *hierarchy) {
+    LIST_FREE(hierarchy->order);
+    LIST_FREE(hierarchy->parents);
+    LIST_FREE(hierarchy->locals);
+    LIST_FREE(hierarchy->worlds);
+    LIST_FREE(hierarchy->changed);
+}
+
+static void Rebuild(LayerHierarchy *hierarchy, EditorState *state) {
+    int layerCount = state->layerCount;
+    LIST_SHRINK(hierarchy->order, 0);
+    LIST_SHRINK(hierarchy->parents, 0);
+    LIST_SHRINK(hierarchy->locals, 0);
+    LIST_SHRINK(hierarchy->worlds, 0);
+    LIST_SHRINK(hierarchy->changed, 0);
+    for (int layerIdx = 0; layerIdx < layerCount; layerIdx++) {
+        LIST_ADD(&hierarchy->order, 0);
+        LIST_ADD(&hierarchy->parents, state->layers[layerIdx].parent);
+        LIST_ADD(&hierarchy->locals, Transform2DIdentity());
+        LIST_ADD(&hierarchy->worlds, Transform2DCache(Transform2DIdentity()));
+        LIST_ADD(&hierarchy->changed, true);
+    }
+    // Setting parents refuses cycles and loading checks for them, so there can't be one here.
+    bool ordered = EditorStateLayerOrder(state, hierarchy->order);
+    assert(ordered);
+    (void) ordered;
+}
+
+int LayerHierarchyUpdate(LayerHierarchy *hierarchy, EditorState *state, int frame) {
+    bool rebuild = LIST_COUNT(hierarchy->parents) != state->layerCount;
+    for (int layerIdx = 0; layerIdx < state->layerCount && !rebuild; layerIdx++) {
+        rebuild = hierarchy->parents[layerIdx] != state->layers[layerIdx].parent;
+    }
+    if (rebuild) Rebuild(hierarchy, state);
+
+    int updated = 0;
+    for (int i = 0; i < state->layerCount; i++) {
+        int layerIdx = hierarchy->order[i];
+        Layer *layer = state->layers + layerIdx;
+        Transform2D local = LayerTransformAt(layer, frame);
+        // Parents come first, so their changed flags are already the ones of this update.
+        bool changed = rebuild
+            || (layer->parent >= 0 && hierarchy->changed[layer->parent])
+            || memcmp(&local, hierarchy->locals + layerIdx, sizeof(Transform2D)) != 0;
+        hierarchy->changed[layerIdx] = changed;
+        if (!changed) continue;
+
+        hierarchy->locals[layerIdx] = local;
+        Transform2D world = layer->parent >= 0 ? Transform2DMultiply(hierarchy->worlds[layer->parent].transform, local) : local;
+        hierarchy->worlds[layerIdx] = Transform2DCache(world);
+        updated++;
+    }
+    return updated;
+}
+
+Transform2D LayerHierarchyWorld(LayerHierarchy *hierarchy, int layerIdx) {
+    return LayerHierarchyWorldCached(hierarchy, layerIdx).transform;
+}
+
+Transform2DCached LayerHierarchyWorldCached(LayerHierarchy *hierarchy, int layerIdx) {
+    static const Transform2DCached identity = {
+        .transform = {.o = {0.0f, 0.0f}, .x = {1.0f, 0.0f}, .y = {0.0f, 1.0f}},
+        .inverse = {.o = {0.0f, 0.0f}, .x = {1.0f, 0.0f}, .y = {0.0f, 1.0f}}
+    };
+    if (layerIdx < 0) return identity;
+    assert(layerIdx < LIST_COUNT(hierarchy->worlds));
+    return hierarchy->worlds[layerIdx];
+}
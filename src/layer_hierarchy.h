@@ -0,0 +1,29 @@
+#ifndef LAYER_HIERARCHY_H
+#define LAYER_HIERARCHY_H
+
+#include <stdbool.h>
+#include "editor_history.h"
+#include "list.h"
+#include "transform_2d.h"
+
+// World transforms of every layer on one frame. Lives next to the state like the handle grid so it isn't part of the
+// history. Updating walks the layers parents first and only multiplies the transforms of layers whose own transform
+// or parent changed since the last update, so an unchanged state costs one comparison per layer and moving one layer
+// recomputes just it and its descendants.
+typedef struct LayerHierarchy {
+    LIST(int) order; // Layer indices with parents before their children.
+    LIST(int) parents; // Parents the order was built from. Any difference rebuilds everything.
+    LIST(Transform2D) locals; // Layer transforms the world transforms were computed from.
+    LIST(Transform2DCached) worlds; // With their inverses, so the mouse is taken into a layer's space without dividing.
+    LIST(bool) changed; // Whether the world transform changed in the last update.
+} LayerHierarchy;
+
+LayerHierarchy LayerHierarchyNew(void);
+void LayerHierarchyFree(LayerHierarchy *hierarchy);
+// Brings the world transforms up to date with the layers on the frame. Returns how many were recomputed.
+int LayerHierarchyUpdate(LayerHierarchy *hierarchy, EditorState *state, int frame);
+// The world transform of the layer on the frame of the last update. The identity for -1, the parent of root layers.
+Transform2D LayerHierarchyWorld(LayerHierarchy *hierarchy, int layerIdx);
+Transform2DCached LayerHierarchyWorldCached(LayerHierarchy *hierarchy, int layerIdx);
+
+#endif
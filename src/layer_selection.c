@@ -0,0 +1,196 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+#include "raylib.h"
+#include "raymath.h"
+#include "editor_history.h"
+#include "layer.h"
+#include "layer_hierarchy.h"
+#include "list.h"
+#include "transform_2d.h"
+#include "layer_selection.h"
+
+LayerSelection LayerSelectionNew(void) {
+    return (LayerSelection) {
+        .selected = LIST_NEW(bool),
+        .count = 0,
+        .bounds = LIST_NEW(Rectangle),
+        .origins = LIST_NEW(Vector2),
+        .scratch = LIST_NEW(Vector2)
+    };
+}
+
+void LayerSelectionFree(LayerSelection *selection) {
+    LIST_FREE(selection->selected);
+    LIST_FREE(selection->bounds);
+    LIST_FREE(selection->origins);
+    LIST_FREE(selection->scratch);
+}
+
+void LayerSelectionClear(LayerSelection *selection) {
+    memset(selection->selected, 0, sizeof(bool) * LIST_COUNT(selection->selected));
+    selection->count = 0;
+}
+
+void LayerSelectionSync(LayerSelection *selection, EditorState *state) {
+    bool fits = LIST_COUNT(selection->selected) == state->layerCount;
+    if (fits && state->layerIdx >= 0) fits = selection->selected[state->layerIdx];
+    if (fits && state->layerIdx < 0) fits = selection->count == 0;
+    if (fits) return;
+
+    while (LIST_COUNT(selection->selected) < state->layerCount) LIST_ADD(&selection->selected, false);
+    LIST_SHRINK(selection->selected, state->layerCount);
+    LayerSelectionClear(selection);
+    if (state->layerIdx >= 0) {
+        selection->selected[state->layerIdx] = true;
+        selection->count = 1;
+    }
+}
+
+void LayerSelectionBoundsUpdate(LayerSelection *selection, EditorState *state, LayerHierarchy *hierarchy) {
+    LIST_SHRINK(selection->bounds, 0);
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Rectangle bounds;
+        Transform2D world = LayerHierarchyWorld(hierarchy, layerIdx);
+        if (!LayerBounds(state->layers + layerIdx, state->frameIdx, world, &selection->scratch, &bounds)) bounds.width = -1.0f;
+        LIST_ADD(&selection->bounds, bounds);
+    }
+}
+
+int LayerSelectionBox(LayerSelection *selection, EditorState *state, Rectangle box) {
+    assert(LIST_COUNT(selection->bounds) == state->layerCount);
+    LayerSelectionClear(selection);
+    state->layerIdx = -1;
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Rectangle bounds = selection->bounds[layerIdx];
+        // Inclusive so layers that only have an origin, which are zero sized, can be selected.
+        bool overlaps = bounds.width >= 0.0f
+            && bounds.x <= box.x + box.width && box.x <= bounds.x + bounds.width
+            && bounds.y <= box.y + box.height && box.y <= bounds.y + bounds.height;
+        if (!overlaps) continue;
+
+        selection->selected[layerIdx] = true;
+        selection->count++;
+        if (state->layerIdx < 0) state->layerIdx = layerIdx;
+    }
+    return selection->count;
+}
+
+static bool AncestorSelected(LayerSelection *selection, EditorState *state, int layerIdx) {
+    for (int parent = state->layers[layerIdx].parent; parent >= 0; parent = state->layers[parent].parent) {
+        if (selection->selected[parent]) return true;
+    }
+    return false;
+}
+
+void LayerSelectionMoveStart(LayerSelection *selection, EditorState *state, LayerHierarchy *hierarchy) {
+    LIST_SHRINK(selection->origins, 0);
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        LIST_ADD(&selection->origins, LayerHierarchyWorld(hierarchy, layerIdx).o);
+    }
+}
+
+void LayerSelectionMove(LayerSelection *selection, EditorState *state, LayerHierarchy *hierarchy, Vector2 offset) {
+    assert(LIST_COUNT(selection->origins) == state->layerCount);
+    offset = Vector2Round(offset);
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        if (!selection->selected[layerIdx] || AncestorSelected(selection, state, layerIdx)) continue;
+        // Layers with keys move on the current frame only, the same as dragging a single one.
+        // None of the ancestors move, so the parent's world transform from before the move still holds.
+        Layer *layer = state->layers + layerIdx;
+        Transform2DCached parentWorld = LayerHierarchyWorldCached(hierarchy, layer->parent);
+        Vector2 *position;
+        Shape *shape;
+        LayerEditTarget(layer, state->frameIdx, &position, &shape);
+        *position = Vector2Round(Transform2DCachedToLocal(&parentWorld, Vector2Add(selection->origins[layerIdx], offset)));
+        if (LIST_COUNT(layer->keys) > 0) LayerKeysBake(layer);
+    }
+}
+
+void LayerSelectionScale(LayerSelection *selection, EditorState *state, LayerHierarchy *hierarchy, float scale) {
+    if (selection->count == 0) return;
+
+    Vector2 min = {INFINITY, INFINITY};
+    Vector2 max = {-INFINITY, -INFINITY};
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        if (!selection->selected[layerIdx]) continue;
+        Vector2 origin = LayerHierarchyWorld(hierarchy, layerIdx).o;
+        min = (Vector2) {fminf(min.x, origin.x), fminf(min.y, origin.y)};
+        max = (Vector2) {fmaxf(max.x, origin.x), fmaxf(max.y, origin.y)};
+    }
+    Vector2 center = Vector2Round(Vector2Scale(Vector2Add(min, max), 0.5f));
+
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        if (!selection->selected[layerIdx]) continue;
+        Layer *layer = state->layers + layerIdx;
+        // Positions are relative to the parent, so the center is moved into the parent's space.
+        Vector2 pivot = VECTOR2_ZERO;
+        if (!AncestorSelected(selection, state, layerIdx)) {
+            Transform2DCached parentWorld = LayerHierarchyWorldCached(hierarchy, layer->parent);
+            pivot = Transform2DCachedToLocal(&parentWorld, center);
+        }
+        // Scaling covers every frame, so keys are all scaled around the same pivot.
+        for (int keyIdx = 0; keyIdx < LIST_COUNT(layer->keys); keyIdx++) {
+            Vector2 *position = &layer->keys[keyIdx].value.position;
+            *position = Vector2Round(Vector2Add(pivot, Vector2Scale(Vector2Subtract(*position, pivot), scale)));
+        }
+        Vector2 offset = Vector2Scale(Vector2Subtract(layer->transform.o, pivot), scale);
+        layer->transform.o = Vector2Round(Vector2Add(pivot, offset));
+        LayerScale(layer, scale); // Bakes the keys.
+    }
+}
+
+int LayerSelectionParentSet(LayerSelection *selection, EditorState *state, LayerHierarchy *hierarchy, int parent) {
+    // A layer that changes parent keeps its world position, so none of the world transforms read here change
+    // during the loop: the parent can't be a descendant of a layer that changes, or that layer would be its own ancestor.
+    Transform2DCached parentWorld = LayerHierarchyWorldCached(hierarchy, parent);
+    int changed = 0;
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        Layer *layer = state->layers + layerIdx;
+        if (!selection->selected[layerIdx] || layerIdx == parent || layer->parent == parent) continue;
+        Vector2 origin = LayerHierarchyWorld(hierarchy, layerIdx).o;
+        if (!EditorStateLayerParentSet(state, layerIdx, parent)) continue;
+
+        Vector2 position = Vector2Round(Transform2DCachedToLocal(&parentWorld, origin));
+        Vector2 shift = Vector2Subtract(position, LayerSampleAt(layer, state->frameIdx).position);
+        layer->transform.o = Vector2Add(layer->transform.o, shift);
+        for (int keyIdx = 0; keyIdx < LIST_COUNT(layer->keys); keyIdx++) {
+            Vector2 *keyPosition = &layer->keys[keyIdx].value.position;
+            *keyPosition = Vector2Add(*keyPosition, shift);
+        }
+        if (LIST_COUNT(layer->keys) > 0) LayerKeysBake(layer);
+        changed++;
+    }
+    return changed;
+}
+
+void LayerSelectionFrameToggle(LayerSelection *selection, EditorState *state, int frame) {
+    bool allActive = true;
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        if (selection->selected[layerIdx] && !state->layers[layerIdx].framesActive[frame]) allActive = false;
+    }
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        if (!selection->selected[layerIdx]) continue;
+        if (state->layers[layerIdx].framesActive[frame] == allActive) LayerFrameToggle(state->layers + layerIdx, frame);
+    }
+}
+
+void LayerSelectionKeyToggle(LayerSelection *selection, EditorState *state, int frame) {
+    bool allKeyed = true;
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        if (selection->selected[layerIdx] && !LayerKeyOnFrame(state->layers + layerIdx, frame)) allKeyed = false;
+    }
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        if (!selection->selected[layerIdx]) continue;
+        if (LayerKeyOnFrame(state->layers + layerIdx, frame) == allKeyed) LayerKeyToggle(state->layers + layerIdx, frame);
+    }
+}
+
+int LayerSelectionTemplateLink(LayerSelection *selection, EditorState *state, const char *name) {
+    int changed = 0;
+    for (int layerIdx = 0; layerIdx < state->layerCount; layerIdx++) {
+        if (selection->selected[layerIdx] && EditorStateTemplateLink(state, layerIdx, name)) changed++;
+    }
+    return changed;
+}
@@ -0,0 +1,58 @@
+#ifndef LAYER_SELECTION_H
+#define LAYER_SELECTION_H
+
+#include <stdbool.h>
+#include "raylib.h"
+#include "editor_history.h"
+#include "layer_hierarchy.h"
+#include "list.h"
+
+// Set of layers that bulk operations apply to. Lives next to the state instead of in it, so it isn't part of the
+// history or the saved file. The selected layer of the state is always part of the set.
+// Every operation changes all the layers in one go and leaves committing to the caller, so a bulk edit is a
+// single history entry no matter how many layers it touches.
+typedef struct LayerSelection {
+    LIST(bool) selected; // One per layer.
+    int count;
+    LIST(Rectangle) bounds; // Layer bounds on the frame of the last LayerSelectionBoundsUpdate. Negative width if empty.
+    LIST(Vector2) origins; // Layer origins when the current move started.
+    LIST(Vector2) scratch;
+} LayerSelection;
+
+LayerSelection LayerSelectionNew(void);
+void LayerSelectionFree(LayerSelection *selection);
+// Follows the state after layers are added, removed or changed through the history, and after the selected layer
+// changed. Falls back to just the selected layer when the set no longer fits the state.
+void LayerSelectionSync(LayerSelection *selection, EditorState *state);
+void LayerSelectionClear(LayerSelection *selection);
+
+// The hierarchy passed to the functions below has to be up to date with the state on the current frame.
+
+// Caches the bounds of every layer on the current frame. Done once when a box drag starts since the layers can't
+// change during it, so following the box each tick only tests rectangles.
+void LayerSelectionBoundsUpdate(LayerSelection *selection, EditorState *state, LayerHierarchy *hierarchy);
+// Selects exactly the layers whose cached bounds overlap box, in sprite space, and makes the first of them the
+// selected layer of the state. Returns how many were selected.
+int LayerSelectionBox(LayerSelection *selection, EditorState *state, Rectangle box);
+
+void LayerSelectionMoveStart(LayerSelection *selection, EditorState *state, LayerHierarchy *hierarchy);
+// Moves the selected layers by offset in sprite space from where they were on the current frame at
+// LayerSelectionMoveStart. Layers whose parent or further ancestor is selected as well move along with it instead.
+void LayerSelectionMove(LayerSelection *selection, EditorState *state, LayerHierarchy *hierarchy, Vector2 offset);
+// Scales the selected layers and the distances between their origins around the middle of the origins on the
+// current frame. Keys are scaled too, so the whole animation scales. Layers with a selected ancestor scale their
+// distance to their parent instead.
+void LayerSelectionScale(LayerSelection *selection, EditorState *state, LayerHierarchy *hierarchy, float scale);
+// Makes parent the parent of every other selected layer, or detaches them from their parents with -1. Each one keeps
+// its place on the current frame by moving its position and keys by the same amount. Layers that would become their
+// own ancestor are skipped. Returns how many layers changed parent.
+int LayerSelectionParentSet(LayerSelection *selection, EditorState *state, LayerHierarchy *hierarchy, int parent);
+// Enables the selected layers on the frame, or disables them if they were all enabled already.
+void LayerSelectionFrameToggle(LayerSelection *selection, EditorState *state, int frame);
+// Adds keys on the frame to the selected layers, or removes them if they all had one already.
+void LayerSelectionKeyToggle(LayerSelection *selection, EditorState *state, int frame);
+// Links the selected layers to the template named name, or unlinks them for NULL. Layers without hitbox or shape
+// values are skipped. Returns how many layers were linked or unlinked.
+int LayerSelectionTemplateLink(LayerSelection *selection, EditorState *state, const char *name);
+
+#endif
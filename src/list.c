@@ -2,9 +2,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "allocator.h"
 #include "list.h"
 
-void *ListNew(int itemSize, int count) {
+void *ListNew(int itemSize, int count, const char *tag) {
     int countAllocated;
     if (count <= 0) {
         count = 0;
@@ -14,7 +15,7 @@ void *ListNew(int itemSize, int count) {
     } else {
         countAllocated = count;
     }
-    ListHeader *header = malloc(sizeof(ListHeader) + itemSize * countAllocated);
+    ListHeader *header = AllocatorResize(NULL, 0, sizeof(ListHeader) + itemSize * countAllocated, tag);
     *header = (ListHeader) {
         .count = count,
         .countAllocated = countAllocated,
@@ -23,35 +24,80 @@ void *ListNew(int itemSize, int count) {
     return (void *) (header + 1);
 }
 
-void *ListClone(LIST(void) list) {
+void ListFree(LIST(void) list, const char *tag) {
+    AllocatorResize(LIST_HEADER(list), LIST_SIZE_ALLOCATED(list), 0, tag);
+}
+
+void *ListClone(LIST(void) list, const char *tag) {
     ListHeader *header = LIST_HEADER(list);
     int size = sizeof(ListHeader) + header->count * header->itemSize;
-    ListHeader *headerNew = malloc(size);
+    ListHeader *headerNew = AllocatorResize(NULL, 0, size, tag);
     memcpy(headerNew, header, size);
+    headerNew->countAllocated = header->count; // Only count items were allocated.
     return (void *) (headerNew + 1);
 }
 
-void ListAddMany(LIST(void) *list, LIST(void) listEnd) {
+ListHeader *ListGrow(LIST(void) *list, const char *tag) {
     ListHeader *header = LIST_HEADER(*list);
+    size_t oldSize = LIST_SIZE_ALLOCATED(*list);
+    if (header->countAllocated < LIST_ALLOC_MINIMUM) header->countAllocated = LIST_ALLOC_MINIMUM;
+    else header->countAllocated = ((float) header->countAllocated * 1.5f);
+    header = AllocatorResize(header, oldSize, sizeof(ListHeader) + header->itemSize * header->countAllocated, tag);
+    *list = (void *) (header + 1);
+    return header;
+}
+
+void ListAddMany(LIST(void) *list, LIST(void) listEnd, const char *tag) {
     ListHeader *headerEnd = LIST_HEADER(listEnd);
-    assert(header->itemSize == headerEnd->itemSize);
-    
-    int headerCountNew = header->count + headerEnd->count;
-    if (headerCountNew > header->countAllocated) {
-        int alloc = 0;
-        
-        if (headerCountNew < LIST_ALLOC_MINIMUM) {
-            alloc = LIST_ALLOC_MINIMUM;
-        } else if (headerCountNew < ((float) header->countAllocated) * 1.5f) {
-            alloc = ((float) header->countAllocated) * 1.5f;
-        } else {
-            alloc = headerCountNew;
-        }
-
-        header = realloc(header, sizeof(ListHeader) + header->itemSize * alloc);
-        header->countAllocated = alloc;
-        *list = (void *) (header + 1);
-    } 
-    memcpy(*list + header->itemSize * header->count, listEnd, headerEnd->count * headerEnd->itemSize);
-    header->count = headerCountNew;
+    assert(LIST_HEADER(*list)->itemSize == headerEnd->itemSize);
+    ListAddArray(list, listEnd, headerEnd->count, tag);
+}
+
+// Grows the allocation so it holds at least countNeeded items, by 1.5x when that is enough.
+static ListHeader *ListFit(LIST(void) *list, int countNeeded, const char *tag) {
+    ListHeader *header = LIST_HEADER(*list);
+    if (countNeeded <= header->countAllocated) return header;
+
+    int alloc = 0;
+    if (countNeeded < LIST_ALLOC_MINIMUM) {
+        alloc = LIST_ALLOC_MINIMUM;
+    } else if (countNeeded < ((float) header->countAllocated) * 1.5f) {
+        alloc = ((float) header->countAllocated) * 1.5f;
+    } else {
+        alloc = countNeeded;
+    }
+
+    header = AllocatorResize(header, LIST_SIZE_ALLOCATED(*list), sizeof(ListHeader) + header->itemSize * alloc, tag);
+    header->countAllocated = alloc;
+    *list = (void *) (header + 1);
+    return header;
+}
+
+void ListAddArray(LIST(void) *list, const void *items, int count, const char *tag) {
+    ListHeader *header = ListFit(list, LIST_HEADER(*list)->count + count, tag);
+    memcpy((char *) *list + header->itemSize * header->count, items, count * header->itemSize);
+    header->count += count;
+}
+
+void ListReserve(LIST(void) *list, int count, const char *tag) {
+    ListFit(list, count, tag);
+}
+
+void ListInsertGap(LIST(void) *list, int idx, int count, const char *tag) {
+    ListHeader *header = LIST_HEADER(*list);
+    assert(0 <= idx && idx <= header->count && count >= 0);
+    header = ListFit(list, header->count + count, tag);
+    char *data = *list;
+    size_t itemSize = header->itemSize;
+    memmove(data + itemSize * (idx + count), data + itemSize * idx, itemSize * (header->count - idx));
+    header->count += count;
+}
+
+void ListRemoveRange(LIST(void) list, int idx, int count) {
+    ListHeader *header = LIST_HEADER(list);
+    assert(0 <= idx && count >= 0 && idx + count <= header->count);
+    char *data = list;
+    size_t itemSize = header->itemSize;
+    memmove(data + itemSize * idx, data + itemSize * (idx + count), itemSize * (header->count - idx - count));
+    header->count -= count;
 }
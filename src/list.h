@@ -2,6 +2,7 @@
 #define LIST_H
 
 #include <stdlib.h>
+#include "allocator.h"
 
 #define LIST_ALLOC_MINIMUM 4
 
@@ -14,31 +15,33 @@ typedef struct ListHeader {
     int countAllocated;
     int itemSize;
     int ___; // @todo: This is so asan won't complain about the members of the list being misaligned.
-    // Might want a custom allocator here in the future.
 } ListHeader;
 
+// Lists allocate through allocator.h. The macros pass their call site as the allocation tag.
+
 #define LIST(T) T *
-void *ListNew(int itemSize, int count);
-#define LIST_NEW(T) ((T *) ListNew(sizeof(T), 0))
-#define LIST_NEW_SIZED(T, count) ((T *) ListNew(sizeof(T), count))
+void *ListNew(int itemSize, int count, const char *tag);
+#define LIST_NEW(T) ((T *) ListNew(sizeof(T), 0, ALLOCATOR_TAG))
+#define LIST_NEW_SIZED(T, count) ((T *) ListNew(sizeof(T), count, ALLOCATOR_TAG))
 
 #define LIST_HEADER(list) (((ListHeader *) (list)) - 1)
 #define LIST_COUNT(list) LIST_HEADER(list)->count
-#define LIST_FREE(list) free(LIST_HEADER(list))
+#define LIST_SIZE_ALLOCATED(list) (sizeof(ListHeader) + (size_t) LIST_HEADER(list)->countAllocated * LIST_HEADER(list)->itemSize)
+
+void ListFree(LIST(void) list, const char *tag);
+#define LIST_FREE(list) ListFree(list, ALLOCATOR_TAG)
 
-void *ListClone(LIST(void) list);
-#define LIST_CLONE(T, list) ((T *) ListClone(list))
+void *ListClone(LIST(void) list, const char *tag);
+#define LIST_CLONE(T, list) ((T *) ListClone(list, ALLOCATOR_TAG))
+
+// Grows the allocation by 1.5x. Returns the new header.
+ListHeader *ListGrow(LIST(void) *list, const char *tag);
 
 // I'm pretty sure that 'item' won't be evaluated twice because of the sizeof operator.
 #define LIST_ADD(listPtr, item) \
 do {\
     ListHeader *header = LIST_HEADER(*(listPtr));\
-    if (header->count == header->countAllocated) {\
-        if (header->countAllocated < LIST_ALLOC_MINIMUM) header->countAllocated = LIST_ALLOC_MINIMUM;\
-        else header->countAllocated = ((float) header->countAllocated * 1.5f);\
-        header = (ListHeader *) realloc(header, sizeof(ListHeader) + sizeof(item) * header->countAllocated);\
-        *(listPtr) = (void *) (header + 1);\
-    }\
+    if (header->count == header->countAllocated) header = ListGrow((LIST(void) *) (listPtr), ALLOCATOR_TAG);\
     (*(listPtr))[header->count] = (item);\
     header->count++;\
 } while (0)
@@ -52,7 +55,23 @@ do {\
 } while (0)
 #endif
 
-void ListAddMany(LIST(void) * list, LIST(void) listEnd);
-#define LIST_ADD_MANY(listPtr, listEnd) ListAddMany((LIST(void) *) listPtr, (LIST(void)) listEnd);
+void ListAddMany(LIST(void) * list, LIST(void) listEnd, const char *tag);
+#define LIST_ADD_MANY(listPtr, listEnd) ListAddMany((LIST(void) *) listPtr, (LIST(void)) listEnd, ALLOCATOR_TAG);
+
+// Same as ListAddMany but the items come from a plain array.
+void ListAddArray(LIST(void) *list, const void *items, int count, const char *tag);
+#define LIST_ADD_ARRAY(listPtr, items, count) ListAddArray((LIST(void) *) listPtr, (const void *) items, count, ALLOCATOR_TAG);
+
+// Makes room for count items in total without changing the count.
+void ListReserve(LIST(void) *list, int count, const char *tag);
+#define LIST_RESERVE(listPtr, count) ListReserve((LIST(void) *) listPtr, count, ALLOCATOR_TAG);
+
+// Moves the items from idx on back by count in one go. The count items at idx are left uninitialized.
+void ListInsertGap(LIST(void) *list, int idx, int count, const char *tag);
+#define LIST_INSERT_GAP(listPtr, idx, count) ListInsertGap((LIST(void) *) listPtr, idx, count, ALLOCATOR_TAG);
+
+// Removes count items at idx by moving the ones after them forward in one go.
+void ListRemoveRange(LIST(void) list, int idx, int count);
+#define LIST_REMOVE_RANGE(list, idx, count) ListRemoveRange((LIST(void)) list, idx, count);
 
 
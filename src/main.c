@@ -13,18 +13,34 @@
 #include "raymath.h"
 #include "rlgl.h"
 
+#include "allocator.h"
+#include "build_cache.h"
 #include "editor_history.h"
+#include "export.h"
+#include "files.h"
+#include "handle_grid.h"
 #include "layer.h"
+#include "layer_hierarchy.h"
+#include "layer_selection.h"
 #include "list.h"
+#include "playback.h"
+#include "profiler.h"
+#include "project_index.h"
 #include "string_buffer.h"
+#include "template_table.h"
+#include "text_cache.h"
 #include "transform_2d.h"
 #include "gui.h"
+#include "sprite.h"
+#include "worker_pool.h"
 
 #define FILE_EXTENSION "json"
 #define APP_NAME "Combat Animator"
 #define DEFAULT_SPRITE_WINDOW_X 800
 #define DEFAULT_SPRITE_WINDOW_Y 400
 #define KEY_PLAY_ANIMATION KEY_ENTER
+#define KEY_PLAYBACK_SLOWER KEY_MINUS
+#define KEY_PLAYBACK_FASTER KEY_EQUAL
 #define KEY_FRAME_PREVIOUS KEY_LEFT
 #define KEY_FRAME_NEXT KEY_RIGHT
 #define KEY_LAYER_PREVIOUS KEY_UP
@@ -37,6 +53,9 @@
 #define KEY_FRAME_NEW KEY_N
 #define KEY_FRAME_NEW_MODIFIER KEY_LEFT_ALT
 
+#define KEY_FRAME_DUPLICATE KEY_D
+#define KEY_FRAME_DUPLICATE_MODIFIER KEY_LEFT_ALT
+
 #define KEY_FRAME_REMOVE KEY_BACKSPACE
 #define KEY_FRAME_REMOVE_MODIFIER KEY_LEFT_ALT
 
@@ -46,11 +65,27 @@
 #define KEY_LAYER_NEW_MODIFIER KEY_LEFT_CONTROL
 
 #define KEY_FRAME_TOGGLE KEY_SPACE
+#define KEY_KEYFRAME_TOGGLE KEY_K
+#define KEY_SELECT_BOX_MODIFIER KEY_LEFT_SHIFT
+#define KEY_SELECTION_GROW KEY_RIGHT_BRACKET
+#define KEY_SELECTION_SHRINK KEY_LEFT_BRACKET
+#define KEY_LAYER_PARENT KEY_P
+#define KEY_TEMPLATE KEY_T
+#define KEY_TEMPLATE_UNLINK_MODIFIER KEY_LEFT_SHIFT
+#define SELECTION_SCALE_STEP 1.25f
+#define COLOR_SELECT_BOX (Color) {255, 255, 255, 160}
+#define COLOR_PARENT_LINK (Color) {255, 255, 255, 96}
 #define COLOR_FRAME_POS_HANDLE (Color) {255, 123, 0, 255}
 #define COLOR_FRAME_POS_HANDLE_PREVIOUS (Color) {161, 78, 0, 255}
 
 #define KEY_SAVE KEY_S
 #define KEY_SAVE_MODIFIER KEY_LEFT_CONTROL
+
+#define KEY_PROFILER_OVERLAY KEY_F3
+#define KEY_PROFILER_TRACE KEY_F4
+#define PROFILER_OVERLAY_WIDTH 320.0f
+#define PROFILER_OVERLAY_HEIGHT 360.0f
+#define ALLOCATION_REPORT_SITES 16
 #define SCALE_SPEED 0.9375f
 #define TEXTURE_HEIGHT_IN_WINDOW 0.5f
 
@@ -71,6 +106,8 @@
 
 #define LAYER_ROW_SIZE 32
 #define LAYER_ICON_CIRCLE_RADIUS 12
+#define KEYFRAME_RHOMBUS_RADIUS 5
+#define KEYFRAME_RHOMBUS_COLOR RAYWHITE
 
 // These functions are miscellaneous, I'm just putting them here for now.
 
@@ -106,13 +143,32 @@ bool GuiFlags(Rectangle rect, unsigned int *flags) {
     return flagsChanged;
 }
 
-void DrawRhombus(Vector2 pos, float xSize, float ySize, Color color) {
-    Vector2 topPoint = {pos.x, pos.y - ySize};
-    Vector2 leftPoint = {pos.x - xSize, pos.y};
-    Vector2 rightPoint = {pos.x + xSize, pos.y};
-    Vector2 bottomPoint = {pos.x, pos.y + ySize};
-    DrawTriangle(rightPoint, topPoint, leftPoint, color); // must be in counterclockwise order
-    DrawTriangle(leftPoint, bottomPoint, rightPoint, color);
+// Queues text centered in the rect like GuiLabel draws it.
+void PanelLabel(WindowManager *gui, Rectangle rect, const char *text, Font *font, int fontSize, float fontSpacing) {
+    Vector2 size = TextCacheGet(gui->textCache, *font, (float) fontSize, fontSpacing, text).size;
+    Vector2 pos = {
+        (float) (int) (rect.x + (rect.width - size.x) / 2.0f),
+        (float) (int) (rect.y + (rect.height - (float) fontSize) / 2.0f)
+    };
+    WindowManagerPush(gui, DRAW_KIND_TEXT, DrawCommandString(pos, ArenaStringCopy(&gui->frameArena, text), font, fontSize, RAYWHITE));
+}
+
+// Rectangle between two corners in any order.
+Rectangle SelectBox(Vector2 start, Vector2 end) {
+    return (Rectangle) {fminf(start.x, end.x), fminf(start.y, end.y), fabsf(end.x - start.x), fabsf(end.y - start.y)};
+}
+
+void CommitState(EditorHistory *history, EditorState *state, Profiler *profiler) {
+    ProfilerBegin(profiler, PROFILER_HISTORY);
+    EditorHistoryCommitState(history, state);
+    ProfilerEnd(profiler, PROFILER_HISTORY);
+}
+
+// Renames the selected layer to what was typed. Keeps the old name if the new one is empty or taken.
+void LayerNameEditApply(EditorState *state, const char *edit) {
+    if (!EditorStateLayerRename(state, state->layerIdx, edit)) {
+        printf("Layer name \"%s\" is empty or already used by another layer.\n", edit);
+    }
 }
 
 char *ChangeFileExtension(const char *fileName, const char *newExt) {
@@ -137,7 +193,55 @@ char *ChangeFileExtension(const char *fileName, const char *newExt) {
 }
 
 
-void RecursiveUpdate(const char *path) {
+// With a build cache, files already in the current format (or whose update is cached) are handled without
+// deserializing them. Both the input and the updated output are cached since updating the output again is a no-op.
+static void UpdateFile(const char *path, const char *cacheDirectory) {
+    uint64_t inputKey = 0;
+    // Linked layers only keep what differs from the project's templates, so the output depends on them too.
+    char variant[sizeof("0123456789abcdef")] = "";
+    if (cacheDirectory) {
+        snprintf(variant, sizeof(variant), "%016llx", (unsigned long long) TemplateTableFileHash(path));
+        size_t inputSize;
+        unsigned char *input = FilesRead(path, &inputSize);
+        if (!input) {
+            printf("Failed to read the file at %s. Skipping.\n", path);
+            return;
+        }
+        inputKey = BuildCacheKey(input, inputSize, "update", variant);
+        size_t cachedSize;
+        unsigned char *cached = BuildCacheLoad(cacheDirectory, inputKey, &cachedSize);
+        bool upToDate = cached && cachedSize == inputSize && !memcmp(cached, input, inputSize);
+        free(input);
+        if (cached) {
+            if (upToDate) printf("The combat animation file at %s is up to date.\n", path);
+            else if (FilesWrite(path, cached, cachedSize)) printf("Updated the combat animation file at %s from the build cache.\n", path);
+            else printf("Failed to write the combat animation file at %s.\n", path);
+            free(cached);
+            return;
+        }
+    }
+
+    EditorState state;
+    if (!EditorStateDeserialize(&state, path)) {
+        printf("Failed to read a valid combat animation from the file at %s. Skipping.\n", path);
+        return;
+    }
+    bool saved = EditorStateSerialize(&state, path);
+    EditorStateFree(&state);
+    printf("Successfully updated the combat animation file at %s.\n", path);
+
+    if (cacheDirectory && saved) {
+        size_t outputSize;
+        unsigned char *output = FilesRead(path, &outputSize);
+        if (output) {
+            BuildCacheSave(cacheDirectory, inputKey, output, outputSize);
+            BuildCacheSave(cacheDirectory, BuildCacheKey(output, outputSize, "update", variant), output, outputSize);
+        }
+        free(output);
+    }
+}
+
+void RecursiveUpdate(const char *path, const char *cacheDirectory) {
     
     DIR *dir = opendir(path);
     if (!dir) {
@@ -152,7 +256,7 @@ void RecursiveUpdate(const char *path) {
         // it would be very bad if this didn't work
         if (strcmp(directoryEntry->d_name, ".") == 0 || strcmp(directoryEntry->d_name, "..") == 0) continue;
 
-        StringBuffer fullPathBuffer = StringBufferNew();
+        StringBuffer fullPathBuffer = STRING_BUFFER_NEW();
         StringBufferAddString(&fullPathBuffer, path);
         StringBufferAddChar(&fullPathBuffer, '/');
         StringBufferAddString(&fullPathBuffer, directoryEntry->d_name);
@@ -163,34 +267,152 @@ void RecursiveUpdate(const char *path) {
             printf("Failed to obtain information about the file at %s. Skipping.\n", fullPath);
         // no symlink support
         } else if (S_ISDIR(fileStat.st_mode)) {
-            RecursiveUpdate(fullPath);
+            RecursiveUpdate(fullPath, cacheDirectory);
         } else if (S_ISREG(fileStat.st_mode)) {
             char *dot = strrchr(directoryEntry->d_name, '.');            
-            if (dot && strcmp(dot, "."FILE_EXTENSION) == 0) {
-                EditorState state;
-                if (EditorStateDeserialize(&state, fullPath)) {
-                    EditorStateSerialize(&state, fullPath);
-                    EditorStateFree(&state);
-                    printf("Successfully updated the combat animation file at %s.\n", fullPath);
-                } else {
-                    printf("Failed to read a valid combat animation from the file at %s. Skipping.\n", fullPath);
-                }
-            }
+            if (dot && strcmp(dot, "."FILE_EXTENSION) == 0) UpdateFile(fullPath, cacheDirectory);
         }
         free(fullPath);
     }
     closedir(dir);
 }
 
+static Layer TestLayer(EditorState *state, const char *name, int parent, Vector2 position) {
+    Layer layer = {
+        .transform = Transform2DFromPosition(position),
+        .type = LAYER_EMPTY,
+        .parent = parent,
+        .name = name,
+        .framesActive = LIST_NEW_SIZED(bool, state->frameCount),
+        .keys = LIST_NEW(LayerKey),
+        .samples = LIST_NEW(LayerSample)
+    };
+    for (int frame = 0; frame < state->frameCount; frame++) layer.framesActive[frame] = true;
+    return layer;
+}
+
+// Removing a translated parent moves its children, keyed ones included, to the grandparent without moving them.
+static bool TestLayerRemoveKeepsChildren(void) {
+    EditorState state = EditorStateNew(3);
+    EditorStateLayerAdd(&state, TestLayer(&state, "Grandparent", -1, (Vector2) {100, 0}));
+    EditorStateLayerAdd(&state, TestLayer(&state, "Parent", 0, (Vector2) {30, -12}));
+    EditorStateLayerAdd(&state, TestLayer(&state, "Child", 1, (Vector2) {5, 7}));
+    EditorStateLayerAdd(&state, TestLayer(&state, "Keyed", 1, (Vector2) {0, 0}));
+    Layer *keyed = state.layers + 3;
+    LayerKeyToggle(keyed, 0);
+    LayerKeyToggle(keyed, 2);
+    keyed->keys[1].value.position = (Vector2) {-20, 40};
+    LayerKeysBake(keyed);
+
+    LayerHierarchy hierarchy = LayerHierarchyNew();
+    Vector2 before[2][3];
+    for (int frame = 0; frame < state.frameCount; frame++) {
+        LayerHierarchyUpdate(&hierarchy, &state, frame);
+        for (int i = 0; i < 2; i++) before[i][frame] = LayerHierarchyWorld(&hierarchy, 2 + i).o;
+    }
+    bool success = EditorStateLayerRemove(&state, 1) && state.layers[1].parent == 0 && state.layers[2].parent == 0;
+    for (int frame = 0; frame < state.frameCount && success; frame++) {
+        LayerHierarchyUpdate(&hierarchy, &state, frame);
+        for (int i = 0; i < 2; i++) {
+            Vector2 after = LayerHierarchyWorld(&hierarchy, 1 + i).o;
+            if (Vector2Distance(after, before[i][frame]) > 0.001f) success = false;
+        }
+    }
+    LayerHierarchyFree(&hierarchy);
+    EditorStateFree(&state);
+    return success;
+}
+
 int main(int argc, char **argv) {
     if (argc < 2) {
         puts("Please put the name of the png file to make an animation for as the argument to this application.");
         return EXIT_FAILURE;
     }
 
-    if (!strcmp(argv[1], "-u")) { // first argument is to recursively update all files in the given folder.
-        RecursiveUpdate(".");
+    // A build cache is used when a directory is given with -c or in the CAC_CACHE environment variable.
+    const char *cacheDirectory = getenv(BUILD_CACHE_ENVIRONMENT);
+    if (cacheDirectory && !cacheDirectory[0]) cacheDirectory = NULL;
+
+    if (!strcmp(argv[1], "-u")) { // first argument is to recursively update all files in the given folder. cac -u [-c cache]
+        if (argc >= 4 && !strcmp(argv[2], "-c")) cacheDirectory = argv[3];
+        RecursiveUpdate(".", cacheDirectory);
         return EXIT_SUCCESS;
+    } else if (!strcmp(argv[1], "--export")) { // cac --export <json|bin|header|tables|compact> [-o directory] [-j threads] [-f] [-m] [-c cache] [files or directories...]
+        ExportOptions options = {
+            .outputDirectory = EXPORT_DIRECTORY_DEFAULT,
+            .threadCount = WORKER_POOL_THREADS_DEFAULT,
+            .force = false,
+            .cacheDirectory = cacheDirectory
+        };
+        if (argc < 3 || !ExportFormatParse(argv[2], &options.format)) {
+            puts("Usage: cac --export <json|bin|header|tables|compact> [-o directory] [-j threads] [-f] [-m] [-c cache] [files or directories...]");
+            return EXIT_FAILURE;
+        }
+        
+        bool trackMemory = false;
+        LIST(char *) paths = LIST_NEW(char *);
+        for (int i = 3; i < argc; i++) {
+            if (!strcmp(argv[i], "-o") && i + 1 < argc) options.outputDirectory = argv[++i];
+            else if (!strcmp(argv[i], "-j") && i + 1 < argc) options.threadCount = atoi(argv[++i]);
+            else if (!strcmp(argv[i], "-f")) options.force = true;
+            else if (!strcmp(argv[i], "-m")) trackMemory = true;
+            else if (!strcmp(argv[i], "-c") && i + 1 < argc) options.cacheDirectory = argv[++i];
+            else LIST_ADD(&paths, argv[i]);
+        }
+
+        AllocationTracker tracker;
+        if (trackMemory) {
+            AllocationTrackerInit(&tracker, AllocatorGet());
+            AllocatorSet(AllocationTrackerAllocator(&tracker));
+        }
+        if (LIST_COUNT(paths) == 0) LIST_ADD(&paths, ".");
+        if (options.threadCount < 1) options.threadCount = 1;
+        if (options.threadCount > WORKER_POOL_THREADS_MAX) options.threadCount = WORKER_POOL_THREADS_MAX;
+
+        LIST(char *) inputs = LIST_NEW(char *);
+        for (int i = 0; i < LIST_COUNT(paths); i++) {
+            FilesCollect(paths[i], "."FILE_EXTENSION, options.outputDirectory, &inputs);
+        }
+        int failures = ExportRun(inputs, &options);
+        
+        for (int i = 0; i < LIST_COUNT(inputs); i++) free(inputs[i]);
+        LIST_FREE(inputs);
+        LIST_FREE(paths);
+
+        if (trackMemory) {
+            AllocatorSet(tracker.parent);
+            AllocationTrackerPrint(&tracker, stdout, ALLOCATION_REPORT_SITES);
+            AllocationTrackerFree(&tracker);
+        }
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    } else if (!strcmp(argv[1], "--index")) { // cac --index [directory]
+        const char *directory = argc >= 3 ? argv[2] : ".";
+        ProjectIndex index = ProjectIndexLoad(directory);
+        ProjectIndexUpdateStats stats;
+        bool success = !ProjectIndexUpdate(&index, directory, &stats) || ProjectIndexSave(&index, directory);
+        printf("Indexed %i files in %s: %i unchanged, %i unchanged content, %i parsed, %i removed.\n",
+            LIST_COUNT(index.entries), directory, stats.unchanged, stats.touched, stats.parsed, stats.removed);
+        ProjectIndexFree(&index);
+        return success ? EXIT_SUCCESS : EXIT_FAILURE;
+    } else if (!strcmp(argv[1], "--query")) { // cac --query <list|layer NAME|hitbox NAME> [directory]
+        bool named = argc >= 3 && (!strcmp(argv[2], "layer") || !strcmp(argv[2], "hitbox"));
+        if (argc < 3 || (!named && strcmp(argv[2], "list")) || (named && argc < 4)) {
+            puts("Usage: cac --query <list|layer NAME|hitbox NAME> [directory]");
+            return EXIT_FAILURE;
+        }
+        int directoryArg = named ? 4 : 3;
+        const char *directory = argc > directoryArg ? argv[directoryArg] : ".";
+        
+        // Brought up to date first. Unchanged files are only stat'ed so this stays cheap on big projects.
+        ProjectIndex index = ProjectIndexLoad(directory);
+        ProjectIndexUpdateStats stats;
+        if (ProjectIndexUpdate(&index, directory, &stats)) ProjectIndexSave(&index, directory);
+        
+        int matches = 0;
+        if (!named) ProjectIndexPrint(&index, stdout);
+        else matches = ProjectIndexQueryLayer(&index, argv[3], !strcmp(argv[2], "hitbox") ? LAYER_HITBOX : -1, stdout);
+        ProjectIndexFree(&index);
+        return !named || matches > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
     } else if (!strcmp(argv[1], "-t")) {
 
         for (int i = FILE_VERSION_OLDEST; i < FILE_VERSION_CURRENT; i++) { // make sure each version can still deserialize
@@ -201,9 +423,16 @@ int main(int argc, char **argv) {
             if (success) EditorStateFree(&state);
             printf("Version %i Deserialize success: %s\n", i, success ? "yes" : "no");
         }
-        return EXIT_SUCCESS;
+        bool removeSuccess = TestLayerRemoveKeepsChildren();
+        printf("Layer remove keeps children in place: %s\n", removeSuccess ? "yes" : "no");
+        return removeSuccess ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
+    // Tracked so the profiler overlay can show where memory goes.
+    AllocationTracker tracker;
+    AllocationTrackerInit(&tracker, AllocatorGet());
+    AllocatorSet(AllocationTrackerAllocator(&tracker));
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     // We set the window size later so we can expand to have the right number of rows.
     // We need to init the window first so we can load the texture.
@@ -213,19 +442,38 @@ int main(int argc, char **argv) {
     
     const char *name = argv[1];
     
-    StringBuffer textureNameBuffer = StringBufferNew();
-    StringBufferAddString(&textureNameBuffer, name);
-    StringBufferAddString(&textureNameBuffer, ".png");
+    // load state from file or create new state if load failed
+    StringBuffer savePathBuffer = STRING_BUFFER_NEW();
+    StringBufferAddString(&savePathBuffer, name);
+    StringBufferAddString(&savePathBuffer, "."FILE_EXTENSION);
+    char *savePath = StringBufferFree(&savePathBuffer);
 
-    char *textureName = StringBufferFree(&textureNameBuffer);
-    Texture2D texture = LoadTexture(textureName);
-    free(textureName);
+    EditorState state;
+    bool stateLoaded = EditorStateDeserialize(&state, savePath);
+    if (!stateLoaded) {
+        state = EditorStateNew(1);
+        state.sourceType = SpriteSourceDetect(name);
+        TemplateTableRelease(state.templates);
+        state.templates = TemplateTableLoad(savePath);
+    }
 
-    if (texture.id <= 0) {
+    Sprite sprite;
+    if (!SpriteLoad(&sprite, name, state.sourceType)) {
         printf("Failed to load texture.\n");
+        EditorStateFree(&state);
+        free(savePath);
         CloseWindow();
         return EXIT_FAILURE;
     }
+
+    // New animations made from an image sequence start with one frame per image.
+    if (!stateLoaded && SpriteImageCount(&sprite) > 1) {
+        EditorStateFree(&state);
+        state = EditorStateNew(SpriteImageCount(&sprite));
+        state.sourceType = SPRITE_SOURCE_SEQUENCE;
+        TemplateTableRelease(state.templates);
+        state.templates = TemplateTableLoad(savePath);
+    }
    
     GuiSetStyle(DEFAULT, TEXT_COLOR_NORMAL, ColorToInt(RAYWHITE));
     GuiSetStyle(LABEL, TEXT_ALIGNMENT, TEXT_ALIGN_CENTER);
@@ -233,25 +481,20 @@ int main(int argc, char **argv) {
 
     Font fontDefault = GetFontDefault();
     const int fontSize = fontDefault.baseSize;
-    
-    // load state from file or create new state if load failed
-    StringBuffer savePathBuffer = StringBufferNew();
-    StringBufferAddString(&savePathBuffer, name);
-    StringBufferAddString(&savePathBuffer, "."FILE_EXTENSION);
-    char *savePath = StringBufferFree(&savePathBuffer);
-
-    EditorState state;
-    if (!EditorStateDeserialize(&state, savePath)) state = EditorStateNew(1);
+    const float fontSpacing = 1.0f; // What DrawText uses at the default size.
+    // The panel labels and the timeline are queued here and drawn in texture batches at the end of the frame.
+    WindowManager gui = WindowManagerNew();
 
     EditorHistory history = EditorHistoryNew(&state);
 
-    const float startScale = DEFAULT_SPRITE_WINDOW_Y * TEXTURE_HEIGHT_IN_WINDOW / texture.height;
+    Vector2 startFrameSize = SpriteFrameSize(&sprite, &state, 0);
+    const float startScale = DEFAULT_SPRITE_WINDOW_Y * TEXTURE_HEIGHT_IN_WINDOW / startFrameSize.y;
     
 	Transform2D transform = Transform2DIdentity();
     transform = Transform2DSetScale(transform, (Vector2) {.x = startScale, .y = startScale});
 	transform.o = (Vector2) {
-        .x = (DEFAULT_SPRITE_WINDOW_X - texture.width / state.frameCount * startScale) / 2.0f,
-        .y = (DEFAULT_SPRITE_WINDOW_Y - texture.height * startScale) / 2.0f
+        .x = (DEFAULT_SPRITE_WINDOW_X - startFrameSize.x * startScale) / 2.0f,
+        .y = (DEFAULT_SPRITE_WINDOW_Y - startFrameSize.y * startScale) / 2.0f
     };
 
     const int guiInitialHeight = state.layerCount * FRAME_ROW_SIZE + FRAME_ROW_SIZE;
@@ -270,6 +513,8 @@ int main(int argc, char **argv) {
         MODE_PLAYING,
         MODE_DRAGGING_HANDLE,
         MODE_DRAGGING_FRAME_POS,
+        MODE_DRAGGING_SELECTION,
+        MODE_SELECTING_BOX,
         MODE_PANNING_SPRITE,
         MODE_EDIT_FRAME_DURATION,
         MODE_EDIT_LAYER_NAME,
@@ -278,16 +523,46 @@ int main(int argc, char **argv) {
     } Mode;
     Mode mode = MODE_IDLE;
 
-    int playingFrameTime = 0;
+    PlaybackClock playback = PlaybackClockNew(&state, 0, 1.0f, GetTime());
     Handle draggingHandle = HANDLE_NONE;
     Vector2 panningSpriteLocalPos = VECTOR2_ZERO;
+    HandleGrid handleGrid = HandleGridNew();
+    // Updated once per tick after the input, so drawing and the next tick's input share the same world transforms.
+    LayerHierarchy hierarchy = LayerHierarchyNew();
+    LayerHierarchyUpdate(&hierarchy, &state, state.frameIdx);
+    LayerSelection selection = LayerSelectionNew();
+    LayerSelectionSync(&selection, &state);
+    HandleGridUpdate(&handleGrid, &state, &hierarchy, selection.selected);
+    Vector2 selectionStartLocalPos = VECTOR2_ZERO;
+    int layerNameEditSize = LAYER_NAME_BUFFER_INITIAL_SIZE;
+    char *layerNameEdit = malloc(layerNameEditSize);
+    layerNameEdit[0] = '\0';
+
+    // Large because of the ring buffers.
+    Profiler *profiler = malloc(sizeof(Profiler));
+    ProfilerInit(profiler);
      
     while (!WindowShouldClose()) {
+        long long allocations;
+        AllocationTrackerTotals(&tracker, &allocations, NULL, NULL);
+        ProfilerFrameStart(profiler, allocations);
+        ProfilerBegin(profiler, PROFILER_INPUT);
+
+        if (IsKeyPressed(KEY_PROFILER_OVERLAY)) {
+            profiler->overlay = !profiler->overlay;
+        } else if (IsKeyPressed(KEY_PROFILER_TRACE)) {
+            if (ProfilerWriteTrace(profiler, PROFILER_TRACE_PATH)) printf("Wrote profiler trace to %s\n", PROFILER_TRACE_PATH);
+            else printf("Failed to write profiler trace to %s\n", PROFILER_TRACE_PATH);
+        }
 
+        // The mouse is taken into sprite space once per tick through the view's cached inverse. Zooming keeps the
+        // point under the mouse where it is, so the result stays right after it. Panning changes the view afterwards,
+        // but nothing else uses the mouse in a tick that pans.
         Vector2 mousePos = GetMousePosition();
+        Transform2DCached view = Transform2DCache(transform);
+        Vector2 localMousePos = Transform2DCachedToLocal(&view, mousePos);
         const float mouseWheel = GetMouseWheelMove();
         if (mouseWheel != 0.0f) {
-            Vector2 localMousePos = Transform2DToLocal(transform, mousePos);
             float scaleSpeed = mouseWheel > 0.0f ? 1.0f / SCALE_SPEED : SCALE_SPEED;
             Vector2 scale = {.x = scaleSpeed, .y = scaleSpeed};
             transform = Transform2DScale(transform, scale);
@@ -300,32 +575,48 @@ int main(int argc, char **argv) {
             case MODE_EDIT_HITBOX_STUN:
             case MODE_EDIT_LAYER_NAME:
                 if (IsKeyPressed(KEY_ENTER)) {
-                    EditorHistoryCommitState(&history, &state);
+                    if (mode == MODE_EDIT_LAYER_NAME) LayerNameEditApply(&state, layerNameEdit);
+                    CommitState(&history, &state, profiler);
                     mode = MODE_IDLE;
                 }
                 break;
 
             case MODE_DRAGGING_HANDLE:
                 if (IsMouseButtonReleased(MOUSE_BUTTON_SELECT)) {
-                    EditorHistoryCommitState(&history, &state);
+                    CommitState(&history, &state, profiler);
                     mode = MODE_IDLE;
                 } else {
-                    Vector2 localMousePos = Transform2DToLocal(transform, mousePos);
                     bool snapping = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
-                    assert(LayerHandleSet(state.layers + state.layerIdx, state.frameIdx, draggingHandle, localMousePos, snapping));
+                    Transform2DCached parentWorld = LayerHierarchyWorldCached(&hierarchy, state.layers[state.layerIdx].parent);
+                    Transform2DCached world = LayerHierarchyWorldCached(&hierarchy, state.layerIdx);
+                    assert(LayerHandleSet(state.layers + state.layerIdx, state.frameIdx, &parentWorld, &world, draggingHandle, localMousePos, snapping));
                 }
                 break;
 
             case MODE_DRAGGING_FRAME_POS:
                 if (IsMouseButtonReleased(MOUSE_BUTTON_SELECT)) {
-                    EditorHistoryCommitState(&history, &state);
+                    CommitState(&history, &state, profiler);
                     mode = MODE_IDLE;
                 } else {
-                    Vector2 localMousePos = Transform2DToLocal(transform, mousePos);
                     state.frames[state.frameIdx].pos = Vector2Round(localMousePos);
                 }
                 break;
 
+            case MODE_DRAGGING_SELECTION:
+                if (IsMouseButtonReleased(MOUSE_BUTTON_SELECT)) {
+                    CommitState(&history, &state, profiler);
+                    mode = MODE_IDLE;
+                } else {
+                    LayerSelectionMove(&selection, &state, &hierarchy, Vector2Subtract(localMousePos, selectionStartLocalPos));
+                }
+                break;
+
+            case MODE_SELECTING_BOX:
+                // Selecting doesn't change the state so there is nothing to commit.
+                LayerSelectionBox(&selection, &state, SelectBox(selectionStartLocalPos, localMousePos));
+                if (IsMouseButtonReleased(MOUSE_BUTTON_SELECT)) mode = MODE_IDLE;
+                break;
+
             case MODE_PANNING_SPRITE:
                 if (IsMouseButtonReleased(MOUSE_BUTTON_SELECT)) {
                     mode = MODE_IDLE;
@@ -346,77 +637,79 @@ int main(int argc, char **argv) {
                     ChangeOptions option = CHANGE_UNDO;
                     if (IsKeyDown(KEY_REDO_MODIFIER)) option = CHANGE_REDO;
 
+                    ProfilerBegin(profiler, PROFILER_HISTORY);
                     EditorHistoryChangeState(&history, &state, option);
+                    ProfilerEnd(profiler, PROFILER_HISTORY);
 
                 } else if (IsKeyPressed(KEY_FRAME_NEW) && IsKeyDown(KEY_FRAME_NEW_MODIFIER)) {
-                    EditorStateAddFrame(&state, state.frameIdx);
-                    state.frameIdx = state.frameCount - 1;
-                    EditorHistoryCommitState(&history, &state);
+                    EditorStateFramesInsert(&state, state.frameIdx + 1, 1);
+                    state.frameIdx++;
+                    CommitState(&history, &state, profiler);
+                    mode = MODE_IDLE;
+
+                } else if (IsKeyPressed(KEY_FRAME_DUPLICATE) && IsKeyDown(KEY_FRAME_DUPLICATE_MODIFIER)) {
+                    EditorStateFramesDuplicate(&state, state.frameIdx, 1);
+                    state.frameIdx++;
+                    CommitState(&history, &state, profiler);
                     mode = MODE_IDLE;
                 
                 } else if (IsKeyPressed(KEY_FRAME_REMOVE) && IsKeyDown(KEY_FRAME_REMOVE_MODIFIER) && state.frameCount > 1) {
-                    EditorStateRemoveFrame(&state, state.frameIdx);
+                    EditorStateFramesRemove(&state, state.frameIdx, 1);
                     if (state.frameIdx >= state.frameCount) state.frameIdx = state.frameCount - 1;
-                    EditorHistoryCommitState(&history, &state);
+                    CommitState(&history, &state, profiler);
                     mode = MODE_IDLE;
 
                 } else if (IsKeyPressed(KEY_LAYER_REMOVE) && IsKeyDown(KEY_LAYER_REMOVE_MODIFIER) && state.layerIdx >= 0) {
                     EditorStateLayerRemove(&state, state.layerIdx);
-                    EditorHistoryCommitState(&history, &state);
+                    CommitState(&history, &state, profiler);
                     mode = MODE_IDLE;
                 
                 } else if (IsKeyPressed(KEY_FRAME_TOGGLE)) {
                     if (state.layerIdx < 0) {
                         state.frames[state.frameIdx].canCancel = !state.frames[state.frameIdx].canCancel;
                     } else {
-                        Layer *layer = state.layers + state.layerIdx;
-                        
-                        bool active = !layer->framesActive[state.frameIdx];
-                        layer->framesActive[state.frameIdx] = active;
-                        
-                        if (active && layer->type == LAYER_BEZIER) { // Initialize a new bezier point
-
-                            BezierPoint point;
-                            point.extentsLeft = 10.0f,
-                            point.extentsRight = 10.0f,
-                            point.rotation = 0.0f;
-                            
-                            // If the points around this bezier are enabled, interpolate between them to find the bezier position.
-                            bool surroundingPoints = 
-                                state.frameCount >= 3 
-                                && state.frameIdx > 0 
-                                && state.frameIdx < state.frameCount - 1
-                                && layer->framesActive[state.frameIdx - 1]
-                                && layer->framesActive[state.frameIdx + 1];
-                            
-                            if (surroundingPoints) { // Lerp between surrouding points if they exist
-                                BezierPoint prev = layer->bezierPoints[state.frameIdx - 1];
-                                BezierPoint next = layer->bezierPoints[state.frameIdx + 1];
-                                point.position = Vector2Lerp(prev.position, next.position, 0.5f);
-                            } else if (state.frameIdx < state.frameCount - 1 && layer->framesActive[state.frameIdx + 1]) {
-                                Vector2 origin = layer->bezierPoints[state.frameIdx + 1].position;
-                                origin.x -= 10.0f;
-                                point.position = origin;
-                            } else if (state.frameIdx > 0 && layer->framesActive[state.frameIdx - 1]) {
-                                Vector2 origin = layer->bezierPoints[state.frameIdx - 1].position;
-                                origin.x += 10.0f;
-                                point.position = origin;
-                            } else {
-                                point.position = (Vector2) {0.0f, 0.0f};    
-                            }
-
-                            layer->bezierPoints[state.frameIdx] = point;
-                        }     
+                        LayerSelectionFrameToggle(&selection, &state, state.frameIdx);
                     }
                     mode = MODE_IDLE;
-                    EditorHistoryCommitState(&history, &state);
+                    CommitState(&history, &state, profiler);
                 
+                } else if (IsKeyPressed(KEY_KEYFRAME_TOGGLE) && selection.count > 0) {
+                    LayerSelectionKeyToggle(&selection, &state, state.frameIdx);
+                    mode = MODE_IDLE;
+                    CommitState(&history, &state, profiler);
+
+                } else if ((IsKeyPressed(KEY_SELECTION_GROW) || IsKeyPressed(KEY_SELECTION_SHRINK)) && selection.count > 0) {
+                    LayerSelectionScale(&selection, &state, &hierarchy, IsKeyPressed(KEY_SELECTION_GROW) ? SELECTION_SCALE_STEP : 1.0f / SELECTION_SCALE_STEP);
+                    mode = MODE_IDLE;
+                    CommitState(&history, &state, profiler);
+
+                } else if (IsKeyPressed(KEY_LAYER_PARENT) && selection.count > 0) {
+                    // Several selected layers get attached to the selected layer of the state, a single one detached.
+                    int parent = selection.count > 1 ? state.layerIdx : -1;
+                    if (LayerSelectionParentSet(&selection, &state, &hierarchy, parent) > 0) CommitState(&history, &state, profiler);
+                    mode = MODE_IDLE;
+
+                } else if (IsKeyPressed(KEY_TEMPLATE) && selection.count > 0) {
+                    // The selected layer of the state becomes the template named after it and the rest follow it.
+                    // The table is saved right away since it belongs to the project, not to this animation's history.
+                    if (IsKeyDown(KEY_TEMPLATE_UNLINK_MODIFIER)) {
+                        if (LayerSelectionTemplateLink(&selection, &state, NULL) > 0) CommitState(&history, &state, profiler);
+                    } else if (state.templates->readOnly) {
+                        printf("The templates in %s couldn't be read, fix the file to change them.\n", state.templates->path);
+                    } else if (state.layerIdx >= 0 && EditorStateTemplateSave(&state, state.layerIdx, state.layers[state.layerIdx].name)) {
+                        LayerSelectionTemplateLink(&selection, &state, state.layers[state.layerIdx].name);
+                        if (!TemplateTableSave(state.templates)) puts("Failed to save the templates.");
+                        CommitState(&history, &state, profiler);
+                    }
+                    mode = MODE_IDLE;
+
                 } else if (IsKeyDown(KEY_LAYER_NEW_MODIFIER)) { // VERY IMPORTANT THAT THIS IS THE LAST CALL THAT CHECKS KEY_LEFT_CTRL
                     Layer layer;
+                    Vector2 frameSize = SpriteFrameSize(&sprite, &state, state.frameIdx);
                     layer.transform = Transform2DIdentity();
                     layer.transform.o = (Vector2) { // spawn at the center of the frame.
-                            .x = (float) (texture.width / (state.frameCount * 2)),
-                            .y = (float) (texture.height / 2)
+                            .x = floorf(frameSize.x / 2.0f),
+                            .y = floorf(frameSize.y / 2.0f)
                     };
                     
 
@@ -460,44 +753,61 @@ int main(int argc, char **argv) {
                         goto layerNotInstanced;
                     }
                 
-                    layer.nameBufferLength = LAYER_NAME_BUFFER_INITIAL_SIZE;
-                    layer.name = malloc(layer.nameBufferLength);                    
-                    // Right now we are not enforcing the uniqueness of layer names.
-                    snprintf(layer.name, layer.nameBufferLength, "Layer %i", state.layerCount);
+                    // Gets a number appended if another layer already has the name.
+                    char name[LAYER_NAME_BUFFER_INITIAL_SIZE];
+                    snprintf(name, sizeof(name), "Layer %i", state.layerCount);
+                    layer.name = name;
 
                     layer.framesActive = LIST_NEW_SIZED(bool, state.frameCount);
                     memset(layer.framesActive, 0, sizeof(bool) * state.frameCount);
+                    layer.keys = LIST_NEW(LayerKey);
+                    layer.samples = LIST_NEW(LayerSample);
+                    layer.parent = -1;
+                    layer.templateName = NULL;
+                    layer.templateOverrides = 0;
                     
                     EditorStateLayerAdd(&state, layer);
                     state.layerIdx = state.layerCount - 1;
-                    EditorHistoryCommitState(&history, &state);
+                    CommitState(&history, &state, profiler);
                     mode = MODE_IDLE;
 
                     layerNotInstanced:;// don't add the layer.
                 } else if (IsMouseButtonPressed(MOUSE_BUTTON_SELECT)) {
-                    if (HandleIsColliding(transform, mousePos, state.frames[state.frameIdx].pos)) {
-                        mode = MODE_DRAGGING_FRAME_POS;
-                    } else {
-                        if (state.layerIdx >= 0) {
-                            draggingHandle = LayerHandleSelect(state.layers + state.layerIdx, state.frameIdx, transform, mousePos);
+                    // The handles of every selected layer can be grabbed, grabbing one on another layer makes it the current one.
+                    HandleGridHit hit;
+                    if (IsKeyDown(KEY_SELECT_BOX_MODIFIER)) {
+                        LayerSelectionBoundsUpdate(&selection, &state, &hierarchy);
+                        selectionStartLocalPos = localMousePos;
+                        mode = MODE_SELECTING_BOX;
+                    } else if (HandleGridPick(&handleGrid, localMousePos, HANDLE_RADIUS / Vector2Length(transform.x), state.layerIdx, &hit)) {
+                        if (hit.layerIdx == HANDLE_GRID_FRAME_POS) {
+                            mode = MODE_DRAGGING_FRAME_POS;
+                        } else if (hit.handle == HANDLE_CENTER && selection.count > 1 && selection.selected[hit.layerIdx]) {
+                            // Dragging the origin of one of several selected layers moves all of them.
+                            LayerSelectionMoveStart(&selection, &state, &hierarchy);
+                            selectionStartLocalPos = localMousePos;
+                            mode = MODE_DRAGGING_SELECTION;
                         } else {
-                            draggingHandle = HANDLE_NONE;
-                        }
-
-                        if (draggingHandle != HANDLE_NONE) {
+                            state.layerIdx = hit.layerIdx;
+                            draggingHandle = hit.handle;
                             mode = MODE_DRAGGING_HANDLE;
-                        } else {
-                            panningSpriteLocalPos = Transform2DToLocal(transform, mousePos);
-                            mode = MODE_PANNING_SPRITE;
                         }
+                    } else {
+                        draggingHandle = HANDLE_NONE;
+                        panningSpriteLocalPos = localMousePos;
+                        mode = MODE_PANNING_SPRITE;
                     }
                 } else if (IsKeyPressed(KEY_PLAY_ANIMATION)) {
                     if (mode == MODE_PLAYING) {
                         mode = MODE_IDLE;
                     } else {
                         mode = MODE_PLAYING;
-                        playingFrameTime = 0;
+                        playback = PlaybackClockNew(&state, state.frameIdx, playback.speed, GetTime());
                     }
+                } else if (IsKeyPressed(KEY_PLAYBACK_SLOWER)) {
+                    PlaybackClockSetSpeed(&playback, playback.speed / 2.0f, GetTime());
+                } else if (IsKeyPressed(KEY_PLAYBACK_FASTER)) {
+                    PlaybackClockSetSpeed(&playback, playback.speed * 2.0f, GetTime());
                 } else {
                     int frameDir = (IsKeyPressed(KEY_FRAME_NEXT) ? 1 : 0) - (IsKeyPressed(KEY_FRAME_PREVIOUS) ? 1 : 0);
                     if (frameDir) {
@@ -520,19 +830,19 @@ int main(int argc, char **argv) {
 
         // playing tick update (not related to model)
         if (mode == MODE_PLAYING) {
-            playingFrameTime += (int) (GetFrameTime() * FRAME_DURATION_UNIT_PER_SECOND);
-            int frameDuration = state.frames[state.frameIdx].duration;
-            if (playingFrameTime >= frameDuration)
-            {
-                playingFrameTime -= frameDuration;
-                int newFrameIdx = state.frameIdx + 1;
-                state.frameIdx = newFrameIdx >= state.frameCount ? 0 : newFrameIdx;
-            }
+            state.frameIdx = PlaybackClockFrame(&playback, &state, GetTime());
         }
+        LayerSelectionSync(&selection, &state);
+        LayerHierarchyUpdate(&hierarchy, &state, state.frameIdx);
+        // Every change to the state, the frame or the selection happens above, so clicks only have to pick.
+        HandleGridUpdate(&handleGrid, &state, &hierarchy, selection.selected);
         
+        ProfilerEnd(profiler, PROFILER_INPUT);
+
         // drawing
         BeginDrawing();
         ClearBackground(COLOR_BACKGROUND);
+        WindowManagerStart(&gui);
 
         int windowX = GetScreenWidth();
         int windowY = GetScreenHeight();
@@ -540,46 +850,66 @@ int main(int argc, char **argv) {
         int timelineY = hitboxRowY - FRAME_ROW_SIZE;
         int timelineHeight = windowY - timelineY;
         
-        // draw texture
+        // Everything in the sprite's space is drawn under one view matrix. Handles are scaled down by the zoom so
+        // they stay the same size on screen.
         rlPushMatrix();
         rlTransform2DXForm(transform);
-        float frameWidth = texture.width / state.frameCount;
-        Rectangle source = {
-            .x = frameWidth * state.frameIdx, 
-            .y = 0.0f, 
-            .width = frameWidth, 
-            .height = texture.height
-        };
-        Rectangle dest = {
-            .x = 0.0f,
-            .y = 0.0f,
-            .width = frameWidth,
-            .height = texture.height
-        };
-        DrawTexturePro(texture, source, dest, VECTOR2_ZERO, 0.0f, WHITE);
-        rlPopMatrix();
+        float handleScale = 1.0f / Vector2Length(transform.x);
+
+        // draw texture
+        ProfilerBegin(profiler, PROFILER_SPRITE);
+        SpriteUpdate(&sprite, &state, state.frameIdx);
+        Texture2D frameTexture;
+        Rectangle source;
+        if (SpriteFrameGet(&sprite, &state, state.frameIdx, &frameTexture, &source)) {
+            Rectangle dest = {
+                .x = 0.0f,
+                .y = 0.0f,
+                .width = source.width,
+                .height = source.height
+            };
+            DrawTexturePro(frameTexture, source, dest, VECTOR2_ZERO, 0.0f, WHITE);
+        }
+        ProfilerEnd(profiler, PROFILER_SPRITE);
 
         // draw layers
+        ProfilerBegin(profiler, PROFILER_LAYERS);
         for (int i = 0; i < state.layerCount; i++) {
-            LayerDraw(state.layers + i, state.frameIdx, transform, i == state.layerIdx);
+            Transform2D world = LayerHierarchyWorld(&hierarchy, i);
+            LayerDraw(state.layers + i, state.frameIdx, world, handleScale, selection.selected[i]);
+            int parent = state.layers[i].parent;
+            if (selection.selected[i] && parent >= 0) {
+                DrawLineEx(world.o, LayerHierarchyWorld(&hierarchy, parent).o, handleScale, COLOR_PARENT_LINK);
+            }
+        }
+        if (mode == MODE_SELECTING_BOX) {
+            Rectangle box = SelectBox(selectionStartLocalPos, localMousePos);
+            DrawRectangleLinesEx(box, handleScale, COLOR_SELECT_BOX);
         }
         
         // draw frame pos handle
         if (state.frameIdx > 0) {
-            Vector2 globalFramePosPrevious = Transform2DToGlobal(transform, state.frames[state.frameIdx - 1].pos);
-            DrawCircle(globalFramePosPrevious.x, globalFramePosPrevious.y, HANDLE_RADIUS, COLOR_FRAME_POS_HANDLE_PREVIOUS);  
+            DrawCircleV(state.frames[state.frameIdx - 1].pos, HANDLE_RADIUS * handleScale, COLOR_FRAME_POS_HANDLE_PREVIOUS);
         }
-        Vector2 globalFramePos = Transform2DToGlobal(transform, state.frames[state.frameIdx].pos);
-        HandleDraw(globalFramePos, COLOR_FRAME_POS_HANDLE);
+        HandleDraw(state.frames[state.frameIdx].pos, handleScale, COLOR_FRAME_POS_HANDLE);
+        rlPopMatrix();
+        ProfilerEnd(profiler, PROFILER_LAYERS);
 
         // draw frame duration value box
+        ProfilerBegin(profiler, PROFILER_PANEL);
         float rectStroke = (float) (fontSize + 8);
         Rectangle rectLabel = { 0.0f, 0.0f, 128.0f, rectStroke };
         Rectangle rectValue = { 128.0f, 0.0f, 128.0f, rectStroke };
 
         // Draw gui
         
-        GuiLabel(rectLabel, "Frame Duration (ms)");
+        if (mode == MODE_PLAYING || playback.speed != 1.0f) {
+            Vector2 speedPos = {rectValue.x + rectValue.width + 8.0f, 4.0f};
+            char *speedText = ArenaStringCopy(&gui.frameArena, TextFormat("Playback speed x%.3g", playback.speed));
+            WindowManagerPush(&gui, DRAW_KIND_TEXT, DrawCommandString(speedPos, speedText, &fontDefault, fontSize, RAYWHITE));
+        }
+
+        PanelLabel(&gui, rectLabel, "Frame Duration (ms)", &fontDefault, fontSize, fontSpacing);
         if (GuiValueBox(rectValue, NULL, &state.frames[state.frameIdx].duration, 1, INT_MAX, mode == MODE_EDIT_FRAME_DURATION)) {
             mode = MODE_EDIT_FRAME_DURATION;
         }
@@ -588,11 +918,23 @@ int main(int argc, char **argv) {
             rectLabel.y += rectStroke;
             rectValue.y += rectStroke;
             
-            GuiLabel(rectLabel, "Layer Name");
+            PanelLabel(&gui, rectLabel, "Layer Name", &fontDefault, fontSize, fontSpacing);
             Layer *layer = state.layers + state.layerIdx;
-            if (GuiTextBox(rectValue, layer->name, layer->nameBufferLength, mode == MODE_EDIT_LAYER_NAME)) {
+            
+            // Names are interned, so typing happens in a separate buffer that is applied when editing ends.
+            if (mode != MODE_EDIT_LAYER_NAME) {
+                int nameSize = (int) strlen(layer->name) + 1;
+                if (nameSize >= layerNameEditSize) {
+                    layerNameEditSize = (int) ((float) nameSize * LAYER_NAME_BUFFER_RESIZE_MULTIPLIER);
+                    layerNameEdit = realloc(layerNameEdit, layerNameEditSize);
+                }
+                strcpy(layerNameEdit, layer->name);
+            }
+
+            if (GuiTextBox(rectValue, layerNameEdit, layerNameEditSize, mode == MODE_EDIT_LAYER_NAME)) {
                 if (mode == MODE_EDIT_LAYER_NAME) {
-                    EditorHistoryCommitState(&history, &state);
+                    LayerNameEditApply(&state, layerNameEdit);
+                    CommitState(&history, &state, profiler);
                     mode = MODE_IDLE;
                 } else {
                     mode = MODE_EDIT_LAYER_NAME;
@@ -600,9 +942,9 @@ int main(int argc, char **argv) {
             }
             
             // If the user has filled up the name buffer, reallocate it.
-            if (mode == MODE_EDIT_LAYER_NAME && strlen(layer->name) == layer->nameBufferLength - 1) {
-                layer->nameBufferLength = (int) (((float) layer->nameBufferLength) * LAYER_NAME_BUFFER_RESIZE_MULTIPLIER);
-                layer->name = realloc(layer->name, layer->nameBufferLength);
+            if (mode == MODE_EDIT_LAYER_NAME && strlen(layerNameEdit) == layerNameEditSize - 1) {
+                layerNameEditSize = (int) (((float) layerNameEditSize) * LAYER_NAME_BUFFER_RESIZE_MULTIPLIER);
+                layerNameEdit = realloc(layerNameEdit, layerNameEditSize);
             }
 
             rectLabel.y += rectStroke;
@@ -610,10 +952,11 @@ int main(int argc, char **argv) {
             
             switch (state.layers[state.layerIdx].type) {
                 case LAYER_HITBOX:
-                    GuiLabel(rectLabel, "Hitbox Damage");
+                    PanelLabel(&gui, rectLabel, "Hitbox Damage", &fontDefault, fontSize, fontSpacing);
                     if (GuiValueBox(rectValue, NULL, &state.layers[state.layerIdx].hitbox.damage, 0, INT_MAX, mode == MODE_EDIT_HITBOX_DAMAGE)) {
                         if (mode == MODE_EDIT_HITBOX_DAMAGE) {
-                            EditorHistoryCommitState(&history, &state);
+                            state.layers[state.layerIdx].templateOverrides |= TEMPLATE_FIELD_DAMAGE;
+                            CommitState(&history, &state, profiler);
                             mode = MODE_IDLE;
                         } else {
                             mode = MODE_EDIT_HITBOX_DAMAGE;
@@ -623,10 +966,11 @@ int main(int argc, char **argv) {
                     rectLabel.y += rectStroke;
                     rectValue.y += rectStroke;
 
-                    GuiLabel(rectLabel, "Hitbox Stun (ms)");
+                    PanelLabel(&gui, rectLabel, "Hitbox Stun (ms)", &fontDefault, fontSize, fontSpacing);
                     if (GuiValueBox(rectValue, NULL, &state.layers[state.layerIdx].hitbox.stun, 0, INT_MAX, mode == MODE_EDIT_HITBOX_STUN)) {
                         if (mode == MODE_EDIT_HITBOX_STUN) {
-                            EditorHistoryCommitState(&history, &state);
+                            state.layers[state.layerIdx].templateOverrides |= TEMPLATE_FIELD_STUN;
+                            CommitState(&history, &state, profiler);
                             mode = MODE_IDLE;
                         } else {
                             mode = MODE_EDIT_HITBOX_STUN;
@@ -634,43 +978,57 @@ int main(int argc, char **argv) {
                     }
                     break;
 
-                case LAYER_SHAPE:
+                case LAYER_SHAPE: {
                     Rectangle rectFlagsLabel = rectLabel;
                     Rectangle rectFlagsValue = rectValue;
                     
                     rectFlagsLabel.height *= 3;
                     rectFlagsValue.height *= 3;
 
-                    GuiLabel(rectFlagsLabel, "Shape type");
+                    PanelLabel(&gui, rectFlagsLabel, "Shape type", &fontDefault, fontSize, fontSpacing);
                     if (GuiFlags(rectFlagsValue, &state.layers[state.layerIdx].shape.flags)) {
-                        EditorHistoryCommitState(&history, &state);
+                        state.layers[state.layerIdx].templateOverrides |= TEMPLATE_FIELD_FLAGS;
+                        CommitState(&history, &state, profiler);
                     }
-                    break;
+                } break;
 
                 case LAYER_BEZIER:
                 case LAYER_EMPTY:
                     break;
             }
         }
-        
+        ProfilerEnd(profiler, PROFILER_PANEL);
         
         // draw timeline
-        DrawRectangle(0, timelineY, windowX, timelineHeight, TIMELINE_COLOR); // draw timeline background
+        ProfilerBegin(profiler, PROFILER_TIMELINE);
+        Rectangle timelineRect = {0.0f, (float) timelineY, (float) windowX, (float) timelineHeight};
+        WindowManagerPush(&gui, DRAW_KIND_BACKGROUND, DrawCommandRect(timelineRect, TIMELINE_COLOR));
         int selectedX = FRAME_ROW_SIZE * state.frameIdx;
         int selectedY = state.layerIdx >= 0 ? timelineY + FRAME_ROW_SIZE + state.layerIdx * LAYER_ROW_SIZE : timelineY;
-        DrawRectangle(selectedX, selectedY, FRAME_ROW_SIZE, FRAME_ROW_SIZE, COLOR_SELECTED);
+        Rectangle selectedRect = {(float) selectedX, (float) selectedY, FRAME_ROW_SIZE, FRAME_ROW_SIZE};
+        WindowManagerPush(&gui, DRAW_KIND_RECT, DrawCommandRect(selectedRect, COLOR_SELECTED));
+        for (int i = 0; i < state.layerCount; i++) {
+            if (!selection.selected[i] || i == state.layerIdx) continue;
+            Color color = COLOR_SELECTED;
+            color.a /= 2;
+            Rectangle rect = {(float) selectedX, (float) (hitboxRowY + i * LAYER_ROW_SIZE), FRAME_ROW_SIZE, FRAME_ROW_SIZE};
+            WindowManagerPush(&gui, DRAW_KIND_RECT, DrawCommandRect(rect, color));
+        }
 
+        // The labels sort after every shape, so the whole timeline is one batch of shapes and one of text.
         for (int i = 0; i < state.frameCount; i++) {
             int xPos = i * FRAME_ROW_SIZE + FRAME_ROW_SIZE / 2;
 
             Color frameColor = state.frames[i].canCancel ? FRAME_RHOMBUS_CAN_CANCEL_COLOR : FRAME_RHOMBUS_CANNOT_CANCEL_COLOR;
             Vector2 frameCenter = {(float) xPos, (float) timelineY + FRAME_ROW_SIZE / 2.0f};
-            DrawRhombus(frameCenter, FRAME_RHOMBUS_RADIUS, FRAME_RHOMBUS_RADIUS, frameColor);
+            WindowManagerPush(&gui, DRAW_KIND_RECT, DrawCommandRhombus(frameCenter, FRAME_RHOMBUS_RADIUS, FRAME_RHOMBUS_RADIUS, frameColor));
             
-            const char *text = TextFormat("%i", i + 1);
-            int textX = (int) (frameCenter.x - (float) MeasureText(text, fontSize) / 2.0f);
-            int textY = (int) (frameCenter.y - (float) fontSize / 2.0f);
-            DrawText(text, textX, textY, fontSize, FRAME_ROW_TEXT_COLOR);
+            TextRun label = TextCacheGetInteger(gui.textCache, fontDefault, fontSize, fontSpacing, i + 1);
+            Vector2 labelPos = {
+                (float) (int) (frameCenter.x - (float) (int) label.size.x / 2.0f),
+                (float) (int) (frameCenter.y - (float) fontSize / 2.0f)
+            };
+            WindowManagerPush(&gui, DRAW_KIND_TEXT, DrawCommandInteger(labelPos, i + 1, &fontDefault, fontSize, FRAME_ROW_TEXT_COLOR));
             for (int j = 0; j < state.layerCount; j++) {
                 Color color = layerColors[state.layers[j].type];
                 if (!state.layers[j].framesActive[i]) {
@@ -678,16 +1036,39 @@ int main(int argc, char **argv) {
                     color.g /= 4;
                     color.b /= 4;
                 }
-                int layerY = hitboxRowY + (int) (LAYER_ROW_SIZE * ((float) j + 0.5f));
-                DrawCircle(xPos, layerY, LAYER_ICON_CIRCLE_RADIUS, color);
+                Vector2 layerCenter = {(float) xPos, (float) (hitboxRowY + (int) (LAYER_ROW_SIZE * ((float) j + 0.5f)))};
+                WindowManagerPush(&gui, DRAW_KIND_RECT, DrawCommandCircle(layerCenter, LAYER_ICON_CIRCLE_RADIUS, color));
+                if (LayerKeyOnFrame(state.layers + j, i)) {
+                    WindowManagerPush(&gui, DRAW_KIND_RECT, DrawCommandRhombus(layerCenter, KEYFRAME_RHOMBUS_RADIUS, KEYFRAME_RHOMBUS_RADIUS, KEYFRAME_RHOMBUS_COLOR));
+                }
             }
         }
+        WindowManagerEnd(&gui);
+        ProfilerEnd(profiler, PROFILER_TIMELINE);
+
+        if (profiler->overlay) {
+            Rectangle overlayRect = {windowX - PROFILER_OVERLAY_WIDTH, 0.0f, PROFILER_OVERLAY_WIDTH, PROFILER_OVERLAY_HEIGHT};
+            ProfilerDraw(profiler, overlayRect, fontSize, EditorHistoryMemorySize(&history), &tracker);
+        }
+
+        ProfilerBegin(profiler, PROFILER_PRESENT);
         EndDrawing();
+        ProfilerEnd(profiler, PROFILER_PRESENT);
+        AllocationTrackerTotals(&tracker, &allocations, NULL, NULL);
+        ProfilerFrameEnd(profiler, allocations);
     }
+    free(profiler);
+    HandleGridFree(&handleGrid);
+    LayerHierarchyFree(&hierarchy);
+    LayerSelectionFree(&selection);
+    free(layerNameEdit);
+    WindowManagerFree(&gui);
     EditorHistoryFree(&history);
     EditorStateFree(&state);
-    UnloadTexture(texture);
+    SpriteFree(&sprite);
     free(savePath);
     CloseWindow();
+    AllocatorSet(tracker.parent);
+    AllocationTrackerFree(&tracker);
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,29 @@
+#include "editor_history.h"
+#include "playback.h"
+
+PlaybackClock PlaybackClockNew(EditorState *state, int frameIdx, float speed, double nowSeconds) {
+    return (PlaybackClock) {
+        .startSeconds = nowSeconds,
+        .startMilliseconds = (double) EditorStateFrameStart(state, frameIdx),
+        .speed = speed
+    };
+}
+
+double PlaybackClockMilliseconds(PlaybackClock *clock, double nowSeconds) {
+    double elapsed = (nowSeconds - clock->startSeconds) * FRAME_DURATION_UNIT_PER_SECOND * clock->speed;
+    return clock->startMilliseconds + elapsed;
+}
+
+void PlaybackClockSetSpeed(PlaybackClock *clock, float speed, double nowSeconds) {
+    if (speed < PLAYBACK_SPEED_MIN) speed = PLAYBACK_SPEED_MIN;
+    if (speed > PLAYBACK_SPEED_MAX) speed = PLAYBACK_SPEED_MAX;
+    // Rebase so changing the speed doesn't jump to a different spot in the animation.
+    clock->startMilliseconds = PlaybackClockMilliseconds(clock, nowSeconds);
+    clock->startSeconds = nowSeconds;
+    clock->speed = speed;
+}
+
+int PlaybackClockFrame(PlaybackClock *clock, EditorState *state, double nowSeconds) {
+    double milliseconds = PlaybackClockMilliseconds(clock, nowSeconds);
+    return EditorStateFrameAtTime(state, (long long) milliseconds);
+}
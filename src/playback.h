@@ -0,0 +1,25 @@
+#ifndef PLAYBACK_H
+#define PLAYBACK_H
+
+#include "editor_history.h"
+
+#define PLAYBACK_SPEED_MIN 0.125f
+#define PLAYBACK_SPEED_MAX 8.0f
+
+// Plays an animation back the same way a game would: the current frame is the one whose
+// span of summed FrameInfo.durations contains the elapsed time.
+// Time is measured from when the clock was started instead of accumulated per tick,
+// so nothing is lost to rounding and short frames get skipped over correctly when a tick is longer than them.
+typedef struct PlaybackClock {
+    double startSeconds; // Wall time the position was last rebased at.
+    double startMilliseconds; // Position in the animation at startSeconds.
+    float speed;
+} PlaybackClock;
+
+// Starts at the beginning of the given frame.
+PlaybackClock PlaybackClockNew(EditorState *state, int frameIdx, float speed, double nowSeconds);
+double PlaybackClockMilliseconds(PlaybackClock *clock, double nowSeconds);
+void PlaybackClockSetSpeed(PlaybackClock *clock, float speed, double nowSeconds);
+int PlaybackClockFrame(PlaybackClock *clock, EditorState *state, double nowSeconds);
+
+#endif
@@ -0,0 +1,211 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+#include "cJSON.h"
+#include "raylib.h"
+#include "timer.h"
+#include "profiler.h"
+
+const char *profilerStageNames[] = {
+    "Input",
+    "Sprite",
+    "Layers",
+    "Panel",
+    "Timeline",
+    "History",
+    "Present"
+};
+
+Color profilerStageColors[] = {
+    (Color) {255, 200, 0, 255},
+    (Color) {160, 160, 160, 255},
+    (Color) {255, 0, 0, 255},
+    (Color) {0, 255, 255, 255},
+    (Color) {0, 255, 0, 255},
+    (Color) {255, 0, 255, 255},
+    (Color) {60, 60, 200, 255},
+};
+
+#define PROFILER_GRAPH_MS 33.4f // Height of the graph. Two 60 fps frames.
+#define PROFILER_BUDGET_MS 16.7f
+
+void ProfilerInit(Profiler *profiler) {
+    memset(profiler, 0, sizeof(Profiler));
+}
+
+void ProfilerFrameStart(Profiler *profiler, long long allocations) {
+    ProfilerFrame *frame = profiler->frames + profiler->frameIdx;
+    memset(frame, 0, sizeof(ProfilerFrame));
+    frame->start = TimerSeconds();
+    profiler->allocationsFrameStart = allocations;
+    profiler->depth = 0;
+}
+
+void ProfilerFrameEnd(Profiler *profiler, long long allocations) {
+    ProfilerFrame *frame = profiler->frames + profiler->frameIdx;
+    frame->duration = TimerSeconds() - frame->start;
+    frame->allocations = allocations - profiler->allocationsFrameStart;
+    profiler->frameIdx = (profiler->frameIdx + 1) % PROFILER_FRAMES;
+    if (profiler->frameCount < PROFILER_FRAMES) profiler->frameCount++;
+}
+
+void ProfilerBegin(Profiler *profiler, ProfilerStage stage) {
+    assert(profiler->depth < PROFILER_DEPTH_MAX);
+    if (profiler->depth >= PROFILER_DEPTH_MAX) return;
+    profiler->open[profiler->depth] = (ProfilerOpen) {
+        .stage = stage,
+        .start = TimerSeconds(),
+        .childSeconds = 0.0
+    };
+    profiler->depth++;
+}
+
+void ProfilerEnd(Profiler *profiler, ProfilerStage stage) {
+    assert(profiler->depth > 0 && profiler->open[profiler->depth - 1].stage == stage);
+    if (profiler->depth <= 0) return;
+    profiler->depth--;
+    ProfilerOpen open = profiler->open[profiler->depth];
+    double duration = TimerSeconds() - open.start;
+    
+    profiler->frames[profiler->frameIdx].stageSeconds[stage] += duration - open.childSeconds;
+    if (profiler->depth > 0) profiler->open[profiler->depth - 1].childSeconds += duration;
+    
+    profiler->events[profiler->eventIdx] = (ProfilerEvent) {
+        .stage = stage,
+        .depth = profiler->depth,
+        .start = open.start,
+        .duration = duration
+    };
+    profiler->eventIdx = (profiler->eventIdx + 1) % PROFILER_EVENTS;
+    if (profiler->eventCount < PROFILER_EVENTS) profiler->eventCount++;
+}
+
+void ProfilerDraw(Profiler *profiler, Rectangle rect, int fontSize, size_t historyBytes, AllocationTracker *tracker) {
+    DrawRectangleRec(rect, (Color) {0, 0, 0, 200});
+    
+    AllocationSite sites[PROFILER_SITES_SHOWN];
+    int siteCount = 0;
+    long long heapBytes = 0;
+    long long heapPeak = 0;
+    if (tracker) {
+        siteCount = AllocationTrackerSites(tracker, sites, PROFILER_SITES_SHOWN);
+        AllocationTrackerTotals(tracker, NULL, &heapBytes, &heapPeak);
+    }
+
+    int lineHeight = fontSize + 4;
+    int textRows = PROFILER_STAGE_COUNT + 3 + (tracker ? 1 + siteCount : 0);
+    Rectangle graph = {
+        rect.x + 4,
+        rect.y + 4 + textRows * lineHeight,
+        rect.width - 8,
+        rect.height - 8 - textRows * lineHeight
+    };
+    
+    // Averages over everything in the ring buffer.
+    double stageAverages[PROFILER_STAGE_COUNT] = {0};
+    double frameAverage = 0.0;
+    long long allocationsLast = 0;
+    for (int i = 0; i < profiler->frameCount; i++) {
+        ProfilerFrame *frame = profiler->frames + i;
+        for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++) stageAverages[stage] += frame->stageSeconds[stage];
+        frameAverage += frame->duration;
+    }
+    if (profiler->frameCount > 0) {
+        for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++) stageAverages[stage] /= profiler->frameCount;
+        frameAverage /= profiler->frameCount;
+        allocationsLast = profiler->frames[(profiler->frameIdx + PROFILER_FRAMES - 1) % PROFILER_FRAMES].allocations;
+    }
+    
+    int textX = (int) rect.x + 4;
+    int textY = (int) rect.y + 4;
+    DrawText(TextFormat("Frame %.2f ms avg", frameAverage * 1000.0), textX, textY, fontSize, RAYWHITE);
+    textY += lineHeight;
+    for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++) {
+        DrawRectangle(textX, textY, fontSize, fontSize, profilerStageColors[stage]);
+        DrawText(TextFormat("%-9s %.3f ms", profilerStageNames[stage], stageAverages[stage] * 1000.0), textX + fontSize + 4, textY, fontSize, RAYWHITE);
+        textY += lineHeight;
+    }
+    DrawText(TextFormat("Allocations last frame: %lli", allocationsLast), textX, textY, fontSize, RAYWHITE);
+    textY += lineHeight;
+    DrawText(TextFormat("History memory: %.1f KiB", (double) historyBytes / 1024.0), textX, textY, fontSize, RAYWHITE);
+    textY += lineHeight;
+    if (tracker) {
+        DrawText(TextFormat("Heap: %.1f KiB, peak %.1f KiB", heapBytes / 1024.0, heapPeak / 1024.0), textX, textY, fontSize, RAYWHITE);
+        textY += lineHeight;
+        for (int i = 0; i < siteCount; i++) {
+            // Tags are long paths, only the file name and line fit.
+            const char *tag = sites[i].tag;
+            const char *slash = strrchr(tag, '/');
+            if (slash) tag = slash + 1;
+            DrawText(TextFormat("  %s %.1f KiB peak", tag, sites[i].peak / 1024.0), textX, textY, fontSize, RAYWHITE);
+            textY += lineHeight;
+        }
+    }
+
+    // Stacked bars of self time per stage, oldest on the left.
+    float barWidth = graph.width / PROFILER_FRAMES;
+    float pixelsPerMs = graph.height / PROFILER_GRAPH_MS;
+    int oldest = (profiler->frameIdx + PROFILER_FRAMES - profiler->frameCount) % PROFILER_FRAMES;
+    for (int i = 0; i < profiler->frameCount; i++) {
+        ProfilerFrame *frame = profiler->frames + (oldest + i) % PROFILER_FRAMES;
+        float x = graph.x + (PROFILER_FRAMES - profiler->frameCount + i) * barWidth;
+        float y = graph.y + graph.height;
+        for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++) {
+            float height = (float) (frame->stageSeconds[stage] * 1000.0) * pixelsPerMs;
+            if (y - height < graph.y) height = y - graph.y;
+            y -= height;
+            DrawRectangleRec((Rectangle) {x, y, barWidth, height}, profilerStageColors[stage]);
+        }
+    }
+    float budgetY = graph.y + graph.height - PROFILER_BUDGET_MS * pixelsPerMs;
+    DrawLine((int) graph.x, (int) budgetY, (int) (graph.x + graph.width), (int) budgetY, RAYWHITE);
+}
+
+bool ProfilerWriteTrace(Profiler *profiler, const char *path) {
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddStringToObject(json, "displayTimeUnit", "ms");
+    cJSON *events = cJSON_AddArrayToObject(json, "traceEvents");
+    
+    int oldest = (profiler->eventIdx + PROFILER_EVENTS - profiler->eventCount) % PROFILER_EVENTS;
+    for (int i = 0; i < profiler->eventCount; i++) {
+        ProfilerEvent *event = profiler->events + (oldest + i) % PROFILER_EVENTS;
+        cJSON *eventJson = cJSON_CreateObject();
+        cJSON_AddStringToObject(eventJson, "name", profilerStageNames[event->stage]);
+        cJSON_AddStringToObject(eventJson, "ph", "X"); // complete event, has a start and a duration
+        cJSON_AddNumberToObject(eventJson, "ts", event->start * 1e6);
+        cJSON_AddNumberToObject(eventJson, "dur", event->duration * 1e6);
+        cJSON_AddNumberToObject(eventJson, "pid", 1);
+        cJSON_AddNumberToObject(eventJson, "tid", 1);
+        cJSON_AddItemToArray(events, eventJson);
+    }
+    
+    int oldestFrame = (profiler->frameIdx + PROFILER_FRAMES - profiler->frameCount) % PROFILER_FRAMES;
+    for (int i = 0; i < profiler->frameCount; i++) {
+        ProfilerFrame *frame = profiler->frames + (oldestFrame + i) % PROFILER_FRAMES;
+        cJSON *eventJson = cJSON_CreateObject();
+        cJSON_AddStringToObject(eventJson, "name", "Frame");
+        cJSON_AddStringToObject(eventJson, "ph", "X");
+        cJSON_AddNumberToObject(eventJson, "ts", frame->start * 1e6);
+        cJSON_AddNumberToObject(eventJson, "dur", frame->duration * 1e6);
+        cJSON_AddNumberToObject(eventJson, "pid", 1);
+        cJSON_AddNumberToObject(eventJson, "tid", 0);
+        cJSON *args = cJSON_AddObjectToObject(eventJson, "args");
+        cJSON_AddNumberToObject(args, "allocations", (double) frame->allocations);
+        cJSON_AddItemToArray(events, eventJson);
+    }
+
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        cJSON_Delete(json);
+        return false;
+    }
+    char *str = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    fputs(str, file);
+    free(str);
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "raylib.h"
+#include "allocator.h"
+
+#define PROFILER_FRAMES 240 // about 4 seconds at 60 fps
+#define PROFILER_EVENTS 8192
+#define PROFILER_DEPTH_MAX 8
+#define PROFILER_TRACE_PATH "profile_trace.json"
+#define PROFILER_SITES_SHOWN 4
+
+// Stages of the main loop. Stages can nest (a history commit during input) and can happen more than once per frame.
+typedef enum ProfilerStage {
+    PROFILER_INPUT,
+    PROFILER_SPRITE,
+    PROFILER_LAYERS,
+    PROFILER_PANEL,
+    PROFILER_TIMELINE,
+    PROFILER_HISTORY,
+    PROFILER_PRESENT, // EndDrawing, includes waiting on vsync.
+    PROFILER_STAGE_COUNT
+} ProfilerStage;
+
+extern const char *profilerStageNames[];
+extern Color profilerStageColors[];
+
+typedef struct ProfilerFrame {
+    double start;
+    double duration;
+    double stageSeconds[PROFILER_STAGE_COUNT]; // Self time, so nested stages aren't counted twice.
+    long long allocations;
+} ProfilerFrame;
+
+typedef struct ProfilerEvent {
+    ProfilerStage stage;
+    int depth;
+    double start;
+    double duration;
+} ProfilerEvent;
+
+typedef struct ProfilerOpen {
+    ProfilerStage stage;
+    double start;
+    double childSeconds;
+} ProfilerOpen;
+
+// Everything is kept in fixed size ring buffers so profiling never allocates.
+typedef struct Profiler {
+    ProfilerFrame frames[PROFILER_FRAMES];
+    int frameIdx; // Frame being recorded.
+    int frameCount; // Number of valid frames, at most PROFILER_FRAMES.
+    
+    ProfilerEvent events[PROFILER_EVENTS];
+    int eventIdx;
+    int eventCount;
+
+    ProfilerOpen open[PROFILER_DEPTH_MAX];
+    int depth;
+    
+    long long allocationsFrameStart;
+    bool overlay;
+} Profiler;
+
+void ProfilerInit(Profiler *profiler);
+// allocations is a running total. The difference between frame start and end is stored with the frame.
+void ProfilerFrameStart(Profiler *profiler, long long allocations);
+void ProfilerFrameEnd(Profiler *profiler, long long allocations);
+void ProfilerBegin(Profiler *profiler, ProfilerStage stage);
+void ProfilerEnd(Profiler *profiler, ProfilerStage stage);
+
+// tracker may be NULL.
+void ProfilerDraw(Profiler *profiler, Rectangle rect, int fontSize, size_t historyBytes, AllocationTracker *tracker);
+// Writes the events in the ring buffer in the Chrome trace event format (chrome://tracing, Perfetto).
+bool ProfilerWriteTrace(Profiler *profiler, const char *path);
+
+#endif
@@ -0,0 +1,323 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "bytes.h"
+#include "editor_history.h"
+#include "export.h"
+#include "files.h"
+#include "hash.h"
+#include "layer.h"
+#include "list.h"
+#include "string_buffer.h"
+#include "template_table.h"
+#include "project_index.h"
+
+static void EntryLayersFree(ProjectIndexEntry *entry) {
+    for (int i = 0; i < LIST_COUNT(entry->layers); i++) free(entry->layers[i].name);
+    LIST_FREE(entry->layers);
+}
+
+static void EntryFree(ProjectIndexEntry *entry) {
+    free(entry->path);
+    EntryLayersFree(entry);
+}
+
+ProjectIndex ProjectIndexNew(void) {
+    return (ProjectIndex) {.entries = LIST_NEW(ProjectIndexEntry)};
+}
+
+void ProjectIndexFree(ProjectIndex *index) {
+    for (int i = 0; i < LIST_COUNT(index->entries); i++) EntryFree(index->entries + i);
+    LIST_FREE(index->entries);
+}
+
+static void WriteString(LIST(unsigned char) *buffer, const char *str) {
+    int length = (int) strlen(str);
+    if (length > UINT16_MAX) length = UINT16_MAX;
+    BytesWriteU16(buffer, (uint16_t) length);
+    LIST_ADD_ARRAY(buffer, str, length);
+}
+
+static char *ReadString(BytesReader *reader) {
+    int length = BytesReadU16(reader);
+    const unsigned char *bytes = BytesRead(reader, length);
+    return bytes ? StringCopy((const char *) bytes, length) : NULL;
+}
+
+ProjectIndex ProjectIndexLoad(const char *directory) {
+    ProjectIndex index = ProjectIndexNew();
+    char *path = FilesJoin(directory, PROJECT_INDEX_FILE);
+    size_t size;
+    unsigned char *data = FilesRead(path, &size);
+    free(path);
+    if (!data) return index;
+
+    BytesReader reader = {.data = data, .size = size, .at = 0, .failed = false};
+    const unsigned char *magic = BytesRead(&reader, 4);
+    uint32_t version = BytesReadU32(&reader);
+    uint32_t fileVersion = BytesReadU32(&reader);
+    // Entries summarize deserialized files, so an index written for another file version is rebuilt.
+    if (!magic || memcmp(magic, PROJECT_INDEX_MAGIC, 4) || version != PROJECT_INDEX_VERSION || fileVersion != FILE_VERSION_CURRENT) {
+        free(data);
+        return index;
+    }
+
+    uint32_t entryCount = BytesReadU32(&reader);
+    for (uint32_t i = 0; i < entryCount && !reader.failed; i++) {
+        ProjectIndexEntry entry = {0};
+        entry.path = ReadString(&reader);
+        entry.modified = (int64_t) BytesReadU64(&reader);
+        entry.size = (int64_t) BytesReadU64(&reader);
+        entry.contentHash = BytesReadU64(&reader);
+        entry.templatesHash = BytesReadU64(&reader);
+        entry.valid = BytesReadU8(&reader);
+        entry.layers = LIST_NEW(ProjectIndexLayer);
+        if (entry.valid) {
+            entry.frameCount = (int) BytesReadU32(&reader);
+            entry.duration = (int) BytesReadU32(&reader);
+            int layerCount = BytesReadU16(&reader);
+            for (int layerIdx = 0; layerIdx < layerCount && !reader.failed; layerIdx++) {
+                LayerType type = (LayerType) BytesReadU8(&reader);
+                char *name = ReadString(&reader);
+                if (!name) break;
+                ProjectIndexLayer layer = {.name = name, .type = type};
+                LIST_ADD(&entry.layers, layer);
+            }
+        }
+        if (reader.failed || !entry.path) {
+            EntryFree(&entry);
+            break;
+        }
+        LIST_ADD(&index.entries, entry);
+    }
+    free(data);
+
+    if (reader.failed) {
+        printf("The project index in %s is damaged and will be rebuilt.\n", directory);
+        ProjectIndexFree(&index);
+        index = ProjectIndexNew();
+    }
+    return index;
+}
+
+bool ProjectIndexSave(ProjectIndex *index, const char *directory) {
+    LIST(unsigned char) buffer = LIST_NEW(unsigned char);
+    LIST_ADD_ARRAY(&buffer, PROJECT_INDEX_MAGIC, 4);
+    BytesWriteU32(&buffer, PROJECT_INDEX_VERSION);
+    BytesWriteU32(&buffer, FILE_VERSION_CURRENT);
+    BytesWriteU32(&buffer, (uint32_t) LIST_COUNT(index->entries));
+    for (int i = 0; i < LIST_COUNT(index->entries); i++) {
+        ProjectIndexEntry *entry = index->entries + i;
+        WriteString(&buffer, entry->path);
+        BytesWriteU64(&buffer, (uint64_t) entry->modified);
+        BytesWriteU64(&buffer, (uint64_t) entry->size);
+        BytesWriteU64(&buffer, entry->contentHash);
+        BytesWriteU64(&buffer, entry->templatesHash);
+        BytesWriteU8(&buffer, entry->valid);
+        if (!entry->valid) continue;
+        BytesWriteU32(&buffer, (uint32_t) entry->frameCount);
+        BytesWriteU32(&buffer, (uint32_t) entry->duration);
+        int layerCount = LIST_COUNT(entry->layers);
+        if (layerCount > UINT16_MAX) layerCount = UINT16_MAX;
+        BytesWriteU16(&buffer, (uint16_t) layerCount);
+        for (int layerIdx = 0; layerIdx < layerCount; layerIdx++) {
+            BytesWriteU8(&buffer, (uint8_t) entry->layers[layerIdx].type);
+            WriteString(&buffer, entry->layers[layerIdx].name);
+        }
+    }
+
+    char *path = FilesJoin(directory, PROJECT_INDEX_FILE);
+    bool success = FilesWrite(path, buffer, LIST_COUNT(buffer));
+    if (!success) printf("Failed to write the project index to %s.\n", path);
+    free(path);
+    LIST_FREE(buffer);
+    return success;
+}
+
+// Fills in everything but the path, times and hash from the animation itself.
+static void EntrySummarize(ProjectIndexEntry *entry, const char *fullPath) {
+    entry->layers = LIST_NEW(ProjectIndexLayer);
+    EditorState state;
+    entry->valid = EditorStateDeserialize(&state, fullPath);
+    if (!entry->valid) return;
+
+    entry->frameCount = state.frameCount;
+    entry->duration = 0;
+    for (int i = 0; i < state.frameCount; i++) entry->duration += state.frames[i].duration;
+    for (int i = 0; i < state.layerCount; i++) {
+        const char *name = state.layers[i].name;
+        ProjectIndexLayer layer = {.name = StringCopy(name, (int) strlen(name)), .type = state.layers[i].type};
+        LIST_ADD(&entry->layers, layer);
+    }
+    EditorStateFree(&state);
+}
+
+static int EntryFind(ProjectIndex *index, const char *path) {
+    int low = 0;
+    int high = LIST_COUNT(index->entries) - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        int comparison = strcmp(index->entries[middle].path, path);
+        if (comparison == 0) return middle;
+        if (comparison < 0) low = middle + 1;
+        else high = middle - 1;
+    }
+    return -1;
+}
+
+static int PathCompare(const void *a, const void *b) {
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+// "./attacks/Jab.json" and "project/attacks/Jab.json" are both stored as "attacks/Jab.json".
+static const char *PathRelative(const char *path, const char *directory) {
+    size_t length = strlen(directory);
+    if (!strncmp(path, directory, length) && (path[length] == '/' || path[length] == '\\')) return path + length + 1;
+    return path;
+}
+
+bool ProjectIndexUpdate(ProjectIndex *index, const char *directory, ProjectIndexUpdateStats *stats) {
+    *stats = (ProjectIndexUpdateStats) {0};
+    LIST(char *) paths = LIST_NEW(char *);
+    // Exports are minified copies of the animations so they would show up twice.
+    FilesCollect(directory, ".json", EXPORT_DIRECTORY_DEFAULT, &paths);
+
+    LIST(char *) relativePaths = LIST_NEW_SIZED(char *, LIST_COUNT(paths));
+    for (int i = 0; i < LIST_COUNT(paths); i++) relativePaths[i] = (char *) PathRelative(paths[i], directory);
+    qsort(relativePaths, LIST_COUNT(relativePaths), sizeof(char *), PathCompare); // Same order the entries are kept in.
+
+    LIST(ProjectIndexEntry) entries = LIST_NEW(ProjectIndexEntry);
+    bool *kept = calloc(LIST_COUNT(index->entries) + 1, sizeof(bool));
+    // Files of one project share a table and mostly come one after another, so its hash is only read again when the
+    // table path changes.
+    char *templatesPath = NULL;
+    uint64_t templatesHash = 0;
+    for (int i = 0; i < LIST_COUNT(relativePaths); i++) {
+        const char *relativePath = relativePaths[i];
+        char *fullPath = FilesJoin(directory, relativePath);
+        struct stat fileStat;
+        if (stat(fullPath, &fileStat) != 0) {
+            free(fullPath);
+            continue;
+        }
+        int64_t modified = (int64_t) fileStat.st_mtime;
+        int64_t size = (int64_t) fileStat.st_size;
+        char *path = TemplateTablePath(fullPath);
+        if (!templatesPath || strcmp(path, templatesPath)) {
+            free(templatesPath);
+            templatesPath = path;
+            templatesHash = TemplateTableFileHash(fullPath);
+        } else {
+            free(path);
+        }
+
+        int oldIdx = EntryFind(index, relativePath);
+        ProjectIndexEntry *old = oldIdx >= 0 ? index->entries + oldIdx : NULL;
+        // Entries are parsed again when the templates changed, including the invalid ones they might fix.
+        bool templatesMatch = old && old->templatesHash == templatesHash;
+        if (templatesMatch && old->modified == modified && old->size == size) {
+            kept[oldIdx] = true;
+            LIST_ADD(&entries, *old);
+            stats->unchanged++;
+            free(fullPath);
+            continue;
+        }
+
+        size_t dataSize;
+        unsigned char *data = FilesRead(fullPath, &dataSize);
+        if (!data) {
+            printf("Failed to read %s for the project index. Skipping.\n", fullPath);
+            free(fullPath);
+            continue;
+        }
+        uint64_t contentHash = HashBytes(HASH_SEED, data, dataSize);
+        free(data);
+
+        if (templatesMatch && old->contentHash == contentHash) {
+            kept[oldIdx] = true;
+            old->modified = modified;
+            old->size = size;
+            LIST_ADD(&entries, *old);
+            stats->touched++;
+            free(fullPath);
+            continue;
+        }
+
+        // Replaced below. The path moves to the new entry since the search above still compares the old paths.
+        char *entryPath;
+        if (old) {
+            kept[oldIdx] = true;
+            entryPath = old->path;
+            EntryLayersFree(old);
+        } else {
+            entryPath = StringCopy(relativePath, (int) strlen(relativePath));
+        }
+        ProjectIndexEntry entry = {
+            .path = entryPath,
+            .modified = modified,
+            .size = size,
+            .contentHash = contentHash,
+            .templatesHash = templatesHash
+        };
+        EntrySummarize(&entry, fullPath);
+        LIST_ADD(&entries, entry);
+        stats->parsed++;
+        free(fullPath);
+    }
+
+    for (int i = 0; i < LIST_COUNT(index->entries); i++) {
+        if (kept[i]) continue;
+        EntryFree(index->entries + i);
+        stats->removed++;
+    }
+    free(kept);
+    free(templatesPath);
+    LIST_FREE(index->entries);
+    index->entries = entries;
+
+    for (int i = 0; i < LIST_COUNT(paths); i++) free(paths[i]);
+    LIST_FREE(paths);
+    LIST_FREE(relativePaths);
+    return stats->touched + stats->parsed + stats->removed > 0;
+}
+
+const char *ProjectIndexLayerTypeName(LayerType type) {
+    switch (type) {
+        case LAYER_HITBOX: return "hitbox";
+        case LAYER_SHAPE: return "shape";
+        case LAYER_BEZIER: return "bezier";
+        case LAYER_EMPTY: return "empty";
+    }
+    return "unknown";
+}
+
+int ProjectIndexQueryLayer(ProjectIndex *index, const char *name, int type, FILE *file) {
+    int matches = 0;
+    for (int i = 0; i < LIST_COUNT(index->entries); i++) {
+        ProjectIndexEntry *entry = index->entries + i;
+        for (int layerIdx = 0; layerIdx < LIST_COUNT(entry->layers); layerIdx++) {
+            ProjectIndexLayer *layer = entry->layers + layerIdx;
+            if ((type >= 0 && (int) layer->type != type) || strcmp(layer->name, name)) continue;
+            fprintf(file, "%s\n", entry->path);
+            matches++;
+            break;
+        }
+    }
+    return matches;
+}
+
+void ProjectIndexPrint(ProjectIndex *index, FILE *file) {
+    for (int i = 0; i < LIST_COUNT(index->entries); i++) {
+        ProjectIndexEntry *entry = index->entries + i;
+        if (!entry->valid) continue;
+        fprintf(file, "%s: %i frames, %i ms, %016llx\n", entry->path, entry->frameCount, entry->duration,
+            (unsigned long long) entry->contentHash);
+        for (int layerIdx = 0; layerIdx < LIST_COUNT(entry->layers); layerIdx++) {
+            fprintf(file, "    %s %s\n", ProjectIndexLayerTypeName(entry->layers[layerIdx].type), entry->layers[layerIdx].name);
+        }
+    }
+}
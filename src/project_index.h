@@ -0,0 +1,68 @@
+#ifndef PROJECT_INDEX_H
+#define PROJECT_INDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "layer.h"
+#include "list.h"
+
+#define PROJECT_INDEX_FILE ".cacindex"
+#define PROJECT_INDEX_MAGIC "CAIX"
+#define PROJECT_INDEX_VERSION 2
+
+// Index file layout. Little endian like the binary export, no padding.
+//  char[4] magic, u32 version, u32 fileVersion (FILE_VERSION_CURRENT when written), u32 entryCount
+//  entryCount times:
+//      u16 pathLength, path, i64 modified, i64 size, u64 contentHash, u64 templatesHash, u8 valid
+//      valid entries: u32 frameCount, i32 duration, u16 layerCount
+//          layerCount times: u8 type (LayerType), u16 nameLength, name
+// Paths are relative to the indexed directory. The whole index is rewritten whenever it changes.
+
+typedef struct ProjectIndexLayer {
+    char *name;
+    LayerType type;
+} ProjectIndexLayer;
+
+typedef struct ProjectIndexEntry {
+    char *path;
+    int64_t modified;
+    int64_t size;
+    uint64_t contentHash; // Of the file's bytes.
+    // TemplateTableFileHash of the file. Linked layers load values from the templates, so whether the file parses
+    // depends on them as well.
+    uint64_t templatesHash;
+    bool valid; // false for json files that aren't animations, kept so they aren't parsed again until either hash changes.
+    int frameCount;
+    int duration; // Sum of the frame durations.
+    LIST(ProjectIndexLayer) layers;
+} ProjectIndexEntry;
+
+typedef struct ProjectIndex {
+    LIST(ProjectIndexEntry) entries; // Sorted by path.
+} ProjectIndex;
+
+typedef struct ProjectIndexUpdateStats {
+    int unchanged; // Size and modification time matched so the file wasn't opened.
+    int touched; // Opened but the content hash matched.
+    int parsed;
+    int removed;
+} ProjectIndexUpdateStats;
+
+ProjectIndex ProjectIndexNew(void);
+void ProjectIndexFree(ProjectIndex *index);
+// Loads directory/PROJECT_INDEX_FILE. Returns an empty index if it is missing, unreadable or from another version.
+ProjectIndex ProjectIndexLoad(const char *directory);
+bool ProjectIndexSave(ProjectIndex *index, const char *directory);
+// Walks directory for animation files. Files whose size, modification time and templates hash match their entry are
+// not opened, files whose content hash matches as well only get their times updated, and the rest are deserialized.
+// Entries for files that are gone are dropped. Returns true if anything changed.
+bool ProjectIndexUpdate(ProjectIndex *index, const char *directory, ProjectIndexUpdateStats *stats);
+
+const char *ProjectIndexLayerTypeName(LayerType type);
+// Prints the path of every valid animation with a layer named name. type -1 matches any layer type.
+// Returns the number of matches.
+int ProjectIndexQueryLayer(ProjectIndex *index, const char *name, int type, FILE *file);
+void ProjectIndexPrint(ProjectIndex *index, FILE *file);
+
+#endif
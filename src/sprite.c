@@ -0,0 +1,221 @@
+#include <assert.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "editor_history.h"
+#include "list.h"
+#include "string_buffer.h"
+#include "worker_pool.h"
+#include "sprite.h"
+
+SpriteSourceType SpriteSourceDetect(const char *name) {
+    StringBuffer pathBuffer = STRING_BUFFER_NEW();
+    StringBufferAddString(&pathBuffer, name);
+    StringBufferAddString(&pathBuffer, ".png");
+    char *path = StringBufferFree(&pathBuffer);
+    
+    SpriteSourceType type = SPRITE_SOURCE_STRIP;
+    if (!FileExists(path) && DirectoryExists(name)) type = SPRITE_SOURCE_SEQUENCE;
+    free(path);
+    return type;
+}
+
+// The number used to order a frame is the last run of digits in its file name. "Jab_012.png" is frame 12.
+static long SequenceNumber(const char *path) {
+    const char *fileName = GetFileName(path);
+    const char *end = strrchr(fileName, '.');
+    if (!end) end = fileName + strlen(fileName);
+    
+    const char *start = end;
+    while (start > fileName && isdigit((unsigned char) start[-1])) start--;
+    if (start == end) return -1;
+    return strtol(start, NULL, 10);
+}
+
+static int SequenceCompare(const void *a, const void *b) {
+    const SpriteFrame *frameA = a;
+    const SpriteFrame *frameB = b;
+    long numberA = SequenceNumber(frameA->path);
+    long numberB = SequenceNumber(frameB->path);
+    if (numberA != numberB) return numberA < numberB ? -1 : 1;
+    return strcmp(frameA->path, frameB->path);
+}
+
+static void SpriteFrameDecode(void *data) {
+    SpriteFrame *frame = data;
+    Image image = LoadImage(frame->path); // No GPU access so this is safe off of the main thread.
+    
+    pthread_mutex_lock(frame->mutex);
+    if (image.data) {
+        frame->image = image;
+        frame->status = SPRITE_FRAME_DECODED;
+    } else {
+        frame->status = SPRITE_FRAME_FAILED;
+    }
+    pthread_mutex_unlock(frame->mutex);
+}
+
+static void SpriteFrameRequest(Sprite *sprite, int frameIdx) {
+    if (frameIdx < 0 || frameIdx >= LIST_COUNT(sprite->frames)) return;
+    SpriteFrame *frame = sprite->frames + frameIdx;
+    
+    pthread_mutex_lock(&sprite->mutex);
+    bool request = frame->status == SPRITE_FRAME_UNLOADED;
+    if (request) frame->status = SPRITE_FRAME_DECODING;
+    pthread_mutex_unlock(&sprite->mutex);
+    
+    if (request) WorkerPoolPush(sprite->workers, SpriteFrameDecode, frame);
+}
+
+static void SpriteUpload(Sprite *sprite) {
+    pthread_mutex_lock(&sprite->mutex);
+    for (int i = 0; i < LIST_COUNT(sprite->frames); i++) {
+        SpriteFrame *frame = sprite->frames + i;
+        if (frame->status != SPRITE_FRAME_DECODED) continue;
+        frame->texture = LoadTextureFromImage(frame->image);
+        UnloadImage(frame->image);
+        frame->status = frame->texture.id > 0 ? SPRITE_FRAME_READY : SPRITE_FRAME_FAILED;
+    }
+    pthread_mutex_unlock(&sprite->mutex);
+}
+
+bool SpriteLoad(Sprite *sprite, const char *name, SpriteSourceType type) {
+    sprite->type = type;
+    sprite->texture = (Texture2D) {0};
+    sprite->frames = NULL;
+    sprite->workers = NULL;
+
+    if (type != SPRITE_SOURCE_SEQUENCE) {
+        StringBuffer pathBuffer = STRING_BUFFER_NEW();
+        StringBufferAddString(&pathBuffer, name);
+        StringBufferAddString(&pathBuffer, ".png");
+        char *path = StringBufferFree(&pathBuffer);
+        sprite->texture = LoadTexture(path);
+        free(path);
+        return sprite->texture.id > 0;
+    }
+
+    if (!DirectoryExists(name)) {
+        printf("Failed to find the image sequence directory %s.\n", name);
+        return false;
+    }
+    
+    FilePathList paths = LoadDirectoryFilesEx(name, ".png", false);
+    if (paths.count == 0) {
+        printf("The image sequence directory %s has no png files.\n", name);
+        UnloadDirectoryFiles(paths);
+        return false;
+    }
+
+    pthread_mutex_init(&sprite->mutex, NULL);
+    sprite->frames = LIST_NEW_SIZED(SpriteFrame, paths.count);
+    for (unsigned int i = 0; i < paths.count; i++) {
+        StringBuffer pathBuffer = STRING_BUFFER_NEW();
+        StringBufferAddString(&pathBuffer, paths.paths[i]);
+        sprite->frames[i] = (SpriteFrame) {
+            .path = StringBufferFree(&pathBuffer),
+            .mutex = &sprite->mutex,
+            .status = SPRITE_FRAME_UNLOADED
+        };
+    }
+    UnloadDirectoryFiles(paths);
+    qsort(sprite->frames, LIST_COUNT(sprite->frames), sizeof(SpriteFrame), SequenceCompare);
+    
+    sprite->workers = WorkerPoolNew(WORKER_POOL_THREADS_DEFAULT);
+    
+    // The first frame is needed right away to size the window, so wait on it.
+    SpriteFrameRequest(sprite, 0);
+    WorkerPoolWait(sprite->workers);
+    SpriteUpload(sprite);
+    if (sprite->frames[0].status != SPRITE_FRAME_READY) {
+        printf("Failed to load the first image of the sequence at %s.\n", sprite->frames[0].path);
+        SpriteFree(sprite);
+        return false;
+    }
+    return true;
+}
+
+void SpriteFree(Sprite *sprite) {
+    if (sprite->type != SPRITE_SOURCE_SEQUENCE) {
+        UnloadTexture(sprite->texture);
+        return;
+    }
+    
+    WorkerPoolFree(sprite->workers); // Joins the workers so nothing touches the frames after this.
+    for (int i = 0; i < LIST_COUNT(sprite->frames); i++) {
+        SpriteFrame *frame = sprite->frames + i;
+        if (frame->status == SPRITE_FRAME_DECODED) UnloadImage(frame->image);
+        else if (frame->status == SPRITE_FRAME_READY) UnloadTexture(frame->texture);
+        free(frame->path);
+    }
+    LIST_FREE(sprite->frames);
+    pthread_mutex_destroy(&sprite->mutex);
+}
+
+int SpriteImageCount(Sprite *sprite) {
+    if (sprite->type != SPRITE_SOURCE_SEQUENCE) return 0;
+    return LIST_COUNT(sprite->frames);
+}
+
+void SpriteUpdate(Sprite *sprite, EditorState *state, int frameIdx) {
+    if (sprite->type != SPRITE_SOURCE_SEQUENCE) return;
+    for (int i = 0; i <= SPRITE_PREFETCH_FRAMES; i++) {
+        SpriteFrameRequest(sprite, (frameIdx + i) % state->frameCount);
+    }
+    SpriteUpload(sprite);
+}
+
+bool SpriteFrameGet(Sprite *sprite, EditorState *state, int frameIdx, Texture2D *texture, Rectangle *source) {
+    assert(0 <= frameIdx && frameIdx < state->frameCount);
+    switch (sprite->type) {
+        case SPRITE_SOURCE_STRIP: {
+            float frameWidth = (float) (sprite->texture.width / state->frameCount);
+            *texture = sprite->texture;
+            *source = (Rectangle) {
+                .x = frameWidth * frameIdx,
+                .y = 0.0f,
+                .width = frameWidth,
+                .height = (float) sprite->texture.height
+            };
+            return true;
+        }
+        
+        case SPRITE_SOURCE_ATLAS:
+            *texture = sprite->texture;
+            *source = state->frames[frameIdx].atlasRect;
+            return source->width > 0.0f && source->height > 0.0f;
+        
+        case SPRITE_SOURCE_SEQUENCE: {
+            if (frameIdx >= LIST_COUNT(sprite->frames)) return false;
+            SpriteFrame *frame = sprite->frames + frameIdx;
+            pthread_mutex_lock(&sprite->mutex);
+            bool ready = frame->status == SPRITE_FRAME_READY;
+            pthread_mutex_unlock(&sprite->mutex);
+            if (!ready) return false;
+            *texture = frame->texture;
+            *source = (Rectangle) {0.0f, 0.0f, (float) frame->texture.width, (float) frame->texture.height};
+            return true;
+        }
+    }
+    assert(false);
+    return false;
+}
+
+Vector2 SpriteFrameSize(Sprite *sprite, EditorState *state, int frameIdx) {
+    Texture2D texture;
+    Rectangle source;
+    if (SpriteFrameGet(sprite, state, frameIdx, &texture, &source)) {
+        return (Vector2) {source.width, source.height};
+    }
+    
+    // Frames that aren't loaded yet are assumed to be the same size as the first one, which is always loaded.
+    if (sprite->type == SPRITE_SOURCE_SEQUENCE) {
+        Texture2D first = sprite->frames[0].texture;
+        return (Vector2) {(float) first.width, (float) first.height};
+    }
+    return (Vector2) {0.0f, 0.0f};
+}
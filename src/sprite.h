@@ -0,0 +1,58 @@
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include "raylib.h"
+#include "editor_history.h"
+#include "list.h"
+#include "worker_pool.h"
+
+// How many frames after the one being shown get decoded ahead of time for sequence sources.
+#define SPRITE_PREFETCH_FRAMES 2
+
+typedef enum SpriteFrameStatus {
+    SPRITE_FRAME_UNLOADED,
+    SPRITE_FRAME_DECODING, // Queued or being decoded on a worker thread.
+    SPRITE_FRAME_DECODED, // image is valid and waiting to be uploaded on the main thread.
+    SPRITE_FRAME_READY, // texture is valid.
+    SPRITE_FRAME_FAILED
+} SpriteFrameStatus;
+
+typedef struct SpriteFrame {
+    char *path;
+    pthread_mutex_t *mutex; // Owned by the sprite. Guards status and image.
+    SpriteFrameStatus status;
+    Image image;
+    Texture2D texture;
+} SpriteFrame;
+
+// The images that an animation is drawn from. See SpriteSourceType.
+// Strips and atlases are a single texture loaded up front.
+// Sequences are decoded lazily on worker threads, and only the frames that get shown are ever loaded.
+// Textures can only be created on the main thread so decoded images are uploaded in SpriteUpdate.
+typedef struct Sprite {
+    SpriteSourceType type;
+    Texture2D texture; // Strip and atlas only.
+    
+    LIST(SpriteFrame) frames; // Sequence only. Sorted by the number in the file name.
+    WorkerPool *workers;
+    pthread_mutex_t mutex;
+} Sprite;
+
+SpriteSourceType SpriteSourceDetect(const char *name);
+
+// Not movable after it is loaded because the worker threads point into it.
+bool SpriteLoad(Sprite *sprite, const char *name, SpriteSourceType type);
+void SpriteFree(Sprite *sprite);
+
+// Number of images a sequence has, or 0 if the number of frames is not decided by the source.
+int SpriteImageCount(Sprite *sprite);
+
+// Call once per tick. Requests the given frame and the ones after it and uploads anything that finished decoding.
+void SpriteUpdate(Sprite *sprite, EditorState *state, int frameIdx);
+// Returns false if the frame has no image yet (still decoding, missing, or failed to load).
+bool SpriteFrameGet(Sprite *sprite, EditorState *state, int frameIdx, Texture2D *texture, Rectangle *source);
+Vector2 SpriteFrameSize(Sprite *sprite, EditorState *state, int frameIdx);
+
+#endif
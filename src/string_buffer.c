@@ -2,22 +2,20 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include "allocator.h"
 #include "string_buffer.h"
 
-StringBuffer StringBufferNew() {
-    char *str = malloc(sizeof(char) * INITIAL_MAXIMUM_LENGTH);
+StringBuffer StringBufferNew(const char *tag) {
+    char *str = AllocatorResize(NULL, 0, sizeof(char) * INITIAL_MAXIMUM_LENGTH, tag);
     str[0] = '\0';
-    return (StringBuffer) {INITIAL_MAXIMUM_LENGTH, 0, str};
+    return (StringBuffer) {INITIAL_MAXIMUM_LENGTH, 0, str, tag};
 }
 
 void StringBufferAddChar(StringBuffer *string, char chr) {
     int requiredSize = string->length + 2;
     if (requiredSize > string->mallocSize) { // if the new char and the null ending char plus the length is greater than 0 then reallocate.
         int newMaxSize = (int) ceilf((float) sizeof(char) * (float) requiredSize * EXPAND_AMOUNT);
-        char *newRaw = malloc(sizeof(char) * newMaxSize);
-        memcpy(newRaw, string->raw, sizeof(char) * string->length);
-        free(string->raw);
-        string->raw = newRaw;
+        string->raw = AllocatorResize(string->raw, string->mallocSize, sizeof(char) * newMaxSize, string->tag);
         string->mallocSize = newMaxSize;
     }
     string->raw[string->length] = chr;
@@ -49,5 +47,12 @@ void StringBufferClear(StringBuffer *string) {
 }
 
 char *StringBufferFree(StringBuffer *string) {
-    return string->raw;
+    return AllocatorDetach(string->raw, string->mallocSize, string->tag);
+}
+
+char *StringCopy(const char *string, size_t length) {
+    char *copy = malloc(length + 1);
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    return copy;
 }
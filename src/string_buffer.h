@@ -1,8 +1,11 @@
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifndef STRING_BUFFER_H
 #define STRING_BUFFER_H
 
+#include "allocator.h"
+
 #define EXPAND_AMOUNT 1.5f
 #define INITIAL_MAXIMUM_LENGTH 11
 
@@ -10,13 +13,19 @@ typedef struct StringBuffer {
     int mallocSize;
     int length;
     char *raw;
+    const char *tag; // Allocation tag of the call site that made the buffer.
 } StringBuffer;
 
-StringBuffer StringBufferNew();
+StringBuffer StringBufferNew(const char *tag);
+#define STRING_BUFFER_NEW() StringBufferNew(ALLOCATOR_TAG)
 void StringBufferAddChar(StringBuffer *string, char chr);
 void StringBufferAddString(StringBuffer *string, const char *end);
 bool StringBufferRemoveChar(StringBuffer *string);
 void StringBufferClear(StringBuffer *string);
+// The returned string belongs to the caller and is released with free().
 char *StringBufferFree(StringBuffer *string);
 
+// The first length characters of string in a new null terminated string, released with free().
+char *StringCopy(const char *string, size_t length);
+
 #endif
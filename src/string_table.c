@@ -0,0 +1,82 @@
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "allocator.h"
+#include "arena.h"
+#include "hash.h"
+#include "string_table.h"
+
+StringTable *StringTableNew(void) {
+    StringTable *table = AllocatorResize(NULL, 0, sizeof(StringTable), ALLOCATOR_TAG);
+    size_t entriesSize = sizeof(StringTableEntry) * STRING_TABLE_CAPACITY_INITIAL;
+    *table = (StringTable) {
+        .references = 1,
+        .entries = AllocatorResize(NULL, 0, entriesSize, ALLOCATOR_TAG),
+        .capacity = STRING_TABLE_CAPACITY_INITIAL,
+        .count = 0,
+        .strings = ArenaNew(STRING_TABLE_ARENA_BLOCK_SIZE)
+    };
+    memset(table->entries, 0, entriesSize);
+    return table;
+}
+
+StringTable *StringTableRetain(StringTable *table) {
+    table->references++;
+    return table;
+}
+
+void StringTableRelease(StringTable *table) {
+    assert(table->references > 0);
+    table->references--;
+    if (table->references > 0) return;
+    ArenaFree(&table->strings);
+    AllocatorResize(table->entries, sizeof(StringTableEntry) * table->capacity, 0, ALLOCATOR_TAG);
+    AllocatorResize(table, sizeof(StringTable), 0, ALLOCATOR_TAG);
+}
+
+// Returns the slot holding the string or the empty slot where it would go.
+static int StringTableSlot(StringTable *table, const char *string, uint64_t hash) {
+    int mask = table->capacity - 1;
+    int idx = (int) (hash & mask);
+    while (table->entries[idx].string) {
+        StringTableEntry *entry = table->entries + idx;
+        if (entry->hash == hash && !strcmp(entry->string, string)) break;
+        idx = (idx + 1) & mask;
+    }
+    return idx;
+}
+
+const char *StringTableIntern(StringTable *table, const char *string) {
+    uint64_t hash = HashString(string);
+    int idx = StringTableSlot(table, string, hash);
+    if (table->entries[idx].string) return table->entries[idx].string;
+    
+    if ((table->count + 1) * 2 > table->capacity) { // grow at 50% load
+        StringTableEntry *old = table->entries;
+        int oldCapacity = table->capacity;
+        table->capacity *= 2;
+        size_t entriesSize = sizeof(StringTableEntry) * table->capacity;
+        table->entries = AllocatorResize(NULL, 0, entriesSize, ALLOCATOR_TAG);
+        memset(table->entries, 0, entriesSize);
+        for (int i = 0; i < oldCapacity; i++) {
+            if (old[i].string) table->entries[StringTableSlot(table, old[i].string, old[i].hash)] = old[i];
+        }
+        AllocatorResize(old, sizeof(StringTableEntry) * oldCapacity, 0, ALLOCATOR_TAG);
+        idx = StringTableSlot(table, string, hash);
+    }
+
+    table->entries[idx] = (StringTableEntry) {
+        .hash = hash,
+        .string = ArenaStringCopy(&table->strings, string)
+    };
+    table->count++;
+    return table->entries[idx].string;
+}
+
+const char *StringTableFind(StringTable *table, const char *string) {
+    return table->entries[StringTableSlot(table, string, HashString(string))].string;
+}
+
+size_t StringTableMemorySize(StringTable *table) {
+    return sizeof(StringTable) + sizeof(StringTableEntry) * table->capacity + table->strings.used;
+}
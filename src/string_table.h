@@ -0,0 +1,37 @@
+#ifndef STRING_TABLE_H
+#define STRING_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+
+#define STRING_TABLE_CAPACITY_INITIAL 64 // Power of 2.
+#define STRING_TABLE_ARENA_BLOCK_SIZE 1024
+
+typedef struct StringTableEntry {
+    uint64_t hash;
+    const char *string; // NULL when the slot is empty.
+} StringTableEntry;
+
+// Interns strings so each distinct string is stored once and equal strings have equal pointers.
+// Strings are never removed, they live as long as the table, so pointers can be kept anywhere the table is referenced.
+// A table is shared by a document and all of its undo snapshots through reference counting.
+// Not thread safe.
+typedef struct StringTable {
+    int references;
+    StringTableEntry *entries; // Open addressed by hash.
+    int capacity;
+    int count;
+    Arena strings;
+} StringTable;
+
+StringTable *StringTableNew(void); // Starts with one reference.
+StringTable *StringTableRetain(StringTable *table);
+void StringTableRelease(StringTable *table);
+
+const char *StringTableIntern(StringTable *table, const char *string);
+// Returns the interned pointer or NULL if the string was never interned. Doesn't add anything.
+const char *StringTableFind(StringTable *table, const char *string);
+size_t StringTableMemorySize(StringTable *table);
+
+#endif
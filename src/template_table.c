@@ -0,0 +1,224 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "editor_history.h"
+#include "files.h"
+#include "hash.h"
+#include "json_schema.h"
+#include "layer.h"
+#include "list.h"
+#include "string_buffer.h"
+#include "template_table.h"
+
+TemplateTable *TemplateTableNew(const char *path) {
+    TemplateTable *table = malloc(sizeof(TemplateTable));
+    *table = (TemplateTable) {
+        .references = 1,
+        .path = path ? StringCopy(path, strlen(path)) : NULL,
+        .templates = LIST_NEW(LayerTemplate)
+    };
+    return table;
+}
+
+TemplateTable *TemplateTableRetain(TemplateTable *table) {
+    table->references++;
+    return table;
+}
+
+void TemplateTableRelease(TemplateTable *table) {
+    if (--table->references > 0) return;
+    for (int i = 0; i < LIST_COUNT(table->templates); i++) free(table->templates[i].name);
+    LIST_FREE(table->templates);
+    free(table->path);
+    free(table);
+}
+
+LayerTemplate *TemplateTableFind(TemplateTable *table, const char *name) {
+    // Projects have a handful of templates and they are only looked up when loading and linking.
+    for (int i = 0; i < LIST_COUNT(table->templates); i++) {
+        if (!strcmp(table->templates[i].name, name)) return table->templates + i;
+    }
+    return NULL;
+}
+
+LayerTemplate *TemplateTableSet(TemplateTable *table, LayerTemplate values) {
+    LayerTemplate *existing = TemplateTableFind(table, values.name);
+    if (existing) {
+        char *name = existing->name;
+        *existing = values;
+        existing->name = name;
+        return existing;
+    }
+    values.name = StringCopy(values.name, strlen(values.name));
+    LIST_ADD(&table->templates, values);
+    return table->templates + LIST_COUNT(table->templates) - 1;
+}
+
+enum {TABLE_MAGIC, TABLE_VERSION, TABLE_TEMPLATES, TABLE_FIELD_COUNT};
+static const char *const tableKeys[] = {"magic", "version", "templates"};
+enum {TEMPLATE_NAME, TEMPLATE_SHAPE, TEMPLATE_KNOCKBACK_X, TEMPLATE_KNOCKBACK_Y, TEMPLATE_DAMAGE, TEMPLATE_STUN, TEMPLATE_FLAGS, TEMPLATE_FIELD_COUNT};
+static const char *const templateKeys[] = {"name", "shape", "knockbackX", "knockbackY", "damage", "stun", "flags"};
+
+static JsonSchema tableSchema;
+static JsonSchema templateSchema;
+static pthread_once_t schemasOnce = PTHREAD_ONCE_INIT;
+
+static void SchemasInit(void) {
+    JsonSchemaInit(&tableSchema, tableKeys, TABLE_FIELD_COUNT);
+    JsonSchemaInit(&templateSchema, templateKeys, TEMPLATE_FIELD_COUNT);
+}
+
+static bool TemplateDeserialize(cJSON *json, LayerTemplate *layerTemplate) {
+    if (!cJSON_IsObject(json)) return false;
+    cJSON *fields[TEMPLATE_FIELD_COUNT];
+    JsonSchemaRead(&templateSchema, json, fields);
+    if (!cJSON_IsString(fields[TEMPLATE_NAME])) return false;
+    for (int i = TEMPLATE_KNOCKBACK_X; i <= TEMPLATE_FLAGS; i++) {
+        if (!cJSON_IsNumber(fields[i])) return false;
+    }
+    int errorLine;
+    if (!ShapeDeserialize(fields[TEMPLATE_SHAPE], &layerTemplate->shape, FILE_VERSION_CURRENT, &errorLine)) return false;
+    layerTemplate->name = cJSON_GetStringValue(fields[TEMPLATE_NAME]);
+    layerTemplate->knockbackX = (int) cJSON_GetNumberValue(fields[TEMPLATE_KNOCKBACK_X]);
+    layerTemplate->knockbackY = (int) cJSON_GetNumberValue(fields[TEMPLATE_KNOCKBACK_Y]);
+    layerTemplate->damage = (int) cJSON_GetNumberValue(fields[TEMPLATE_DAMAGE]);
+    layerTemplate->stun = (int) cJSON_GetNumberValue(fields[TEMPLATE_STUN]);
+    layerTemplate->flags = (unsigned int) cJSON_GetNumberValue(fields[TEMPLATE_FLAGS]);
+    return true;
+}
+
+char *TemplateTablePath(const char *animationPath) {
+    // The project is the directory the animation is in.
+    const char *baseName = FilesBaseName(animationPath);
+    if (baseName == animationPath) return FilesJoin(".", TEMPLATE_TABLE_FILE);
+    char *directory = StringCopy(animationPath, (size_t) (baseName - animationPath - 1)); // Without the separator.
+    char *path = FilesJoin(directory, TEMPLATE_TABLE_FILE);
+    free(directory);
+    return path;
+}
+
+uint64_t TemplateTableFileHash(const char *animationPath) {
+    char *path = TemplateTablePath(animationPath);
+    size_t size;
+    unsigned char *data = FilesRead(path, &size);
+    free(path);
+    if (!data) return 0;
+    uint64_t hash = HashBytes(HASH_SEED, data, size);
+    free(data);
+    return hash;
+}
+
+TemplateTable *TemplateTableLoad(const char *animationPath) {
+    char *path = TemplateTablePath(animationPath);
+    TemplateTable *table = TemplateTableNew(path);
+    free(path);
+
+    size_t size;
+    char *text = (char *) FilesRead(table->path, &size);
+    if (!text) return table;
+    cJSON *json = cJSON_ParseWithLength(text, size);
+    free(text);
+
+    pthread_once(&schemasOnce, SchemasInit);
+    bool success = false;
+    if (cJSON_IsObject(json)) {
+        cJSON *fields[TABLE_FIELD_COUNT];
+        JsonSchemaRead(&tableSchema, json, fields);
+        cJSON *version = fields[TABLE_VERSION];
+        cJSON *templates = fields[TABLE_TEMPLATES];
+        success = cJSON_IsString(fields[TABLE_MAGIC]) && !strcmp(cJSON_GetStringValue(fields[TABLE_MAGIC]), TEMPLATE_TABLE_MAGIC)
+            && cJSON_IsNumber(version) && (int) cJSON_GetNumberValue(version) <= TEMPLATE_TABLE_VERSION
+            && cJSON_IsArray(templates);
+
+        cJSON *templateJson = success ? templates->child : NULL;
+        for (; templateJson; templateJson = templateJson->next) {
+            LayerTemplate layerTemplate;
+            success = TemplateDeserialize(templateJson, &layerTemplate) && !TemplateTableFind(table, layerTemplate.name);
+            if (!success) break;
+            TemplateTableSet(table, layerTemplate);
+        }
+    }
+    cJSON_Delete(json);
+    if (!success) {
+        printf("Failed to read the templates in %s. Linked layers that rely on them won't load and templates can't be saved until it is fixed.\n", table->path);
+        table->readOnly = true;
+        for (int i = 0; i < LIST_COUNT(table->templates); i++) free(table->templates[i].name);
+        LIST_SHRINK(table->templates, 0);
+    }
+    return table;
+}
+
+bool TemplateTableSave(TemplateTable *table) {
+    if (!table->path || table->readOnly) return false;
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddStringToObject(json, "magic", TEMPLATE_TABLE_MAGIC);
+    cJSON_AddNumberToObject(json, "version", TEMPLATE_TABLE_VERSION);
+    cJSON *templates = cJSON_AddArrayToObject(json, "templates");
+    for (int i = 0; i < LIST_COUNT(table->templates); i++) {
+        LayerTemplate *layerTemplate = table->templates + i;
+        cJSON *templateJson = cJSON_CreateObject();
+        cJSON_AddStringToObject(templateJson, "name", layerTemplate->name);
+        cJSON_AddItemToObject(templateJson, "shape", ShapeSerialize(layerTemplate->shape));
+        cJSON_AddNumberToObject(templateJson, "knockbackX", layerTemplate->knockbackX);
+        cJSON_AddNumberToObject(templateJson, "knockbackY", layerTemplate->knockbackY);
+        cJSON_AddNumberToObject(templateJson, "damage", layerTemplate->damage);
+        cJSON_AddNumberToObject(templateJson, "stun", layerTemplate->stun);
+        cJSON_AddNumberToObject(templateJson, "flags", layerTemplate->flags);
+        cJSON_AddItemToArray(templates, templateJson);
+    }
+    char *text = cJSON_Print(json);
+    cJSON_Delete(json);
+    bool success = FilesWrite(table->path, text, strlen(text));
+    free(text);
+    return success;
+}
+
+unsigned int TemplateFields(LayerType type) {
+    switch (type) {
+        case LAYER_HITBOX: return TEMPLATE_FIELD_KNOCKBACK | TEMPLATE_FIELD_DAMAGE | TEMPLATE_FIELD_STUN | TEMPLATE_FIELD_SHAPE;
+        case LAYER_SHAPE: return TEMPLATE_FIELD_FLAGS | TEMPLATE_FIELD_SHAPE;
+        case LAYER_BEZIER:
+        case LAYER_EMPTY:
+            return 0;
+    }
+    return 0;
+}
+
+LayerTemplate TemplateFromLayer(Layer *layer, const char *name) {
+    LayerTemplate layerTemplate = {.name = (char *) name};
+    layerTemplate.shape = *LayerShapeBase(layer);
+    if (layer->type == LAYER_HITBOX) {
+        layerTemplate.knockbackX = layer->hitbox.knockbackX;
+        layerTemplate.knockbackY = layer->hitbox.knockbackY;
+        layerTemplate.damage = layer->hitbox.damage;
+        layerTemplate.stun = layer->hitbox.stun;
+    } else {
+        layerTemplate.flags = layer->shape.flags;
+    }
+    return layerTemplate;
+}
+
+unsigned int TemplateOverrides(const LayerTemplate *layerTemplate, Layer *layer) {
+    unsigned int fields = TemplateFields(layer->type);
+    if (!layerTemplate) return fields;
+
+    unsigned int overrides = layer->templateOverrides;
+    if (LIST_COUNT(layer->keys) > 0) overrides |= TEMPLATE_FIELD_SHAPE;
+    return overrides & fields;
+}
+
+void TemplateApply(const LayerTemplate *layerTemplate, Layer *layer, unsigned int fields) {
+    fields &= TemplateFields(layer->type);
+    if (LIST_COUNT(layer->keys) > 0) fields &= ~TEMPLATE_FIELD_SHAPE;
+    if (fields & TEMPLATE_FIELD_SHAPE) *LayerShapeBase(layer) = layerTemplate->shape;
+    if (fields & TEMPLATE_FIELD_KNOCKBACK) {
+        layer->hitbox.knockbackX = layerTemplate->knockbackX;
+        layer->hitbox.knockbackY = layerTemplate->knockbackY;
+    }
+    if (fields & TEMPLATE_FIELD_DAMAGE) layer->hitbox.damage = layerTemplate->damage;
+    if (fields & TEMPLATE_FIELD_STUN) layer->hitbox.stun = layerTemplate->stun;
+    if (fields & TEMPLATE_FIELD_FLAGS) layer->shape.flags = layerTemplate->flags;
+}
@@ -0,0 +1,68 @@
+#ifndef TEMPLATE_TABLE_H
+#define TEMPLATE_TABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "layer.h"
+#include "list.h"
+
+#define TEMPLATE_TABLE_FILE "templates.cac" // Next to the animation files of a project.
+#define TEMPLATE_TABLE_MAGIC "CombatAnimatorTemplates"
+#define TEMPLATE_TABLE_VERSION 1
+
+// Shape and hitbox values that hitbox and shape layers of every animation in a project can link to by name.
+// A linked layer still holds every value so drawing and editing don't look templates up. The fields that were edited
+// on the layer are its overrides, kept in Layer.templateOverrides, and the rest follow the template: files only store
+// the overrides and get the rest from the table when they are loaded, and changing a template in the editor updates
+// the layers that didn't override it.
+// The file is a json object with "magic", "version" and a "templates" array of objects with "name", "shape",
+// "knockbackX", "knockbackY", "damage", "stun" and "flags".
+typedef struct LayerTemplate {
+    char *name;
+    Shape shape;
+    int knockbackX; // The hitbox values are only used by hitbox layers.
+    int knockbackY;
+    int damage;
+    int stun;
+    unsigned int flags; // Only used by shape layers.
+} LayerTemplate;
+
+// Shared by a document and all of its undo snapshots through reference counting, like the string table.
+// Templates belong to the project rather than a document, so changing them isn't part of the undo history.
+// Read only while other threads can use it.
+typedef struct TemplateTable {
+    int references;
+    char *path; // Where the table is saved. NULL for tables that aren't part of a project.
+    // Set when the file exists but couldn't be read, so saving the empty table doesn't overwrite the templates in it.
+    bool readOnly;
+    LIST(LayerTemplate) templates;
+} TemplateTable;
+
+TemplateTable *TemplateTableNew(const char *path); // Starts with one reference.
+// Loads the table of the project animationPath is in. Missing files give an empty table. Broken files print why
+// and give an empty, read only table as well, so only the linked layers that leave values to a template fail to load.
+TemplateTable *TemplateTableLoad(const char *animationPath);
+char *TemplateTablePath(const char *animationPath); // Where the project's table of animationPath is, malloc'ed.
+// Hash of the bytes of the project's table file, or 0 without one. Build cache keys of outputs that depend on the
+// templates include it.
+uint64_t TemplateTableFileHash(const char *animationPath);
+TemplateTable *TemplateTableRetain(TemplateTable *table);
+void TemplateTableRelease(TemplateTable *table);
+bool TemplateTableSave(TemplateTable *table); // Fails for read only tables.
+
+LayerTemplate *TemplateTableFind(TemplateTable *table, const char *name); // NULL if there is no such template.
+// Adds the template, or replaces the values of the one with the same name. The name is copied.
+LayerTemplate *TemplateTableSet(TemplateTable *table, LayerTemplate values);
+
+// The fields the layer type has, 0 for layers that can't be linked.
+unsigned int TemplateFields(LayerType type);
+// The values of a hitbox or shape layer under the given name, which isn't copied.
+LayerTemplate TemplateFromLayer(Layer *layer, const char *name);
+// The fields the layer stores itself: its overrides, or all of them for NULL. Layers with keys store their shape in
+// the keys so it always counts as overridden.
+unsigned int TemplateOverrides(const LayerTemplate *layerTemplate, Layer *layer);
+// Copies the given fields of the template into the layer, skipping the ones the layer type doesn't have and the
+// shape of layers with keys.
+void TemplateApply(const LayerTemplate *layerTemplate, Layer *layer, unsigned int fields);
+
+#endif
@@ -0,0 +1,145 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "raylib.h"
+#include "allocator.h"
+#include "hash.h"
+#include "list.h"
+#include "text_cache.h"
+
+static uint64_t HashKey(unsigned int fontTexture, float fontSize, float spacing, bool isInteger, int integer, const char *text) {
+    uint64_t hash = HASH_SEED;
+    hash = HashBytes(hash, &fontTexture, sizeof(fontTexture));
+    hash = HashBytes(hash, &fontSize, sizeof(fontSize));
+    hash = HashBytes(hash, &spacing, sizeof(spacing));
+    if (isInteger) hash = HashBytes(hash, &integer, sizeof(integer));
+    else hash = HashBytes(hash, text, strlen(text));
+    return hash ? hash : 1;
+}
+
+TextCache *TextCacheNew(void) {
+    TextCache *cache = AllocatorResize(NULL, 0, sizeof(TextCache), ALLOCATOR_TAG);
+    memset(cache->entries, 0, sizeof(cache->entries));
+    cache->entryCount = 0;
+    cache->text = LIST_NEW(char);
+    cache->glyphs = LIST_NEW(TextGlyph);
+    return cache;
+}
+
+void TextCacheFree(TextCache *cache) {
+    LIST_FREE(cache->text);
+    LIST_FREE(cache->glyphs);
+    AllocatorResize(cache, sizeof(TextCache), 0, ALLOCATOR_TAG);
+}
+
+void TextCacheClear(TextCache *cache) {
+    memset(cache->entries, 0, sizeof(cache->entries));
+    cache->entryCount = 0;
+    LIST_SHRINK(cache->text, 0);
+    LIST_SHRINK(cache->glyphs, 0);
+}
+
+// Same layout as DrawTextEx and DrawTextCodepoint in raylib 4.5.
+static TextRun TextLayout(TextCache *cache, Font font, float fontSize, float spacing, const char *text) {
+    TextRun run = {
+        .size = MeasureTextEx(font, text, fontSize, spacing),
+        .glyphIdx = LIST_COUNT(cache->glyphs),
+        .glyphCount = 0
+    };
+    
+    float scale = fontSize / (float) font.baseSize;
+    float padding = (float) font.glyphPadding;
+    Vector2 offset = {0.0f, 0.0f};
+    for (int i = 0; text[i] != '\0';) {
+        int codepointSize = 0;
+        int codepoint = GetCodepointNext(text + i, &codepointSize);
+        int glyphIdx = GetGlyphIndex(font, codepoint);
+        i += codepointSize;
+
+        if (codepoint == '\n') {
+            offset.y += (int) ((font.baseSize + font.baseSize / 2.0f) * scale);
+            offset.x = 0.0f;
+            continue;
+        }
+
+        Rectangle rect = font.recs[glyphIdx];
+        GlyphInfo glyph = font.glyphs[glyphIdx];
+        if (codepoint != ' ' && codepoint != '\t') {
+            TextGlyph textGlyph = {
+                .source = {rect.x - padding, rect.y - padding, rect.width + 2.0f * padding, rect.height + 2.0f * padding},
+                .dest = {
+                    offset.x + (glyph.offsetX - padding) * scale,
+                    offset.y + (glyph.offsetY - padding) * scale,
+                    (rect.width + 2.0f * padding) * scale,
+                    (rect.height + 2.0f * padding) * scale
+                }
+            };
+            LIST_ADD(&cache->glyphs, textGlyph);
+            run.glyphCount++;
+        }
+        
+        if (glyph.advanceX == 0) offset.x += rect.width * scale + spacing;
+        else offset.x += (float) glyph.advanceX * scale + spacing;
+    }
+    return run;
+}
+
+static TextRun TextCacheLookup(TextCache *cache, Font font, float fontSize, float spacing, bool isInteger, int integer, const char *text) {
+    if (cache->entryCount * 4 >= TEXT_CACHE_CAPACITY * 3) TextCacheClear(cache);
+
+    uint64_t hash = HashKey(font.texture.id, fontSize, spacing, isInteger, integer, text);
+    int mask = TEXT_CACHE_CAPACITY - 1;
+    int idx = (int) (hash & mask);
+    for (;; idx = (idx + 1) & mask) {
+        TextCacheEntry *entry = cache->entries + idx;
+        if (entry->hash == 0) break;
+        if (entry->hash != hash) continue;
+        if (entry->fontTexture != font.texture.id || entry->fontSize != fontSize || entry->spacing != spacing) continue;
+        if (entry->isInteger != isInteger) continue;
+        if (isInteger ? entry->integer != integer : strcmp(cache->text + entry->textIdx, text) != 0) continue;
+        return entry->run;
+    }
+    
+    char integerText[16];
+    if (isInteger) {
+        snprintf(integerText, sizeof(integerText), "%i", integer);
+        text = integerText;
+    }
+
+    TextCacheEntry *entry = cache->entries + idx;
+    *entry = (TextCacheEntry) {
+        .hash = hash,
+        .fontTexture = font.texture.id,
+        .fontSize = fontSize,
+        .spacing = spacing,
+        .isInteger = isInteger,
+        .integer = integer,
+        .textIdx = -1,
+        .run = TextLayout(cache, font, fontSize, spacing, text)
+    };
+    if (!isInteger) {
+        entry->textIdx = LIST_COUNT(cache->text);
+        LIST_ADD_ARRAY(&cache->text, text, (int) strlen(text) + 1);
+    }
+    cache->entryCount++;
+    return entry->run;
+}
+
+TextRun TextCacheGet(TextCache *cache, Font font, float fontSize, float spacing, const char *text) {
+    return TextCacheLookup(cache, font, fontSize, spacing, false, 0, text);
+}
+
+TextRun TextCacheGetInteger(TextCache *cache, Font font, float fontSize, float spacing, int integer) {
+    return TextCacheLookup(cache, font, fontSize, spacing, true, integer, NULL);
+}
+
+void TextCacheDraw(TextCache *cache, Font font, TextRun run, Vector2 pos, Color tint) {
+    for (int i = 0; i < run.glyphCount; i++) {
+        TextGlyph *glyph = cache->glyphs + run.glyphIdx + i;
+        Rectangle dest = glyph->dest;
+        dest.x += pos.x;
+        dest.y += pos.y;
+        DrawTexturePro(font.texture, glyph->source, dest, (Vector2) {0.0f, 0.0f}, 0.0f, tint);
+    }
+}
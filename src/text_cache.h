@@ -0,0 +1,57 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "raylib.h"
+#include "list.h"
+
+#define TEXT_CACHE_CAPACITY 1024 // Power of 2. The cache is cleared when it gets 3/4 full.
+
+typedef struct TextGlyph {
+    Rectangle source; // In the font texture.
+    Rectangle dest; // Relative to where the text is drawn.
+} TextGlyph;
+
+// Measured size and laid out glyphs of one piece of text in one font and size.
+typedef struct TextRun {
+    Vector2 size; // Same as MeasureTextEx.
+    int glyphIdx; // Into the cache's glyphs.
+    int glyphCount;
+} TextRun;
+
+typedef struct TextCacheEntry {
+    uint64_t hash; // 0 means the slot is empty.
+    unsigned int fontTexture;
+    float fontSize;
+    float spacing;
+    bool isInteger;
+    int integer;
+    int textIdx; // Into the cache's text when not an integer.
+    TextRun run;
+} TextCacheEntry;
+
+// Caches text measurement and layout so labels that are drawn every frame only get laid out once.
+// Fonts are told apart by their texture, so a cache must be cleared when a font is unloaded.
+// Clearing keeps the allocations, so a cache that has warmed up stops allocating.
+typedef struct TextCache {
+    TextCacheEntry entries[TEXT_CACHE_CAPACITY];
+    int entryCount;
+    LIST(char) text; // Null terminated strings of every entry back to back.
+    LIST(TextGlyph) glyphs;
+} TextCache;
+
+// The cache is large so it is heap allocated.
+TextCache *TextCacheNew(void);
+void TextCacheFree(TextCache *cache);
+void TextCacheClear(TextCache *cache);
+
+// Runs are only valid until the next call that can add to the cache.
+TextRun TextCacheGet(TextCache *cache, Font font, float fontSize, float spacing, const char *text);
+// Same as getting the text of the number without having to format it first.
+TextRun TextCacheGetInteger(TextCache *cache, Font font, float fontSize, float spacing, int integer);
+
+// Draws like DrawTextEx.
+void TextCacheDraw(TextCache *cache, Font font, TextRun run, Vector2 pos, Color tint);
+
+#endif
@@ -0,0 +1,23 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+// clock_gettime is hidden by -std=c99 unless we ask for POSIX.
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#endif
+
+#include "timer.h"
+
+double TimerSeconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double) counter.QuadPart / (double) frequency.QuadPart;
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + (double) time.tv_nsec / 1000000000.0;
+#endif
+}
@@ -0,0 +1,7 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+// Monotonic wall clock in seconds. Unlike raylib's GetTime this works without a window.
+double TimerSeconds(void);
+
+#endif
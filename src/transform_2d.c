@@ -1,4 +1,11 @@
 #include <math.h>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRANSFORM_2D_SSE
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TRANSFORM_2D_NEON
+#endif
 #include "raylib.h"
 #include "raymath.h"
 #include "rlgl.h"
@@ -36,10 +43,12 @@ Transform2D Transform2DFromPosition(Vector2 pos) {
 }
 
 Vector2 Transform2DBasisXForm(Transform2D transform, Vector2 vector) {
-    Vector2 result;
-    result.x = (vector.x * transform.y.y - vector.y * transform.y.x) / (transform.x.x * transform.y.y - transform.x.y * transform.y.x);
-    result.y = (vector.y - transform.x.y * result.x) / transform.y.y;
-    return result;
+    // Cramer's rule. Also works when y.y is 0, e.g. a quarter turn.
+    float determinantInverse = 1.0f / (transform.x.x * transform.y.y - transform.x.y * transform.y.x);
+    return (Vector2) {
+        .x = (vector.x * transform.y.y - vector.y * transform.y.x) * determinantInverse,
+        .y = (vector.y * transform.x.x - vector.x * transform.x.y) * determinantInverse
+    };
 }
 
 Vector2 Transform2DToLocal(Transform2D transform, Vector2 vector) {
@@ -105,34 +114,76 @@ Vector2 Transform2DBasisXFormInv(Transform2D transform, Vector2 vector) {
     };
 }
 
+Transform2D Transform2DInverse(Transform2D transform) {
+    float determinantInverse = 1.0f / (transform.x.x * transform.y.y - transform.x.y * transform.y.x);
+    Transform2D inverse = {
+        .x = {transform.y.y * determinantInverse, -transform.x.y * determinantInverse},
+        .y = {-transform.y.x * determinantInverse, transform.x.x * determinantInverse}
+    };
+    inverse.o = Vector2Negate(Transform2DBasisXFormInv(inverse, transform.o));
+    return inverse;
+}
+
+Transform2DCached Transform2DCache(Transform2D transform) {
+    return (Transform2DCached) {.transform = transform, .inverse = Transform2DInverse(transform)};
+}
+
+Vector2 Transform2DCachedToLocal(const Transform2DCached *cached, Vector2 vector) {
+    return Transform2DToGlobal(cached->inverse, vector);
+}
+
+void Transform2DToGlobalArray(Transform2D transform, const Vector2 *in, Vector2 *out, int count) {
+    int i = 0;
+#if defined(TRANSFORM_2D_SSE)
+    // Two interleaved points per register: (x0, y0, x1, y1).
+    __m128 basisX = _mm_setr_ps(transform.x.x, transform.x.y, transform.x.x, transform.x.y);
+    __m128 basisY = _mm_setr_ps(transform.y.x, transform.y.y, transform.y.x, transform.y.y);
+    __m128 origin = _mm_setr_ps(transform.o.x, transform.o.y, transform.o.x, transform.o.y);
+    for (; i + 4 <= count; i += 4) {
+        __m128 points01 = _mm_loadu_ps((const float *) (in + i));
+        __m128 points23 = _mm_loadu_ps((const float *) (in + i + 2));
+        __m128 x01 = _mm_shuffle_ps(points01, points01, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 y01 = _mm_shuffle_ps(points01, points01, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 x23 = _mm_shuffle_ps(points23, points23, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 y23 = _mm_shuffle_ps(points23, points23, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 result01 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x01, basisX), _mm_mul_ps(y01, basisY)), origin);
+        __m128 result23 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x23, basisX), _mm_mul_ps(y23, basisY)), origin);
+        _mm_storeu_ps((float *) (out + i), result01);
+        _mm_storeu_ps((float *) (out + i + 2), result23);
+    }
+#elif defined(TRANSFORM_2D_NEON)
+    // vld2q splits four points into an x and a y register.
+    for (; i + 4 <= count; i += 4) {
+        float32x4x2_t points = vld2q_f32((const float *) (in + i));
+        float32x4x2_t result;
+        result.val[0] = vaddq_f32(vaddq_f32(vmulq_n_f32(points.val[0], transform.x.x), vmulq_n_f32(points.val[1], transform.y.x)), vdupq_n_f32(transform.o.x));
+        result.val[1] = vaddq_f32(vaddq_f32(vmulq_n_f32(points.val[0], transform.x.y), vmulq_n_f32(points.val[1], transform.y.y)), vdupq_n_f32(transform.o.y));
+        vst2q_f32((float *) (out + i), result);
+    }
+#endif
+    // Same operations in the same order as the kernels so every point comes out the same either way.
+    for (; i < count; i++) {
+        Vector2 point = in[i];
+        out[i] = (Vector2) {
+            .x = (point.x * transform.x.x + point.y * transform.y.x) + transform.o.x,
+            .y = (point.x * transform.x.y + point.y * transform.y.y) + transform.o.y
+        };
+    }
+}
+
 Matrix Transform2DToMatrix(Transform2D transform) {
-    Vector2 pos = Transform2DBasisXForm(transform, transform.o);
-    // rlgl matrix stores position after transform is calculated, we store it before. Must convert between the two.
+    // raymath layout: m0, m4, m8, m12 is the first row, so the basis vectors are the first two columns.
     return (Matrix) {
-        .m0 = transform.x.x,
-        .m1 = transform.y.x,
-        .m2 = 0.0f,
-        .m3 = 0.0f,
-
-        .m4 = transform.x.y,
-        .m5 = transform.y.y,
-        .m6 = 0.0f,
-        .m7 = 0.0f,
-        
-        .m8 = 0.0f,
-        .m9 = 0.0f,
-        .m10 = 1.0f,
-        .m11 = 0.0f,
-        
-        .m12 = pos.x,
-        .m13 = pos.y,
-        .m14 = 0.0f,
-        .m15 = 1.0f
+        .m0 = transform.x.x, .m4 = transform.y.x, .m8 = 0.0f, .m12 = transform.o.x,
+        .m1 = transform.x.y, .m5 = transform.y.y, .m9 = 0.0f, .m13 = transform.o.y,
+        .m2 = 0.0f, .m6 = 0.0f, .m10 = 1.0f, .m14 = 0.0f,
+        .m3 = 0.0f, .m7 = 0.0f, .m11 = 0.0f, .m15 = 1.0f
     };
 }
 
 void rlTransform2DXForm(Transform2D transform) {
-    Matrix matrix = Transform2DToMatrix(transform);  
-    rlMultMatrixf((float *) &matrix);
-    rlTranslatef(matrix.m12, matrix.m13, 0.0f);
+    // raylib 4.5's rlMultMatrixf applies the matrix after the current one instead of before, so this is only
+    // right on top of an identity matrix, like the one view matrix set per frame.
+    Matrix matrix = Transform2DToMatrix(transform);
+    rlMultMatrixf(MatrixToFloat(matrix));
 }
@@ -11,6 +11,12 @@ typedef struct Transform2D {
     Vector2 y;
 } Transform2D;
 
+// A transform with its inverse worked out once, for converting many points either way with the same transform.
+typedef struct Transform2DCached {
+    Transform2D transform;
+    Transform2D inverse;
+} Transform2DCached;
+
 float Max(float i, float j);
 
 Vector2 Vector2Round(Vector2 vec);
@@ -34,7 +40,15 @@ Transform2D Transform2DMultiply(Transform2D a, Transform2D b);
 Transform2D Transform2DSetScale(Transform2D transform, Vector2 scale);
 Transform2D Transform2DScale(Transform2D transform, Vector2 scale);
 
-Matrix Transform2DToMatrix(Transform2D transform); // @TODO This is bugged
+Transform2D Transform2DInverse(Transform2D transform);
+Transform2DCached Transform2DCache(Transform2D transform);
+Vector2 Transform2DCachedToLocal(const Transform2DCached *cached, Vector2 vector);
+
+// Batched version, 4 points at a time with SSE2 or NEON when available. in and out may be the same array.
+void Transform2DToGlobalArray(Transform2D transform, const Vector2 *in, Vector2 *out, int count);
+
+Matrix Transform2DToMatrix(Transform2D transform);
+// Multiplies the current rlgl matrix by the transform. Doesn't nest, see the definition.
 void rlTransform2DXForm(Transform2D transform);
 
 #endif
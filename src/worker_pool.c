@@ -0,0 +1,88 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "list.h"
+#include "worker_pool.h"
+
+static void *WorkerPoolThread(void *data) {
+    WorkerPool *pool = data;
+    pthread_mutex_lock(&pool->mutex);
+    while (true) {
+        while (!pool->quitting && pool->jobIdx >= LIST_COUNT(pool->jobs)) {
+            pthread_cond_wait(&pool->jobAvailable, &pool->mutex);
+        }
+        if (pool->jobIdx >= LIST_COUNT(pool->jobs)) break; // quitting and nothing left to do
+
+        WorkerJob job = pool->jobs[pool->jobIdx];
+        pool->jobIdx++;
+        pool->jobsRunning++;
+        
+        pthread_mutex_unlock(&pool->mutex);
+        job.function(job.data);
+        pthread_mutex_lock(&pool->mutex);
+        
+        pool->jobsRunning--;
+        if (pool->jobsRunning == 0 && pool->jobIdx >= LIST_COUNT(pool->jobs)) {
+            // Everything is finished so the queue can be reused from the start.
+            LIST_SHRINK(pool->jobs, 0);
+            pool->jobIdx = 0;
+            pthread_cond_broadcast(&pool->jobsDone);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+WorkerPool *WorkerPoolNew(int threadCount) {
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > WORKER_POOL_THREADS_MAX) threadCount = WORKER_POOL_THREADS_MAX;
+
+    WorkerPool *pool = malloc(sizeof(WorkerPool));
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->jobAvailable, NULL);
+    pthread_cond_init(&pool->jobsDone, NULL);
+    pool->jobs = LIST_NEW(WorkerJob);
+    pool->jobIdx = 0;
+    pool->jobsRunning = 0;
+    pool->quitting = false;
+    pool->threadCount = 0;
+    
+    for (int i = 0; i < threadCount; i++) {
+        if (pthread_create(pool->threads + pool->threadCount, NULL, WorkerPoolThread, pool)) break;
+        pool->threadCount++;
+    }
+    assert(pool->threadCount > 0);
+    return pool;
+}
+
+void WorkerPoolFree(WorkerPool *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->quitting = true;
+    pthread_cond_broadcast(&pool->jobAvailable);
+    pthread_mutex_unlock(&pool->mutex);
+    
+    for (int i = 0; i < pool->threadCount; i++) pthread_join(pool->threads[i], NULL);
+    
+    pthread_cond_destroy(&pool->jobsDone);
+    pthread_cond_destroy(&pool->jobAvailable);
+    pthread_mutex_destroy(&pool->mutex);
+    LIST_FREE(pool->jobs);
+    free(pool);
+}
+
+void WorkerPoolPush(WorkerPool *pool, WorkerJobFunction function, void *data) {
+    WorkerJob job = {.function = function, .data = data};
+    pthread_mutex_lock(&pool->mutex);
+    LIST_ADD(&pool->jobs, job);
+    pthread_cond_signal(&pool->jobAvailable);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void WorkerPoolWait(WorkerPool *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->jobsRunning > 0 || pool->jobIdx < LIST_COUNT(pool->jobs)) {
+        pthread_cond_wait(&pool->jobsDone, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
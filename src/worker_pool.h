@@ -0,0 +1,40 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include "list.h"
+
+#define WORKER_POOL_THREADS_DEFAULT 4
+#define WORKER_POOL_THREADS_MAX 64
+
+typedef void (*WorkerJobFunction)(void *data);
+
+typedef struct WorkerJob {
+    WorkerJobFunction function;
+    void *data;
+} WorkerJob;
+
+// Fixed set of threads pulling jobs off of a shared queue.
+// Jobs are started in the order they were pushed but may finish in any order.
+// The pool is heap allocated because the threads keep a pointer to it.
+typedef struct WorkerPool {
+    pthread_mutex_t mutex;
+    pthread_cond_t jobAvailable;
+    pthread_cond_t jobsDone;
+
+    LIST(WorkerJob) jobs;
+    int jobIdx; // index of the next job to start
+    int jobsRunning;
+    bool quitting;
+
+    int threadCount;
+    pthread_t threads[WORKER_POOL_THREADS_MAX];
+} WorkerPool;
+
+WorkerPool *WorkerPoolNew(int threadCount);
+void WorkerPoolFree(WorkerPool *pool); // Waits for all pushed jobs to finish first.
+void WorkerPoolPush(WorkerPool *pool, WorkerJobFunction function, void *data);
+void WorkerPoolWait(WorkerPool *pool);
+
+#endif